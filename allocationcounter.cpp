@@ -0,0 +1,40 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> g_allocatedBytes{0};
+std::atomic<std::uint64_t> g_allocationCount{0};
+} // namespace
+
+std::uint64_t allocatedBytes()
+{
+    return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t allocationCount()
+{
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size)
+{
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,12 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// 堆分配计数：allocationcounter.cpp 替换全局 operator new / delete，累计经 operator new 分配的字节数与次数
+// 每个可执行文件链接一次即生效，作为 tracing::setAllocationCounter 的计数器使 Span 记录分配增量；
+// VTK 数组内部用 malloc 分配，这部分不在统计之内
+std::uint64_t allocatedBytes();
+std::uint64_t allocationCount();
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,555 @@
+// odbbench：转换流程的微基准与整体基准
+// 在合成模型上逐阶段计时（网格构建、场数组、von Mises、位移、模长、写文件），
+// 报告每单元耗时、堆分配字节数与峰值常驻内存，结果写成 CSV 以便不同构建之间对比
+#include "allocationcounter.h"
+#include "syntheticsource.h"
+#include "creategrid.h"
+#include "vtkdisplay.h"
+#include "fieldcodec.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct MemoryUsage {
+    std::uint64_t current{0};
+    std::uint64_t peak{0};
+};
+
+MemoryUsage memoryUsage()
+{
+    MemoryUsage usage;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        usage.current = counters.WorkingSetSize;
+        usage.peak = counters.PeakWorkingSetSize;
+    }
+#else
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        usage.current = resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage.peak = static_cast<std::uint64_t>(ru.ru_maxrss) * 1024; // Linux 以 KB 计
+    }
+#endif
+    return usage;
+}
+
+// 计时期间只保留警告与错误，避免格式化与控制台输出计入耗时
+class QuietOutput {
+public:
+    QuietOutput() : m_saved(tracing::logLevel()) { tracing::setLogLevel(std::min(m_saved, LogLevel::Warning)); }
+    ~QuietOutput() { tracing::setLogLevel(m_saved); }
+
+private:
+    LogLevel m_saved;
+};
+
+struct Sample {
+    double seconds{0.0};
+    std::uint64_t heapBytes{0};
+    std::int64_t rssDelta{0};
+};
+
+Sample measure(const std::function<void()>& fn)
+{
+    Sample sample;
+    const MemoryUsage before = memoryUsage();
+    // 统计经 operator new 的分配量；VTK 数组内部用 malloc 分配，这部分体现在常驻内存的变化中
+    const std::uint64_t heapBefore = allocatedBytes();
+    const auto start = std::chrono::steady_clock::now();
+    {
+        QuietOutput quiet;
+        fn();
+    }
+    sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sample.heapBytes = allocatedBytes() - heapBefore;
+    sample.rssDelta = static_cast<std::int64_t>(memoryUsage().current) - static_cast<std::int64_t>(before.current);
+    return sample;
+}
+
+struct Result {
+    std::string stage;
+    std::string mesh;
+    std::size_t elements{0};
+    std::size_t nodes{0};
+    int repeats{0};
+    double seconds{0.0};         // 各次重复中的最小值
+    std::uint64_t heapBytes{0};  // 单次执行的分配量（取各次最大）
+    std::int64_t rssDelta{0};    // 单次执行后常驻内存的增量（取各次最大）
+    std::uint64_t peakRss{0};    // 该阶段结束时进程的峰值常驻内存
+
+    double nsPerElement() const { return elements ? seconds * 1e9 / static_cast<double>(elements) : 0.0; }
+};
+
+struct Options {
+    std::vector<std::size_t> sizes{10000, 100000, 1000000, 10000000};
+    SyntheticMeshType mesh{SyntheticMeshType::HEX};
+    int repeats{3};
+    int threads{0};
+    std::vector<std::string> stages; // 空则运行全部阶段
+    std::string output;
+    std::string compare;
+    double tolerance{0.10};
+    std::string trace;
+    bool check{false};
+};
+
+const char* meshName(SyntheticMeshType type)
+{
+    switch (type) {
+    case SyntheticMeshType::TET: return "tet";
+    case SyntheticMeshType::SHELL: return "shell";
+    default: return "hex";
+    }
+}
+
+std::string buildDescription()
+{
+    std::ostringstream out;
+#if defined(_MSC_VER)
+    out << "msvc-" << _MSC_VER;
+#elif defined(__clang__)
+    out << "clang-" << __clang_major__ << "." << __clang_minor__;
+#elif defined(__GNUC__)
+    out << "gcc-" << __GNUC__ << "." << __GNUC_MINOR__;
+#endif
+#ifdef NDEBUG
+    out << " release";
+#else
+    out << " debug";
+#endif
+    return out.str();
+}
+
+void printUsage()
+{
+    std::cout <<
+        "Usage: odbbench [options]\n"
+        "  --sizes LIST        comma separated element counts (default: 10000,100000,1000000,10000000)\n"
+        "  --mesh TYPE         hex | tet | shell (default: hex)\n"
+        "  --repeat N          repetitions per stage, the fastest is reported (default: 3)\n"
+        "  --threads N         generator / grid / magnitude threads (default: hardware concurrency)\n"
+        "  --stages LIST       run only these stages\n"
+        "  --output FILE       write results as CSV\n"
+        "  --compare FILE      compare against a previous CSV and fail on regressions\n"
+        "  --tolerance X       allowed slowdown ratio when comparing (default: 0.10)\n"
+        "  --trace FILE        write a Chrome trace-event JSON of all stages (chrome://tracing, Perfetto)\n"
+        "  --check             run the correctness self-checks instead of timing, nonzero exit on failure\n"
+        "Stages: generate, buildGeometry, makeFloatArray.U, makeFloatArray.S, nodalAverage.S,\n"
+        "        calculateVonMisesStress, stressInvariants, fieldExpression, addDisplacementField,\n"
+        "        setDeformationScale, addPointVectorMagnitude, writeToFile, pipeline\n";
+}
+
+std::vector<std::string> splitList(const std::string& text)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            std::exit(0);
+        } else if (arg == "--sizes" && hasValue) {
+            options.sizes.clear();
+            for (const std::string& s : splitList(argv[++i])) {
+                options.sizes.push_back(static_cast<std::size_t>(std::strtoull(s.c_str(), nullptr, 10)));
+            }
+        } else if (arg == "--mesh" && hasValue) {
+            const std::string type = argv[++i];
+            if (type == "hex") options.mesh = SyntheticMeshType::HEX;
+            else if (type == "tet") options.mesh = SyntheticMeshType::TET;
+            else if (type == "shell") options.mesh = SyntheticMeshType::SHELL;
+            else return false;
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--stages" && hasValue) {
+            options.stages = splitList(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--compare" && hasValue) {
+            options.compare = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (arg == "--trace" && hasValue) {
+            options.trace = argv[++i];
+        } else if (arg == "--check") {
+            options.check = true;
+        } else {
+            std::cerr << "[Error] Unknown or incomplete option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !options.sizes.empty();
+}
+
+class Benchmark {
+public:
+    explicit Benchmark(const Options& options) : m_options(options) {}
+
+    void runSize(std::size_t targetElements);
+    const std::vector<Result>& results() const { return m_results; }
+
+private:
+    bool enabled(const std::string& stage) const
+    {
+        return m_options.stages.empty()
+            || std::find(m_options.stages.begin(), m_options.stages.end(), stage) != m_options.stages.end();
+    }
+    // setup 在每次计时前执行，不计入耗时
+    void runStage(const std::string& stage, const SyntheticModelSpec& spec, const std::function<void()>& fn,
+                  const std::function<void()>& setup = std::function<void()>());
+
+    Options m_options;
+    std::vector<Result> m_results;
+};
+
+void Benchmark::runStage(const std::string& stage, const SyntheticModelSpec& spec, const std::function<void()>& fn,
+                         const std::function<void()>& setup)
+{
+    if (!enabled(stage)) return;
+    Result result;
+    result.stage = stage;
+    result.mesh = meshName(spec.meshType);
+    result.elements = spec.elementCount();
+    result.nodes = spec.nodeCount();
+    result.repeats = m_options.repeats;
+    for (int r = 0; r < m_options.repeats; ++r) {
+        if (setup) {
+            QuietOutput quiet;
+            setup();
+        }
+        const Sample sample = measure(fn);
+        result.seconds = r == 0 ? sample.seconds : std::min(result.seconds, sample.seconds);
+        result.heapBytes = std::max(result.heapBytes, sample.heapBytes);
+        result.rssDelta = std::max(result.rssDelta, sample.rssDelta);
+    }
+    result.peakRss = memoryUsage().peak;
+    m_results.push_back(result);
+
+    std::cout << std::left << std::setw(26) << stage << std::right << std::setw(10) << result.elements
+              << std::fixed << std::setprecision(2) << std::setw(11) << result.seconds * 1e3
+              << std::setw(10) << result.nsPerElement()
+              << std::setw(10) << result.heapBytes / 1048576.0
+              << std::setw(10) << result.rssDelta / 1048576.0
+              << std::setw(10) << result.peakRss / 1048576.0 << std::endl;
+}
+
+void Benchmark::runSize(std::size_t targetElements)
+{
+    const SyntheticModelSpec spec = SyntheticModelSpec::forElementCount(m_options.mesh, targetElements);
+    const std::string step = "Step-1";
+    const int frame = spec.framesPerStep - 1;
+    const fs::path vtuFile = fs::temp_directory_path() / ("odbbench_" + std::to_string(spec.elementCount()) + ".vtu");
+
+    std::unique_ptr<SyntheticSource> source;
+    runStage("generate", spec,
+             [&]() {
+                 source = std::make_unique<SyntheticSource>(spec, "odbbench.synth", LoadProgressCallback(),
+                                                            m_options.threads);
+             },
+             [&]() { source.reset(); });
+    if (!source) {
+        QuietOutput quiet;
+        source = std::make_unique<SyntheticSource>(spec, "odbbench.synth", LoadProgressCallback(), m_options.threads);
+    }
+    // readSingleField 只保留本次读取的场，读取后立即取得共享指针
+    std::shared_ptr<const FieldData> u;
+    std::shared_ptr<const FieldData> s;
+    {
+        QuietOutput quiet;
+        source->readSingleField(step, frame, "U");
+        u = source->shareFieldData("U");
+        source->readSingleField(step, frame, "S");
+        s = source->shareFieldData("S");
+    }
+
+    std::unique_ptr<CreateVTKUnstucturedGrid> grid;
+    runStage("buildGeometry", spec, [&]() { grid = std::make_unique<CreateVTKUnstucturedGrid>(*source); },
+             [&]() { grid.reset(); });
+    if (!grid) {
+        QuietOutput quiet;
+        grid = std::make_unique<CreateVTKUnstucturedGrid>(*source);
+    }
+    grid->setThreads(m_options.threads);
+
+    runStage("makeFloatArray.U", spec, [&]() { grid->addFieldData(u); });
+    runStage("makeFloatArray.S", spec, [&]() { grid->addFieldData(s); },
+             [&]() { grid->setNodalAveraging(false); });
+    // 第一次执行包含邻接表构建，报告的最小值为复用邻接表后的耗时
+    runStage("nodalAverage.S", spec, [&]() { grid->addFieldData(s); },
+             [&]() { grid->setNodalAveraging(true); });
+    runStage("calculateVonMisesStress", spec, [&]() { grid->calculateVonMisesStress(*s); });
+    runStage("stressInvariants", spec, [&]() {
+        grid->addStressInvariants(*s, StressInvariantOptions{true, true, true, true, true, true});
+    });
+    // 表达式只编译一次，计时部分为按块求值与数组登记（不含节点平均）
+    FieldExpression expression;
+    FieldExpression::compile("sqrt((S11 - S22)^2 + 4 * S12^2) / 2", expression);
+    runStage("fieldExpression", spec, [&]() { grid->addFieldExpression("TauMax12", expression, {s}); },
+             [&]() { grid->setNodalAveraging(false); });
+    grid->setNodalAveraging(true);
+    runStage("addDisplacementField", spec, [&]() { grid->addDisplacementField(u, 1.0); });
+    // 界面拖动变形比例时的开销：只重算变形坐标缓冲区
+    double deformationScale = 1.0;
+    runStage("setDeformationScale", spec, [&]() { grid->setDeformationScale(deformationScale += 0.5); });
+
+    VTKDisplayManager display;
+    display.setThreads(m_options.threads);
+    runStage("addPointVectorMagnitude", spec,
+             [&]() { display.addPointVectorMagnitude(grid->getGrid(), "U", "U.Magnitude"); });
+    runStage("writeToFile", spec, [&]() { grid->writeToFile(vtuFile.string()); });
+
+    grid.reset();
+    source.reset();
+    std::error_code ec;
+    fs::remove(vtuFile, ec);
+
+    // 整体流程：生成、读取场、建网格、添加 U 与 S（含平均与 von Mises）、模长、写文件
+    runStage("pipeline", spec, [&]() {
+        SyntheticSource pipelineSource(spec, "odbbench.synth", LoadProgressCallback(), m_options.threads);
+        pipelineSource.readSingleField(step, frame, "U");
+        const std::shared_ptr<const FieldData> pipelineU = pipelineSource.shareFieldData("U");
+        pipelineSource.readSingleField(step, frame, "S");
+        const std::shared_ptr<const FieldData> pipelineS = pipelineSource.shareFieldData("S");
+        CreateVTKUnstucturedGrid pipelineGrid(pipelineSource);
+        pipelineGrid.setNodalAveraging(true);
+        pipelineGrid.setThreads(m_options.threads);
+        pipelineGrid.addDisplacementField(pipelineU, 0.0);
+        pipelineGrid.addStressField(pipelineS);
+        display.addPointVectorMagnitude(pipelineGrid.getGrid(), "U", "U.Magnitude");
+        pipelineGrid.writeToFile(vtuFile.string());
+    });
+    fs::remove(vtuFile, ec);
+}
+
+bool writeCsv(const std::string& fileName, const Options& options, const std::vector<Result>& results)
+{
+    std::ofstream out(fileName);
+    if (!out) {
+        std::cerr << "[Error] Cannot write " << fileName << std::endl;
+        return false;
+    }
+    out << "# odbbench build=" << buildDescription() << " threads=" << ThreadPool::resolveThreadCount(options.threads)
+        << " repeats=" << options.repeats << "\n";
+    out << "stage,mesh,elements,nodes,repeats,seconds,ns_per_element,heap_bytes,rss_delta_bytes,peak_rss_bytes\n";
+    out << std::setprecision(9);
+    for (const Result& r : results) {
+        out << r.stage << ',' << r.mesh << ',' << r.elements << ',' << r.nodes << ',' << r.repeats << ','
+            << r.seconds << ',' << r.nsPerElement() << ',' << r.heapBytes << ',' << r.rssDelta << ','
+            << r.peakRss << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+// 以 stage|mesh|elements 为键读取基线耗时
+bool readBaseline(const std::string& fileName, std::map<std::string, double>& seconds)
+{
+    std::ifstream in(fileName);
+    if (!in) {
+        std::cerr << "[Error] Cannot read baseline " << fileName << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#' || line.rfind("stage,", 0) == 0) continue;
+        const std::vector<std::string> cols = splitList(line);
+        if (cols.size() < 6) continue;
+        seconds[cols[0] + "|" + cols[1] + "|" + cols[2]] = std::atof(cols[5].c_str());
+    }
+    return true;
+}
+
+int compareWithBaseline(const Options& options, const std::vector<Result>& results)
+{
+    std::map<std::string, double> baseline;
+    if (!readBaseline(options.compare, baseline)) {
+        return 2;
+    }
+    std::cout << "\nComparison with " << options.compare << " (tolerance " << options.tolerance * 100 << "%)\n";
+    int regressions = 0;
+    for (const Result& r : results) {
+        auto it = baseline.find(r.stage + "|" + r.mesh + "|" + std::to_string(r.elements));
+        if (it == baseline.end() || it->second <= 0.0) continue;
+        const double ratio = r.seconds / it->second;
+        const bool regressed = ratio > 1.0 + options.tolerance;
+        regressions += regressed ? 1 : 0;
+        std::cout << std::left << std::setw(26) << r.stage << std::right << std::setw(10) << r.elements
+                  << std::fixed << std::setprecision(2) << std::setw(8) << ratio << "x"
+                  << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    std::cout << "[Info] " << regressions << " regressions." << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+// 自检：编码往返与结果源约定等不依赖计时的行为，失败项逐条输出
+class SelfCheck {
+public:
+    void expect(bool ok, const std::string& what)
+    {
+        ++m_total;
+        if (!ok) {
+            ++m_failed;
+            std::cerr << "[Error] Check failed: " << what << std::endl;
+        }
+    }
+    int finish() const
+    {
+        std::cout << "[Info] " << m_total - m_failed << "/" << m_total << " checks passed." << std::endl;
+        return m_failed > 0 ? 1 : 0;
+    }
+
+private:
+    int m_total{0};
+    int m_failed{0};
+};
+
+// 含 NaN / Inf 的场经 16 位编码往返：有限值在量化误差内还原，非有限值不影响范围且解码为 NaN（半精度保留 Inf）
+void checkCodecNonFinite(SelfCheck& check)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const std::vector<float> input{-2.0f, nan, 0.5f, inf, 3.0f, -inf, nan, 1.0f};
+    for (FieldStorage storage : {FieldStorage::QUANTIZED16, FieldStorage::FLOAT16}) {
+        const std::string label = storage == FieldStorage::QUANTIZED16 ? "QUANTIZED16" : "FLOAT16";
+        FieldData field;
+        field.name = "check";
+        field.components = 2;
+        field.values = input;
+        field.validFlags.assign(input.size() / 2, 1);
+        packFieldData(field, storage);
+        unpackFieldData(field);
+        check.expect(field.values.size() == input.size(), label + " round trip keeps the value count");
+        if (field.values.size() != input.size()) continue;
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            const float v = field.values[i];
+            if (std::isnan(input[i])) {
+                check.expect(std::isnan(v), label + " NaN decodes to NaN");
+            } else if (std::isinf(input[i])) {
+                check.expect(storage == FieldStorage::QUANTIZED16 ? std::isnan(v) : v == input[i],
+                             label + " Inf decodes to the reserved value");
+            } else {
+                check.expect(std::fabs(v - input[i]) <= 1e-3f, label + " finite value within quantization error");
+            }
+        }
+    }
+}
+
+// 结果源的保留约定（见 ResultSource::readSingleField）：同一帧连续读取两个场后只保留最后一个，
+// 先取得的共享指针仍然有效；readFieldOutput 之后为该帧的全部场
+void checkFieldRetention(SelfCheck& check)
+{
+    QuietOutput quiet;
+    const SyntheticModelSpec spec = SyntheticModelSpec::forElementCount(SyntheticMeshType::HEX, 1000);
+    SyntheticSource source(spec, "odbbench.check", LoadProgressCallback(), 1);
+    const std::string step = "Step-1";
+    const int frame = spec.framesPerStep - 1;
+
+    check.expect(source.readSingleField(step, frame, "U"), "readSingleField U");
+    const std::shared_ptr<const FieldData> u = source.shareFieldData("U");
+    check.expect(source.readSingleField(step, frame, "S"), "readSingleField S");
+    check.expect(source.getLoadedFieldNames() == std::vector<std::string>{"S"},
+                 "readSingleField keeps only the last field of the same frame");
+    check.expect(u && !u->values.empty(), "shared field stays valid after the next read");
+    check.expect(!source.shareFieldData("U"), "earlier field is no longer shared by name");
+
+    check.expect(source.readFieldOutput(step, frame), "readFieldOutput");
+    std::vector<std::string> names = source.getLoadedFieldNames();
+    std::sort(names.begin(), names.end());
+    check.expect(names == std::vector<std::string>{"S", "U"}, "readFieldOutput loads every field of the frame");
+}
+
+int runSelfChecks()
+{
+    SelfCheck check;
+    checkCodecNonFinite(check);
+    checkFieldRetention(check);
+    return check.finish();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.check) {
+        return runSelfChecks();
+    }
+    tracing::setAllocationCounter(allocatedBytes);
+    if (!options.trace.empty()) {
+        tracing::setEnabled(true);
+    }
+
+    std::cout << "[Info] odbbench " << buildDescription() << ", mesh " << meshName(options.mesh) << ", "
+              << ThreadPool::resolveThreadCount(options.threads) << " threads, " << options.repeats << " repeats"
+              << std::endl;
+    std::cout << std::left << std::setw(26) << "Stage" << std::right << std::setw(10) << "Elements"
+              << std::setw(11) << "Time(ms)" << std::setw(10) << "ns/elem" << std::setw(10) << "Heap MB"
+              << std::setw(10) << "dRSS MB" << std::setw(10) << "Peak MB" << std::endl;
+
+    Benchmark benchmark(options);
+    for (std::size_t size : options.sizes) {
+        benchmark.runSize(size);
+    }
+
+    if (!options.output.empty() && writeCsv(options.output, options, benchmark.results())) {
+        std::cout << "[Info] Results written to " << options.output << std::endl;
+    }
+    if (!options.trace.empty()) {
+        tracing::writeChromeTrace(options.trace);
+    }
+    if (!options.compare.empty()) {
+        return compareWithBaseline(options, benchmark.results());
+    }
+    return 0;
+}
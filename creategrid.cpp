@@ -1,74 +1,263 @@
 #include "creategrid.h"
+#include "fieldcodec.h"
+#include "fieldkernels.h"
+#include "tracing.h"
 
-CreateVTKUnstucturedGrid::CreateVTKUnstucturedGrid(const readOdb& odb)
+#include <vtkBuffer.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 应力导出量与变形坐标按实体分块并行计算的块大小
+constexpr std::size_t kInvariantChunkSize = 1 << 16;
+constexpr std::size_t kPointChunkSize = 1 << 16;
+
+#ifndef NDEBUG
+// 调试构建中核对共享缓冲区是否被原地修改
+std::uint64_t bufferDigest(const void* data, std::size_t bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 1469598103934665603ull;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= bytes; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < bytes; ++i) {
+        hash = (hash ^ p[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+#endif
+
+// 只读约定：data 属于结果源的几何缓存或场缓存，可能同时被其他网格、邻接表构建与后续帧引用，
+// VTK 数组只能读取，不能原地写入（SetValue / GetPointer 后写入等）。本仓库只把这些数组交给
+// vtkCellArray::SetData 与数据属性，不修改其内容；扩容时 VTK 复制到新分配的缓冲区，不影响原数据。
+// 调试构建在缓冲区释放时核对内容摘要，违反约定即报错终止。
+// data 的生命周期由 owner 保证；owner 作为释放函数的上下文存放在数组的 vtkBuffer 中，
+// 浅拷贝共享同一 vtkBuffer 时一并延长，缓冲区释放（或被 VTK 重新分配）时归还
+template <typename ArrayT, typename ValueT>
+vtkSmartPointer<ArrayT> wrapSharedBuffer(const ValueT* data, std::size_t count, int components,
+                                         std::shared_ptr<const void> owner)
+{
+    vtkSmartPointer<ArrayT> arr = vtkSmartPointer<ArrayT>::New();
+    arr->SetNumberOfComponents(components);
+    if (!data || !owner || count == 0) {
+        return arr;
+    }
+    // std::int64_t 与 vtkTypeInt64 在部分平台上分别是 long / long long，宽度一致即可直接复用
+    using ArrayValueT = typename ArrayT::ValueType;
+    static_assert(sizeof(ArrayValueT) == sizeof(ValueT), "buffer element width mismatch");
+    // VTK 的 SetArray 只接受非 const 指针，只读由上面的约定保证
+    arr->SetArray(reinterpret_cast<ArrayValueT*>(const_cast<ValueT*>(data)), static_cast<vtkIdType>(count), 0,
+                  VTK_DATA_ARRAY_USER_DEFINED);
+#ifndef NDEBUG
+    const std::size_t bytes = count * sizeof(ValueT);
+    const std::uint64_t digest = bufferDigest(data, bytes);
+    arr->GetBuffer()->SetFreeFunction(false, [owner = std::move(owner), data, bytes, digest](void*) mutable {
+        if (bufferDigest(data, bytes) != digest) {
+            ODB_LOG_ERROR("Shared read-only buffer was modified through a VTK array.");
+            std::abort();
+        }
+        owner.reset();
+    });
+#else
+    arr->GetBuffer()->SetFreeFunction(false, [owner = std::move(owner)](void*) mutable { owner.reset(); });
+#endif
+    return arr;
+}
+
+template <typename ArrayT, typename ValueT>
+vtkSmartPointer<ArrayT> wrapSharedBuffer(const std::shared_ptr<std::vector<ValueT>>& buffer, std::size_t count)
+{
+    return wrapSharedBuffer<ArrayT>(buffer ? buffer->data() : nullptr, count, 1, buffer);
+}
+
+// 紧凑存储的场解码为新的共享对象，解码结果只由网格中的数组持有；未编码时原样返回 owner（可能为空）
+std::shared_ptr<const FieldData> unpackedShared(const FieldData& fieldData, std::shared_ptr<const FieldData> owner)
+{
+    if (!fieldData.isPacked()) {
+        return owner;
+    }
+    auto decoded = std::make_shared<FieldData>();
+    unpackedView(fieldData, *decoded);
+    return decoded;
+}
+
+} // namespace
+
+CreateVTKUnstucturedGrid::CreateVTKUnstucturedGrid(const ResultSource& odb)
     : m_odb(odb)
 {
     m_grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
     this->buildGeometry();
+    m_connectivity = m_odb.m_elementsConn;
+}
+
+void CreateVTKUnstucturedGrid::setThreads(int threads)
+{
+    m_threads = threads;
+}
+
+ThreadPool& CreateVTKUnstucturedGrid::pool()
+{
+    // 首次需要时创建，线程数改变后重建
+    const unsigned threads = ThreadPool::resolveThreadCount(m_threads);
+    if (!m_pool || m_pool->threadCount() != threads) {
+        m_pool = std::make_unique<ThreadPool>(threads);
+    }
+    return *m_pool;
+}
+
+void CreateVTKUnstucturedGrid::setNodalAveraging(bool enabled, const NodalAveragingOptions& options)
+{
+    m_nodalAveraging = enabled;
+    m_averagingOptions = options;
+}
+
+bool CreateVTKUnstucturedGrid::addNodalAverage(const FieldData& elementField)
+{
+    tracing::Span span("addNodalAverage", "converter");
+    span.arg("nodes", m_odb.m_nodesNum);
+    // 邻接表在第一次需要时构建，之后各帧各场复用
+    if (!m_nodalAverager.isBuilt()) {
+        if (m_connectivity.elementCount() != m_odb.m_elementsNum) {
+            ODB_LOG_WARNING("Connectivity unavailable, nodal averaging skipped.");
+            return false;
+        }
+        m_nodalAverager.build(m_connectivity, m_odb.m_nodesNum, m_odb.getInstanceInfos());
+        m_connectivity.clear();
+    }
+
+    auto nodalField = std::make_shared<FieldData>();
+    if (!m_nodalAverager.average(elementField, m_averagingOptions, *nodalField, pool())) {
+        ODB_LOG_WARNING("Nodal averaging failed for field: " << elementField.name);
+        return false;
+    }
+    m_nodalStats[nodalField->name] = nodalField->stats;
+    auto arr = makeFloatArray(*nodalField, m_odb.m_nodesNum, nodalField);
+    m_grid->GetPointData()->AddArray(arr);
+    return true;
+}
+
+const FieldStats* CreateVTKUnstucturedGrid::nodalAverageStats(const std::string& name) const
+{
+    const auto it = m_nodalStats.find(name);
+    return it == m_nodalStats.end() ? nullptr : &it->second;
 }
 
 void CreateVTKUnstucturedGrid::buildGeometry()
 {
-    // 防御式检查：若 readOdb 的几何缓存被释放或不一致，按可用长度构建，避免越界
+    tracing::Span span("buildGeometry", "converter");
+    const ElementConnectivity& elementsConn = m_odb.m_elementsConn;
+
+    // 防御式检查：若结果源的几何缓存被释放或不一致，按可用长度构建，避免越界
     std::size_t nodesCount = std::min(m_odb.m_nodesNum, m_odb.m_nodesCoord.size());
     std::size_t elementsCount = m_odb.m_elementsNum;
-    elementsCount = std::min(elementsCount, m_odb.m_elementsConn.size());
-    elementsCount = std::min(elementsCount, m_odb.m_elementTypes.size());
+    elementsCount = std::min(elementsCount, elementsConn.elementCount());
+    elementsCount = std::min(elementsCount, m_odb.m_elementTypeIds.size());
+    span.arg("nodes", nodesCount);
+    span.arg("elements", elementsCount);
     if (nodesCount != m_odb.m_nodesNum || elementsCount != m_odb.m_elementsNum) {
-        std::cerr << "[Warning] Geometry caches incomplete (possibly released). Using available sizes: nodes="
-                  << nodesCount << ", elements=" << elementsCount << std::endl;
+        ODB_LOG_WARNING("Geometry caches incomplete (possibly released). Using available sizes: nodes="
+                        << nodesCount << ", elements=" << elementsCount);
     }
 
     vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
     vtkSmartPointer<vtkFloatArray> coordsArray = vtkSmartPointer<vtkFloatArray>::New();
     coordsArray->SetNumberOfComponents(3);
     coordsArray->SetNumberOfTuples(static_cast<vtkIdType>(nodesCount));
+    float* coords = coordsArray->GetPointer(0);
     for (std::size_t i = 0; i < nodesCount; ++i) {
         const nodeCoord& nc = m_odb.m_nodesCoord[i];
-        coordsArray->SetTuple3(static_cast<vtkIdType>(i), static_cast<float>(nc.x), static_cast<float>(nc.y), static_cast<float>(nc.z));
+        coords[3 * i + 0] = static_cast<float>(nc.x);
+        coords[3 * i + 1] = static_cast<float>(nc.y);
+        coords[3 * i + 2] = static_cast<float>(nc.z);
     }
     points->SetData(coordsArray);
     m_grid->SetPoints(points);
+    m_referenceCoords = coordsArray;
 
-    // 批量设置单元（types + offsets + connectivity）
+    // 单元类型
     vtkSmartPointer<vtkUnsignedCharArray> types = vtkSmartPointer<vtkUnsignedCharArray>::New();
     types->SetNumberOfComponents(1);
     types->SetNumberOfTuples(static_cast<vtkIdType>(elementsCount));
-
-    vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
-    offsets->SetNumberOfComponents(1);
-    offsets->SetNumberOfTuples(static_cast<vtkIdType>(elementsCount + 1));
-
-    // 预先统计连通性总长度以优化分配
-    vtkIdType totalConn = 0;
-    for (std::size_t e = 0; e < m_odb.m_elementsNum; ++e) {
-        totalConn += static_cast<vtkIdType>(m_odb.m_elementsConn[e].size());
+    unsigned char* typePtr = types->GetPointer(0);
+
+    // 每种 Abaqus 类型只解析一次，逐单元转换退化为查表
+    const std::vector<std::string>& typeNames = m_odb.m_elementTypeNames;
+    std::vector<unsigned char> vtkTypeById(typeNames.size(), VTK_EMPTY_CELL);
+    for (std::size_t id = 0; id < typeNames.size(); ++id) {
+        const int vtkCellType = abaqusToVTKCellType(typeNames[id]);
+        if (vtkCellType >= 0) {
+            vtkTypeById[id] = static_cast<unsigned char>(vtkCellType);
+        }
     }
-    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
-    connectivity->SetNumberOfComponents(1);
-    connectivity->SetNumberOfTuples(totalConn);
 
-    vtkIdType writePos = 0;
+    const std::uint16_t* typeIds = m_odb.m_elementTypeIds.data();
+    std::vector<std::size_t> unsupportedPerType(typeNames.size(), 0);
+    std::size_t unsupportedCount = 0;
     for (std::size_t e = 0; e < elementsCount; ++e) {
-        const std::vector<std::size_t>& conn = m_odb.m_elementsConn[e];
-        const std::string& abaqusType = m_odb.m_elementTypes[e];
-        int vtkCellType = abaqusToVTKCellType(abaqusType);
-        if (vtkCellType < 0) {
-            std::cerr << "[Warning] Unsupported element type \"" << abaqusType << "\" (element " << e + 1 << "). Skipped.\n";
-            types->SetValue(static_cast<vtkIdType>(e), VTK_EMPTY_CELL);
-            offsets->SetValue(static_cast<vtkIdType>(e), writePos);
-            continue;
+        const unsigned char vtkCellType = vtkTypeById[typeIds[e]];
+        typePtr[e] = vtkCellType;
+        if (vtkCellType == VTK_EMPTY_CELL) {
+            ++unsupportedPerType[typeIds[e]];
+            ++unsupportedCount;
         }
-        types->SetValue(static_cast<vtkIdType>(e), static_cast<unsigned char>(vtkCellType));
-        offsets->SetValue(static_cast<vtkIdType>(e), writePos);
-        for (std::size_t j = 0; j < conn.size(); ++j) {
-            connectivity->SetValue(writePos++, static_cast<vtkIdType>(conn[j]));
+    }
+    for (std::size_t id = 0; id < typeNames.size(); ++id) {
+        if (unsupportedPerType[id] > 0) {
+            ODB_LOG_WARNING("Unsupported element type \"" << typeNames[id] << "\" ("
+                            << unsupportedPerType[id] << " elements). Skipped.");
         }
     }
-    // 末尾偏移，指向连接数组总长度
-    offsets->SetValue(static_cast<vtkIdType>(elementsCount), writePos);
+
     vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
-    cells->SetData(offsets, connectivity);
+    if (elementsCount == 0) {
+        m_grid->SetCells(types, cells);
+        return;
+    }
+
+    if (unsupportedCount == 0) {
+        // 直接共享结果源的 CSR 缓冲区，不逐单元拷贝
+        const std::size_t connCount = elementsConn.offset(elementsCount);
+        if (elementsConn.wideIndex) {
+            auto offsets = wrapSharedBuffer<vtkTypeInt64Array>(elementsConn.offsets64, elementsCount + 1);
+            auto connectivity = wrapSharedBuffer<vtkTypeInt64Array>(elementsConn.connectivity64, connCount);
+            cells->SetData(offsets, connectivity);
+        } else {
+            auto offsets = wrapSharedBuffer<vtkTypeInt32Array>(elementsConn.offsets32, elementsCount + 1);
+            auto connectivity = wrapSharedBuffer<vtkTypeInt32Array>(elementsConn.connectivity32, connCount);
+            cells->SetData(offsets, connectivity);
+        }
+    } else {
+        // 存在不支持的单元：将其节点列表置空后复制一份紧凑的 CSR
+        vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+        offsets->SetNumberOfTuples(static_cast<vtkIdType>(elementsCount + 1));
+        vtkIdType* offsetPtr = offsets->GetPointer(0);
+        vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+        connectivity->SetNumberOfTuples(static_cast<vtkIdType>(elementsConn.offset(elementsCount)));
+        vtkIdType* connPtr = connectivity->GetPointer(0);
+
+        vtkIdType writePos = 0;
+        for (std::size_t e = 0; e < elementsCount; ++e) {
+            offsetPtr[e] = writePos;
+            if (typePtr[e] == VTK_EMPTY_CELL) {
+                continue;
+            }
+            const int nNodes = static_cast<int>(elementsConn.nodeCount(e));
+            for (int j = 0; j < nNodes; ++j) {
+                connPtr[writePos++] = static_cast<vtkIdType>(elementsConn.nodeAt(e, j));
+            }
+        }
+        // 末尾偏移，指向连接数组总长度
+        offsetPtr[elementsCount] = writePos;
+        connectivity->SetNumberOfTuples(writePos);
+        cells->SetData(offsets, connectivity);
+    }
     m_grid->SetCells(types, cells);
 }
 
@@ -128,33 +317,41 @@ int CreateVTKUnstucturedGrid::abaqusToVTKCellType(const std::string& abaqusType)
         {"PIPE32",VTK_QUADRATIC_EDGE}
     };
 
+    auto exact = map.find(abaqusType);
+    if (exact != map.end()) {
+        return exact->second;
+    }
+    // 变体名称（如 C3D8RH、S4R5）按包含关系匹配，取最长的键以保证结果确定
+    int result = -1;
+    std::size_t bestLength = 0;
     for (const auto& kv : map) {
-        if (abaqusType.find(kv.first) != std::string::npos) {
-            return kv.second;
+        if (kv.first.size() > bestLength && abaqusType.find(kv.first) != std::string::npos) {
+            result = kv.second;
+            bestLength = kv.first.size();
         }
     }
-    std::cerr << "[Error] Element type \"" << abaqusType << "\" not supported by VTK converter.\n";
-    return -1;
+    // 不支持的类型由调用方按类型汇总报告
+    return result;
 }
 
-void CreateVTKUnstucturedGrid::addCellScalar(const std::string& name, const std::vector<float>& values)
+void CreateVTKUnstucturedGrid::addCellScalar(const std::string& name, std::vector<float> values)
 {
     if (values.size() != m_odb.m_elementsNum) {
         throw std::runtime_error("addCellScalar: size mismatch with element count");
     }
-    vtkSmartPointer<vtkFloatArray> arr = vtkSmartPointer<vtkFloatArray>::New();
+    // 数组直接接管 values 的缓冲区
+    auto buffer = std::make_shared<std::vector<float>>(std::move(values));
+    vtkSmartPointer<vtkFloatArray> arr = wrapSharedBuffer<vtkFloatArray>(buffer, buffer->size());
     arr->SetName(name.c_str());
-    arr->SetNumberOfComponents(1);
-    arr->SetNumberOfTuples(static_cast<vtkIdType>(values.size()));
-    for (std::size_t i = 0; i < values.size(); ++i) {
-        arr->SetValue(static_cast<vtkIdType>(i), values[i]);
-    }
     m_grid->GetCellData()->AddArray(arr);
 }
 
 
 bool CreateVTKUnstucturedGrid::writeToFile(const std::string& filename) const
 {
+    tracing::Span span("writeToFile", "writer");
+    span.arg("points", static_cast<std::uint64_t>(m_grid->GetNumberOfPoints()));
+    span.arg("cells", static_cast<std::uint64_t>(m_grid->GetNumberOfCells()));
     vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
     writer->SetFileName(filename.c_str());
     writer->SetInputData(m_grid);
@@ -164,101 +361,155 @@ bool CreateVTKUnstucturedGrid::writeToFile(const std::string& filename) const
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "[Error] Failed to write VTK file: " << e.what() << std::endl;
+        ODB_LOG_ERROR("Failed to write VTK file: " << e.what());
         return false;
     }
 }
 
 bool CreateVTKUnstucturedGrid::addFieldData(const FieldData& fieldData)
 {
-    int numComponents = fieldData.components;
+    return addFieldArrays(fieldData, nullptr);
+}
+
+bool CreateVTKUnstucturedGrid::addFieldData(const std::shared_ptr<const FieldData>& fieldData)
+{
+    return fieldData && addFieldArrays(*fieldData, fieldData);
+}
+
+bool CreateVTKUnstucturedGrid::addFieldArrays(const FieldData& storedField, std::shared_ptr<const FieldData> owner)
+{
+    // 紧凑存储的场在这里透明解码
+    owner = unpackedShared(storedField, std::move(owner));
+    const FieldData& fieldData = storedField.isPacked() ? *owner : storedField;
     if (fieldData.isNodal) { // 点数据
         if (fieldData.values.empty()) {
-            std::cerr << "[Warning] No node values found for field: " << fieldData.name << std::endl;
+            ODB_LOG_WARNING("No node values found for field: " << fieldData.name);
             return false;
         }
-        auto arr = makeFloatArray(fieldData.name, numComponents,
-                                  m_odb.m_nodesNum, fieldData.values, fieldData.validFlags);
+        auto arr = makeFloatArray(fieldData, m_odb.m_nodesNum, owner);
         m_grid->GetPointData()->AddArray(arr);
     } else {
         // 单元数据
         if (fieldData.values.empty()) {
-            std::cerr << "[Warning] No element values found for field: " << fieldData.name << std::endl;
+            ODB_LOG_WARNING("No element values found for field: " << fieldData.name);
             return false;
         }
 
-        auto arr = makeFloatArray(fieldData.name, numComponents,
-                                  m_odb.m_elementsNum, fieldData.values, fieldData.validFlags);
+        auto arr = makeFloatArray(fieldData, m_odb.m_elementsNum, owner);
         m_grid->GetCellData()->AddArray(arr);
+        if (m_nodalAveraging) {
+            addNodalAverage(fieldData);
+        }
     }
 
-    std::cout << "[Info] Added field data: " << fieldData.name
-              << " with " << fieldData.components << " components." << std::endl;
+    ODB_LOG_DEBUG("Added field data: " << fieldData.name
+                  << " with " << fieldData.components << " components.");
     return true;
 }
 
-vtkSmartPointer<vtkFloatArray> CreateVTKUnstucturedGrid::makeFloatArray(const std::string& name,
-                                                  int numComponents,
-                                                  std::size_t tupleCount,
-                                                  const std::vector<float>& values,
-                                                  const std::vector<uint8_t>& validFlags)
+vtkSmartPointer<vtkFloatArray> CreateVTKUnstucturedGrid::makeFloatArray(const FieldData& fieldData,
+                                                                         std::size_t tupleCount,
+                                                                         std::shared_ptr<const FieldData> owner)
 {
+    tracing::Span span("makeFloatArray", "converter");
+    span.arg("tuples", tupleCount);
+    span.arg("components", static_cast<std::uint64_t>(fieldData.components));
+    const int numComponents = fieldData.components;
+    const std::size_t numComp = static_cast<std::size_t>(numComponents);
+    const std::size_t slotCount = fieldData.slotCount();
+
+    // 稠密布局中无效条目在提取时已置零，values 与 VTK 数组的内存布局一致，直接共享而不复制
+    const bool dense = !fieldData.isSparse() && !fieldData.isPacked() && slotCount == tupleCount;
+    if (owner && dense && tupleCount > 0 && fieldData.values.size() == tupleCount * numComp) {
+        span.arg("shared", 1);
+        vtkSmartPointer<vtkFloatArray> arr = wrapSharedBuffer<vtkFloatArray>(
+            fieldData.values.data(), fieldData.values.size(), numComponents, std::move(owner));
+        arr->SetName(fieldData.name.c_str());
+        return arr;
+    }
+
     vtkSmartPointer<vtkFloatArray> arr = vtkSmartPointer<vtkFloatArray>::New();
-    arr->SetName(name.c_str());
+    arr->SetName(fieldData.name.c_str());
     arr->SetNumberOfComponents(numComponents);
     arr->SetNumberOfTuples(static_cast<vtkIdType>(tupleCount));
-
-    const std::size_t expected = tupleCount * static_cast<std::size_t>(numComponents);
-    if (values.size() < expected) {
-        std::cerr << "[Warning] makeFloatArray: values size (" << values.size()
-                  << ") < expected (" << expected << ") for " << name << std::endl;
+    float* out = arr->GetPointer(0);
+    if (dense && fieldData.values.size() == tupleCount * numComp) {
+        std::copy(fieldData.values.begin(), fieldData.values.end(), out);
+        return arr;
+    }
+    if (fieldData.values.size() < slotCount * numComp) {
+        ODB_LOG_WARNING("makeFloatArray: values size (" << fieldData.values.size()
+                        << ") < expected (" << slotCount * numComp << ") for " << fieldData.name);
     }
 
-    for (std::size_t i = 0; i < tupleCount; ++i) {
-        const bool valid = (i < validFlags.size() && validFlags[i]);
-        const std::size_t base = i * static_cast<std::size_t>(numComponents);
-        if (valid && (base + static_cast<std::size_t>(numComponents) <= values.size())) {
-            for (int comp = 0; comp < numComponents; ++comp) {
-                arr->SetComponent(static_cast<vtkIdType>(i), comp, values[base + static_cast<std::size_t>(comp)]);
-            }
-        } else {
-            for (int comp = 0; comp < numComponents; ++comp) {
-                arr->SetComponent(static_cast<vtkIdType>(i), comp, 0.0);
-            }
+    // 先整体置零，再按槽位写入有效值；稀疏布局直接散射，不需要先展开成稠密数组
+    std::fill(out, out + tupleCount * numComp, 0.0f);
+    for (std::size_t slot = 0; slot < slotCount; ++slot) {
+        const std::size_t entity = fieldData.entityIndex(slot);
+        const std::size_t base = slot * numComp;
+        if (!fieldData.slotValid(slot) || entity >= tupleCount || base + numComp > fieldData.values.size()) {
+            continue;
         }
+        std::copy(fieldData.values.begin() + base, fieldData.values.begin() + base + numComp, out + entity * numComp);
     }
     return arr;
 }
 
-bool CreateVTKUnstucturedGrid::addDisplacementField(const FieldData& displacementField, double scaleFactor)
+bool CreateVTKUnstucturedGrid::addDisplacementField(const FieldData& fieldData, double scaleFactor)
+{
+    return addDisplacementArrays(fieldData, nullptr, scaleFactor);
+}
+
+bool CreateVTKUnstucturedGrid::addDisplacementField(const std::shared_ptr<const FieldData>& fieldData, double scaleFactor)
+{
+    return fieldData && addDisplacementArrays(*fieldData, fieldData, scaleFactor);
+}
+
+bool CreateVTKUnstucturedGrid::addDisplacementArrays(const FieldData& storedField, std::shared_ptr<const FieldData> owner,
+                                                     double scaleFactor)
 {
+    owner = unpackedShared(storedField, std::move(owner));
+    const FieldData& displacementField = storedField.isPacked() ? *owner : storedField;
     if (displacementField.type != FieldType::DISPLACEMENT) {
-        std::cerr << "[Error] Field is not a displacement field." << std::endl;
+        ODB_LOG_ERROR("Field is not a displacement field.");
         return false;
     }
 
     // 首先添加原始位移数据
-    if (!addFieldData(displacementField)) {
+    if (!addFieldArrays(displacementField, owner)) {
         return false;
     }
 
-    // 如果缩放因子不为0，应用位移到几何体
+    // 缩放因子不为 0 时以该位移场变形网格；参考坐标不变，重复调用不会叠加
     if (scaleFactor != 0.0) {
-        applyDisplacement(displacementField, scaleFactor);
-        std::cout << "[Info] Applied displacement with scale factor: " << scaleFactor << std::endl;
+        setDeformation(owner ? owner : std::make_shared<FieldData>(displacementField), scaleFactor);
+        ODB_LOG_DEBUG("Applied displacement with scale factor: " << scaleFactor);
     }
 
     return true;
 }
 
-bool CreateVTKUnstucturedGrid::addStressField(const FieldData& stressField, const std::string& component)
+bool CreateVTKUnstucturedGrid::addStressField(const FieldData& fieldData, const std::string& component)
 {
+    return addStressArrays(fieldData, nullptr, component);
+}
+
+bool CreateVTKUnstucturedGrid::addStressField(const std::shared_ptr<const FieldData>& fieldData, const std::string& component)
+{
+    return fieldData && addStressArrays(*fieldData, fieldData, component);
+}
+
+bool CreateVTKUnstucturedGrid::addStressArrays(const FieldData& storedField, std::shared_ptr<const FieldData> owner,
+                                               const std::string& component)
+{
+    owner = unpackedShared(storedField, std::move(owner));
+    const FieldData& stressField = storedField.isPacked() ? *owner : storedField;
     if (stressField.type != FieldType::STRESS) {
-        std::cerr << "[Error] Field is not a stress field." << std::endl;
+        ODB_LOG_ERROR("Field is not a stress field.");
         return false;
     }
 
-    if (!addFieldData(stressField)) {
+    if (!addFieldArrays(stressField, owner)) {
         return false;
     }
 
@@ -269,95 +520,203 @@ bool CreateVTKUnstucturedGrid::addStressField(const FieldData& stressField, cons
         if (it != stressField.componentLabels.end()) {
             int compIndex = static_cast<int>(std::distance(stressField.componentLabels.begin(), it));
 
-            std::vector<float> componentValues;
-            componentValues.reserve(m_odb.m_elementsNum);
-
-            for (std::size_t i = 0; i < m_odb.m_elementsNum; ++i) {
-                if (i < stressField.validFlags.size() && stressField.validFlags[i]) {
-                    const std::size_t base = i * stressField.components;
-                    componentValues.push_back(stressField.values[base + compIndex]);
-                } else {
-                    componentValues.push_back(0.0f);
+            std::vector<float> componentValues(m_odb.m_elementsNum, 0.0f);
+            for (std::size_t slot = 0; slot < stressField.slotCount(); ++slot) {
+                const std::size_t i = stressField.entityIndex(slot);
+                if (stressField.slotValid(slot) && i < componentValues.size()) {
+                    componentValues[i] = stressField.values[slot * stressField.components + compIndex];
                 }
             }
 
-            addCellScalar("S_" + component, componentValues);
-            std::cout << "[Info] Added stress component: " << component << std::endl;
+            addCellScalar("S_" + component, std::move(componentValues));
+            ODB_LOG_DEBUG("Added stress component: " << component);
         }
     }
 
-    // 计算von Mises应力
-    calculateVonMisesStress(stressField);
+    // 计算 von Mises 应力及其他导出量
+    addStressInvariants(stressField, m_stressInvariants);
 
     return true;
 }
 
 void CreateVTKUnstucturedGrid::calculateVonMisesStress(const FieldData& stressField)
 {
-    if (stressField.components < 6) {
-        std::cerr << "[Warning] Insufficient stress components for von Mises calculation." << std::endl;
-        return;
+    addStressInvariants(stressField, StressInvariantOptions());
+}
+
+bool CreateVTKUnstucturedGrid::addStressInvariants(const FieldData& storedField, const StressInvariantOptions& options)
+{
+    FieldData decoded;
+    const FieldData& stressField = unpackedView(storedField, decoded);
+    if (!isTensorLayout(stressField.components)) {
+        ODB_LOG_WARNING("Unsupported stress layout (" << stressField.components
+                        << " components) for invariant calculation.");
+        return false;
     }
-    std::vector<float> vonMisesValues;
-    vonMisesValues.reserve(m_odb.m_elementsNum);
-
-    for (std::size_t i = 0; i < m_odb.m_elementsNum; ++i) {
-        if (i < stressField.validFlags.size() && stressField.validFlags[i]) {
-            const std::size_t base = i * stressField.components;
-            const double s11 = stressField.values[base + 0];
-            const double s22 = stressField.values[base + 1];
-            const double s33 = stressField.values[base + 2];
-            const double s12 = stressField.values[base + 3];
-            const double s13 = stressField.values[base + 4];
-            const double s23 = stressField.values[base + 5];
-
-            const double vm = std::sqrt(0.5 * (
-                                            std::pow(s11 - s22, 2) +
-                                            std::pow(s22 - s33, 2) +
-                                            std::pow(s33 - s11, 2) +
-                                            6.0 * (std::pow(s12, 2) + std::pow(s23, 2) + std::pow(s13, 2))
-                                            ));
-            vonMisesValues.push_back(static_cast<float>(vm));
-        } else {
-            vonMisesValues.push_back(0.0f);
+
+    struct Quantity {
+        bool enabled;
+        const char* name;
+        int components;
+        float* TensorInvariantOutputs::*target;
+    };
+    const Quantity quantities[] = {
+        {options.mises, "VonMises", 1, &TensorInvariantOutputs::mises},
+        {options.principals, "MaxPrincipal", 1, &TensorInvariantOutputs::maxPrincipal},
+        {options.principals, "MidPrincipal", 1, &TensorInvariantOutputs::midPrincipal},
+        {options.principals, "MinPrincipal", 1, &TensorInvariantOutputs::minPrincipal},
+        {options.tresca, "Tresca", 1, &TensorInvariantOutputs::tresca},
+        {options.pressure, "Pressure", 1, &TensorInvariantOutputs::pressure},
+        {options.triaxiality, "Triaxiality", 1, &TensorInvariantOutputs::triaxiality},
+        {options.directions, "MaxPrincipalDirection", 3, &TensorInvariantOutputs::maxDirection},
+        {options.directions, "MidPrincipalDirection", 3, &TensorInvariantOutputs::midDirection},
+        {options.directions, "MinPrincipalDirection", 3, &TensorInvariantOutputs::minDirection},
+    };
+    constexpr std::size_t quantityCount = sizeof(quantities) / sizeof(quantities[0]);
+
+    tracing::Span span("addStressInvariants", "converter");
+    const std::size_t slots = stressField.slotCount();
+    const std::size_t elements = m_odb.m_elementsNum;
+    span.arg("elements", slots);
+
+    // 稠密且与单元一一对应时直接写入最终缓冲区（无效条目的值为 0，结果也为 0），否则按槽位计算后散射
+    const bool direct = !stressField.isSparse() && slots == elements;
+    TensorInvariantOutputs out;
+    std::shared_ptr<std::vector<float>> buffers[quantityCount];
+    for (std::size_t q = 0; q < quantityCount; ++q) {
+        if (quantities[q].enabled) {
+            buffers[q] = std::make_shared<std::vector<float>>(slots * quantities[q].components);
+            out.*quantities[q].target = buffers[q]->data();
         }
     }
 
-    addCellScalar("VonMises", vonMisesValues);
-    std::cout << "[Info] Calculated von Mises stress." << std::endl;
+    const std::size_t chunks = (slots + kInvariantChunkSize - 1) / kInvariantChunkSize;
+    pool().parallelFor(chunks, [&](std::size_t t) {
+        const std::size_t begin = t * kInvariantChunkSize;
+        const std::size_t end = std::min(slots, begin + kInvariantChunkSize);
+        computeTensorInvariants(stressField.values.data(), stressField.components, begin, end, out);
+    });
+
+    for (std::size_t q = 0; q < quantityCount; ++q) {
+        if (!buffers[q]) {
+            continue;
+        }
+        const std::size_t comps = static_cast<std::size_t>(quantities[q].components);
+        std::shared_ptr<std::vector<float>> buffer = buffers[q];
+        if (!direct) {
+            buffer = std::make_shared<std::vector<float>>(elements * comps, 0.0f);
+            for (std::size_t slot = 0; slot < slots; ++slot) {
+                const std::size_t i = stressField.entityIndex(slot);
+                if (stressField.slotValid(slot) && i < elements) {
+                    std::copy_n(buffers[q]->data() + slot * comps, comps, buffer->data() + i * comps);
+                }
+            }
+        }
+        vtkSmartPointer<vtkFloatArray> arr = wrapSharedBuffer<vtkFloatArray>(
+            buffer->data(), buffer->size(), quantities[q].components, buffer);
+        arr->SetName(quantities[q].name);
+        m_grid->GetCellData()->AddArray(arr);
+    }
+    ODB_LOG_DEBUG("Calculated stress invariants for " << slots << " elements.");
+    return true;
+}
+
+bool CreateVTKUnstucturedGrid::addFieldExpression(const std::string& name, const FieldExpression& expression,
+                                                  const std::vector<std::shared_ptr<const FieldData>>& fields,
+                                                  std::string* error)
+{
+    std::vector<const FieldData*> inputs;
+    inputs.reserve(fields.size());
+    for (const auto& field : fields) {
+        inputs.push_back(field.get());
+    }
+    // 结果直接由网格中的数组持有
+    auto result = std::make_shared<FieldData>();
+    if (!evaluateFieldExpression(expression, inputs, name, *result, &pool(), error)) {
+        return false;
+    }
+    return addFieldArrays(*result, result);
+}
+
+bool CreateVTKUnstucturedGrid::setDeformation(const std::shared_ptr<const FieldData>& displacement, double scaleFactor)
+{
+    std::shared_ptr<const FieldData> field = displacement;
+    if (field) {
+        field = unpackedShared(*field, field);
+        if (field->type != FieldType::DISPLACEMENT) {
+            ODB_LOG_ERROR("Field is not a displacement field.");
+            return false;
+        }
+        if (!field->isNodal || field->components < 2) {
+            ODB_LOG_ERROR("Displacement components invalid.");
+            return false;
+        }
+    }
+    m_displacement = std::move(field);
+    m_deformationScale = scaleFactor;
+    updateDeformedPoints();
+    return true;
 }
 
-void CreateVTKUnstucturedGrid::applyDisplacement(const FieldData& displacementField, double scaleFactor)
+void CreateVTKUnstucturedGrid::setDeformationScale(double scaleFactor)
+{
+    m_deformationScale = scaleFactor;
+    updateDeformedPoints();
+}
+
+void CreateVTKUnstucturedGrid::updateDeformedPoints()
 {
     vtkPoints* points = m_grid->GetPoints();
-    if (!points) {
-        std::cerr << "[Error] No points found in VTK grid." << std::endl;
+    if (!points || !m_referenceCoords) {
+        ODB_LOG_ERROR("No points found in VTK grid.");
         return;
     }
-
-    vtkIdType numPoints = points->GetNumberOfPoints();
-    if (displacementField.components <= 0) {
-        std::cerr << "[Error] Displacement components invalid." << std::endl;
+    if (!m_displacement || m_deformationScale == 0.0) {
+        if (points->GetData() != m_referenceCoords.Get()) {
+            points->SetData(m_referenceCoords);
+        }
         return;
     }
 
-    for (vtkIdType i = 0; i < numPoints; ++i) {
-        double point[3];
-        points->GetPoint(i, point);
+    tracing::Span span("updateDeformedPoints", "converter");
+    const std::size_t nodes = static_cast<std::size_t>(m_referenceCoords->GetNumberOfTuples());
+    span.arg("points", nodes);
+    if (!m_deformedCoords || static_cast<std::size_t>(m_deformedCoords->GetNumberOfTuples()) != nodes) {
+        m_deformedCoords = vtkSmartPointer<vtkFloatArray>::New();
+        m_deformedCoords->SetNumberOfComponents(3);
+        m_deformedCoords->SetNumberOfTuples(static_cast<vtkIdType>(nodes));
+    }
 
-        const std::size_t base = static_cast<std::size_t>(i) * displacementField.components;
-        if (displacementField.components >= 3) {
-            point[0] += static_cast<double>(displacementField.values[base + 0]) * scaleFactor;
-            point[1] += static_cast<double>(displacementField.values[base + 1]) * scaleFactor;
-            point[2] += static_cast<double>(displacementField.values[base + 2]) * scaleFactor;
-        } else if (displacementField.components >= 2) {
-            point[0] += static_cast<double>(displacementField.values[base + 0]) * scaleFactor;
-            point[1] += static_cast<double>(displacementField.values[base + 1]) * scaleFactor;
+    const FieldData& u = *m_displacement;
+    const float* reference = m_referenceCoords->GetPointer(0);
+    float* deformed = m_deformedCoords->GetPointer(0);
+    const float scale = static_cast<float>(m_deformationScale);
+    // 稠密布局下无效节点的位移为 0，直接参与计算；稀疏布局先复制参考坐标再按槽位叠加
+    const std::size_t covered = u.isSparse() ? 0 : std::min(nodes, u.slotCount());
+    const std::size_t chunks = (nodes + kPointChunkSize - 1) / kPointChunkSize;
+    pool().parallelFor(chunks, [&](std::size_t t) {
+        const std::size_t begin = t * kPointChunkSize;
+        const std::size_t end = std::min(nodes, begin + kPointChunkSize);
+        const std::size_t split = std::min(std::max(begin, covered), end);
+        deformCoordinates(reference, u.values.data(), u.components, scale, begin, split, deformed);
+        std::copy(reference + split * 3, reference + end * 3, deformed + split * 3);
+    });
+    if (u.isSparse()) {
+        const std::size_t comps = static_cast<std::size_t>(u.components);
+        const std::size_t used = std::min<std::size_t>(comps, 3);
+        for (std::size_t slot = 0; slot < u.slotCount(); ++slot) {
+            const std::size_t i = u.entityIndex(slot);
+            if (i >= nodes) continue;
+            for (std::size_t k = 0; k < used; ++k) {
+                deformed[i * 3 + k] += scale * u.values[slot * comps + k];
+            }
         }
-
-        points->SetPoint(i, point);
     }
 
-    points->Modified();
-    std::cout << "[Info] Applied displacement to " << numPoints << " points." << std::endl;
+    m_deformedCoords->Modified();
+    if (points->GetData() != m_deformedCoords.Get()) {
+        points->SetData(m_deformedCoords);
+    } else {
+        points->Modified();
+    }
 }
@@ -11,32 +11,102 @@
 #include <vtkPointData.h>
 #include <vtkCellData.h>
 #include <vtkIdTypeArray.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkTypeInt64Array.h>
 #include <vtkCellType.h>
+#include <memory>
 #include <unordered_map>
 
-#include "odbmanager.h"
+#include "resultsource.h"
+#include "nodalaverager.h"
+#include "threadpool.h"
+#include "fieldexpression.h"
+
+// 应力导出量的开关，对应的单元数组名见各字段
+struct StressInvariantOptions {
+    bool mises{true};         // VonMises
+    bool principals{false};   // MaxPrincipal / MidPrincipal / MinPrincipal
+    bool directions{false};   // MaxPrincipalDirection / MidPrincipalDirection / MinPrincipalDirection（3 分量）
+    bool tresca{false};       // Tresca
+    bool pressure{false};     // Pressure
+    bool triaxiality{false};  // Triaxiality
+};
 
 class CreateVTKUnstucturedGrid {
 public:
-    explicit CreateVTKUnstucturedGrid(const readOdb& odb);
-    void addCellScalar(const std::string& name, const std::vector<float>& values);
+    explicit CreateVTKUnstucturedGrid(const ResultSource& odb);
+    // 数组接管 values 的缓冲区，传入右值时不复制
+    void addCellScalar(const std::string& name, std::vector<float> values);
 
     bool writeToFile(const std::string& filename) const;
 
+    // 按引用传入时复制一份场数据到 VTK 数组
     bool addFieldData(const FieldData& fieldData);
     bool addDisplacementField(const FieldData& fieldData, double scaleFactor = 1.0);
     bool addStressField(const FieldData& fieldData, const std::string& component = "ALL");
+    // 共享所有权版本：稠密布局的 values 直接作为 VTK 数组的存储（只读），数组释放前场数据保持有效
+    bool addFieldData(const std::shared_ptr<const FieldData>& fieldData);
+    bool addDisplacementField(const std::shared_ptr<const FieldData>& fieldData, double scaleFactor = 1.0);
+    bool addStressField(const std::shared_ptr<const FieldData>& fieldData, const std::string& component = "ALL");
     void calculateVonMisesStress(const FieldData& stressField);
+    // 一遍扫描应力张量，按 options 生成单元数组；支持 6 / 4 / 3 分量布局
+    bool addStressInvariants(const FieldData& stressField, const StressInvariantOptions& options);
+    // 在 fields 上求表达式，结果作为名为 name 的数组加入（单元场同时生成节点平均），失败时返回 false 并给出原因
+    bool addFieldExpression(const std::string& name, const FieldExpression& expression,
+                            const std::vector<std::shared_ptr<const FieldData>>& fields, std::string* error = nullptr);
+    // addStressField 附带生成的导出量（默认只有 VonMises）
+    void setStressInvariants(const StressInvariantOptions& options) { m_stressInvariants = options; }
+
+    // 变形显示：参考坐标保持不变，变形坐标 = 参考坐标 + scale × U 写入第二个点缓冲区（按节点并行、SSE 向量化）
+    // displacement 为空或 scale 为 0 时网格使用未变形坐标；只改变比例时用 setDeformationScale，不必重复传入位移场
+    bool setDeformation(const std::shared_ptr<const FieldData>& displacement, double scaleFactor);
+    void setDeformationScale(double scaleFactor);
+    double deformationScale() const { return m_deformationScale; }
+    bool hasDeformation() const { return m_displacement != nullptr; }
+
+    // 节点平均、应力导出量、表达式与变形坐标共用一个线程池：1 为串行，0 为按硬件并发数；线程池在首次并行计算时创建
+    void setThreads(int threads);
+    int threads() const { return m_threads; }
+
+    // 单元场同时生成同名的节点平均点数据，用于平滑云图（默认关闭，界面显示时开启）
+    void setNodalAveraging(bool enabled, const NodalAveragingOptions& options = NodalAveragingOptions());
+    bool nodalAveraging() const { return m_nodalAveraging; }
+    // 最近一次为 name 生成的节点平均点数据的统计量；未生成时返回空
+    const FieldStats* nodalAverageStats(const std::string& name) const;
 
+    // 网格的单元连接数组与共享的场数组直接引用结果源的缓冲区，调用方只能读取，不能原地修改
     vtkUnstructuredGrid* getGrid() const { return m_grid.Get(); }
+
+    // Abaqus 单元类型名到 VTK 单元类型，不支持时返回 -1（不输出日志，由调用方按类型汇总）
+    static int abaqusToVTKCellType(const std::string& abaqusType);
 private:
-    const readOdb& m_odb;
+    const ResultSource& m_odb;
     vtkSmartPointer<vtkUnstructuredGrid> m_grid;
 
+    // 结果源释放几何缓存后仍需连接关系构建邻接表，这里共享持有一份
+    ElementConnectivity m_connectivity;
+    NodalAverager m_nodalAverager;
+    NodalAveragingOptions m_averagingOptions;
+    bool m_nodalAveraging{false};
+    std::unordered_map<std::string, FieldStats> m_nodalStats; // 与点数据中的平均数组同名
+    StressInvariantOptions m_stressInvariants;
+    vtkSmartPointer<vtkFloatArray> m_referenceCoords; // 未变形坐标，构建后不再修改
+    vtkSmartPointer<vtkFloatArray> m_deformedCoords;  // 首次变形时分配，改变比例时原地重写
+    std::shared_ptr<const FieldData> m_displacement;  // 已解码的位移场
+    double m_deformationScale{0.0};
+    int m_threads{0};
+    std::unique_ptr<ThreadPool> m_pool;
+
+    ThreadPool& pool();
+
     void buildGeometry();
-    static int abaqusToVTKCellType(const std::string& abaqusType);
-    void applyDisplacement(const FieldData& displacementField, double scaleFactor);
-    vtkSmartPointer<vtkFloatArray> makeFloatArray(const std::string& name, int numComponents,
-        std::size_t tupleCount, const std::vector<float>& values, const std::vector<uint8_t>& validFlags);
+    // owner 非空且与 fieldData 为同一对象时共享其缓冲区，否则复制
+    bool addFieldArrays(const FieldData& fieldData, std::shared_ptr<const FieldData> owner);
+    bool addDisplacementArrays(const FieldData& fieldData, std::shared_ptr<const FieldData> owner, double scaleFactor);
+    bool addStressArrays(const FieldData& fieldData, std::shared_ptr<const FieldData> owner, const std::string& component);
+    bool addNodalAverage(const FieldData& elementField);
+    void updateDeformedPoints();
+    vtkSmartPointer<vtkFloatArray> makeFloatArray(const FieldData& fieldData, std::size_t tupleCount,
+                                                  std::shared_ptr<const FieldData> owner = nullptr);
 };
 #endif // CREATEGRID_H
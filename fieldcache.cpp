@@ -0,0 +1,135 @@
+#include "fieldcache.h"
+
+std::shared_ptr<const FieldData> FieldCache::find(const FieldCacheKey& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->data;
+}
+
+bool FieldCache::contains(const FieldCacheKey& key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.find(key) != m_index.end();
+}
+
+void FieldCache::insert(const FieldCacheKey& key, std::shared_ptr<const FieldData> data)
+{
+    if (!data) return;
+    const std::size_t bytes = estimateBytes(*data);
+    const IntegrationPointData* points = data->integrationPoints.get();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        removeEntry(it->second);
+    }
+    // 单个场超过预算时不缓存，调用方仍持有其 shared_ptr
+    const bool pointsCached = points && m_pointRefs.count(points) > 0;
+    if (bytes + (points && !pointsCached ? pointBytes(*points) : 0) > m_byteBudget) {
+        return;
+    }
+    m_lru.push_front(Entry{key, std::move(data), bytes});
+    m_index[key] = m_lru.begin();
+    m_bytes += bytes;
+    retainPoints(points);
+    evictToBudget();
+}
+
+void FieldCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_pointRefs.clear();
+    m_bytes = 0;
+}
+
+void FieldCache::setByteBudget(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_byteBudget = bytes;
+    evictToBudget();
+}
+
+std::size_t FieldCache::byteBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_byteBudget;
+}
+
+FieldCacheStats FieldCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FieldCacheStats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.evictions = m_evictions;
+    s.entries = m_lru.size();
+    s.bytes = m_bytes;
+    s.byteBudget = m_byteBudget;
+    return s;
+}
+
+std::size_t FieldCache::estimateBytes(const FieldData& fieldData)
+{
+    std::size_t bytes = sizeof(FieldData);
+    bytes += fieldData.values.capacity() * sizeof(float);
+    bytes += fieldData.validFlags.capacity() * sizeof(std::uint8_t);
+    bytes += fieldData.sparseIndices.capacity() * sizeof(std::uint32_t);
+    bytes += fieldData.packed.codes.capacity() * sizeof(std::uint16_t);
+    bytes += (fieldData.packed.scale.capacity() + fieldData.packed.offset.capacity()) * sizeof(float);
+    bytes += fieldData.packed.validBits.capacity() * sizeof(std::uint64_t);
+    for (const std::string& label : fieldData.componentLabels) {
+        bytes += sizeof(std::string) + label.capacity();
+    }
+    for (const ChannelStats& channel : fieldData.stats.channels) {
+        bytes += sizeof(ChannelStats) + channel.quantiles.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+std::size_t FieldCache::pointBytes(const IntegrationPointData& points)
+{
+    return sizeof(IntegrationPointData) + points.offsets.capacity() * sizeof(std::size_t)
+        + points.values.capacity() * sizeof(float);
+}
+
+void FieldCache::retainPoints(const IntegrationPointData* points)
+{
+    if (points && ++m_pointRefs[points] == 1) {
+        m_bytes += pointBytes(*points);
+    }
+}
+
+void FieldCache::releasePoints(const IntegrationPointData* points)
+{
+    if (!points) return;
+    auto it = m_pointRefs.find(points);
+    if (it != m_pointRefs.end() && --it->second == 0) {
+        m_bytes -= pointBytes(*points);
+        m_pointRefs.erase(it);
+    }
+}
+
+void FieldCache::removeEntry(EntryList::iterator it)
+{
+    m_bytes -= it->bytes;
+    releasePoints(it->data->integrationPoints.get());
+    m_index.erase(it->key);
+    m_lru.erase(it);
+}
+
+void FieldCache::evictToBudget()
+{
+    while (m_bytes > m_byteBudget && !m_lru.empty()) {
+        removeEntry(std::prev(m_lru.end()));
+        ++m_evictions;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef FIELDCACHE_H
+#define FIELDCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "fielddata.h"
+
+struct FieldCacheKey {
+    std::string stepName;
+    int frameIndex{0};
+    std::string fieldName;
+
+    bool operator==(const FieldCacheKey& other) const
+    {
+        return frameIndex == other.frameIndex && stepName == other.stepName && fieldName == other.fieldName;
+    }
+};
+
+struct FieldCacheKeyHash {
+    std::size_t operator()(const FieldCacheKey& key) const
+    {
+        std::size_t h = std::hash<std::string>()(key.stepName);
+        h ^= std::hash<int>()(key.frameIndex) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<std::string>()(key.fieldName) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct FieldCacheStats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t evictions{0};
+    std::size_t entries{0};
+    std::size_t bytes{0};
+    std::size_t byteBudget{0};
+};
+
+// 按 (步, 帧, 场) 缓存多个 FieldData，超出字节预算时按 LRU 淘汰
+// 条目以 shared_ptr 持有，被淘汰的场若仍在使用不会被提前释放；线程安全
+class FieldCache {
+public:
+    static constexpr std::size_t kDefaultByteBudget = std::size_t(1) << 30; // 1 GiB
+
+    explicit FieldCache(std::size_t byteBudget = kDefaultByteBudget) : m_byteBudget(byteBudget) {}
+
+    std::shared_ptr<const FieldData> find(const FieldCacheKey& key);
+    bool contains(const FieldCacheKey& key) const; // 不计入命中统计，也不改变 LRU 顺序
+    void insert(const FieldCacheKey& key, std::shared_ptr<const FieldData> data);
+    void clear();
+
+    void setByteBudget(std::size_t bytes);
+    std::size_t byteBudget() const;
+    FieldCacheStats stats() const;
+
+    // 不含积分点数据；积分点数据可能被同一场的多个汇总版本共享，单独用 pointBytes 估算
+    static std::size_t estimateBytes(const FieldData& fieldData);
+    static std::size_t pointBytes(const IntegrationPointData& points);
+
+private:
+    struct Entry {
+        FieldCacheKey key;
+        std::shared_ptr<const FieldData> data;
+        std::size_t bytes{0}; // 不含积分点数据
+    };
+    using EntryList = std::list<Entry>;
+
+    // 以下调用方需持有 m_mutex
+    void evictToBudget();
+    void removeEntry(EntryList::iterator it);
+    // 共享的积分点数据按引用计数只计入一次：第一个引用加入时计入，最后一个引用移除时扣除
+    void retainPoints(const IntegrationPointData* points);
+    void releasePoints(const IntegrationPointData* points);
+
+    mutable std::mutex m_mutex;
+    EntryList m_lru; // 头部为最近使用
+    std::unordered_map<FieldCacheKey, EntryList::iterator, FieldCacheKeyHash> m_index;
+    std::unordered_map<const IntegrationPointData*, std::size_t> m_pointRefs;
+    std::size_t m_byteBudget;
+    std::size_t m_bytes{0};
+    std::size_t m_hits{0};
+    std::size_t m_misses{0};
+    std::size_t m_evictions{0};
+};
+
+#endif // FIELDCACHE_H
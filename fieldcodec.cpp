@@ -0,0 +1,217 @@
+#include "fieldcodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// 半精度最大有限值为 65504，缩放后的绝对值不超过该值的一半，留出舍入余量
+constexpr float kHalfSafeMax = 32768.0f;
+// 16 位量化保留最大码表示非有限值（NaN / Inf），有限值映射到 [0, kQuantizedMaxCode]
+constexpr std::uint16_t kNonFiniteCode = 65535;
+constexpr float kQuantizedMaxCode = 65534.0f;
+
+std::uint32_t floatBits(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(std::uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void decodeValues(const FieldData& fieldData, std::vector<float>& values, std::vector<std::uint8_t>& validFlags)
+{
+    const PackedFieldValues& packed = fieldData.packed;
+    const std::size_t numComp = static_cast<std::size_t>(fieldData.components);
+    // 稀疏布局的槽位全部有效，不需要 validFlags
+    const bool sparse = fieldData.isSparse();
+    values.assign(packed.entityCount * numComp, 0.0f);
+    validFlags.assign(sparse ? 0 : packed.entityCount, 0);
+    for (std::size_t i = 0; i < packed.entityCount; ++i) {
+        if (!((packed.validBits[i >> 6] >> (i & 63)) & 1u)) continue;
+        if (!sparse) validFlags[i] = 1;
+        const std::uint16_t* code = packed.codes.data() + i * numComp;
+        float* dst = values.data() + i * numComp;
+        for (std::size_t c = 0; c < numComp; ++c) {
+            if (fieldData.storage == FieldStorage::FLOAT16) {
+                dst[c] = halfToFloat(code[c]) * packed.scale[c];
+            } else {
+                dst[c] = code[c] == kNonFiniteCode ? std::numeric_limits<float>::quiet_NaN()
+                                                   : packed.offset[c] + static_cast<float>(code[c]) * packed.scale[c];
+            }
+        }
+    }
+}
+
+} // namespace
+
+std::uint16_t floatToHalf(float value)
+{
+    const std::uint32_t bits = floatBits(value);
+    const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    const std::uint32_t absBits = bits & 0x7fffffffu;
+
+    if (absBits >= 0x7f800000u) { // Inf / NaN
+        return static_cast<std::uint16_t>(sign | 0x7c00u | (absBits > 0x7f800000u ? 0x200u : 0u));
+    }
+    if (absBits >= 0x477ff000u) { // 舍入后超出半精度范围
+        return static_cast<std::uint16_t>(sign | 0x7c00u);
+    }
+    if (absBits < 0x38800000u) { // 半精度非规格化数或 0
+        if (absBits < 0x33000000u) return sign;
+        const std::uint32_t mantissa = (absBits & 0x7fffffu) | 0x800000u;
+        const int shift = 126 - static_cast<int>(absBits >> 23);
+        std::uint32_t half = mantissa >> shift;
+        const std::uint32_t rest = mantissa & ((1u << shift) - 1u);
+        const std::uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1u))) ++half;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+    // 规格化数：调整指数偏置，尾数按最近偶数舍入
+    std::uint32_t half = ((absBits - 0x38000000u) >> 13);
+    const std::uint32_t rest = absBits & 0x1fffu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) ++half;
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+float halfToFloat(std::uint16_t half)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1fu;
+    std::uint32_t mantissa = half & 0x3ffu;
+
+    if (exponent == 0x1fu) {
+        return bitsToFloat(sign | 0x7f800000u | (mantissa << 13));
+    }
+    if (exponent == 0) {
+        if (mantissa == 0) return bitsToFloat(sign);
+        // 非规格化数：规格化后再转换
+        int e = -1;
+        do {
+            ++e;
+            mantissa <<= 1;
+        } while (!(mantissa & 0x400u));
+        return bitsToFloat(sign | ((112u - static_cast<std::uint32_t>(e)) << 23) | ((mantissa & 0x3ffu) << 13));
+    }
+    return bitsToFloat(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+void packFieldData(FieldData& fieldData, FieldStorage storage)
+{
+    if (fieldData.storage == storage) return;
+    if (fieldData.isPacked()) {
+        unpackFieldData(fieldData);
+    }
+    if (storage == FieldStorage::FLOAT32) return;
+
+    const std::size_t numComp = static_cast<std::size_t>(fieldData.components);
+    const std::size_t entityCount = fieldData.slotCount();
+    if (numComp == 0 || fieldData.values.size() < entityCount * numComp) return;
+
+    // 分量范围优先取提取时的统计量，没有（或含非有限值）时扫描一遍，只统计有限值
+    std::vector<float> lo(numComp, 0.0f), hi(numComp, 0.0f);
+    bool haveRange = fieldData.stats.channels.size() >= numComp;
+    for (std::size_t c = 0; haveRange && c < numComp; ++c) {
+        const ChannelStats& ch = fieldData.stats.channels[c];
+        lo[c] = ch.min;
+        hi[c] = ch.max;
+        haveRange = ch.count > 0 && std::isfinite(lo[c]) && std::isfinite(hi[c]);
+    }
+    if (!haveRange) {
+        std::vector<std::uint8_t> seen(numComp, 0);
+        for (std::size_t i = 0; i < entityCount; ++i) {
+            if (!fieldData.slotValid(i)) continue;
+            for (std::size_t c = 0; c < numComp; ++c) {
+                const float v = fieldData.values[i * numComp + c];
+                if (!std::isfinite(v)) continue;
+                lo[c] = seen[c] ? std::min(lo[c], v) : v;
+                hi[c] = seen[c] ? std::max(hi[c], v) : v;
+                seen[c] = 1;
+            }
+        }
+        for (std::size_t c = 0; c < numComp; ++c) {
+            if (!seen[c]) lo[c] = hi[c] = 0.0f;
+        }
+    }
+
+    PackedFieldValues packed;
+    packed.entityCount = entityCount;
+    packed.codes.assign(entityCount * numComp, 0);
+    packed.scale.assign(numComp, 1.0f);
+    packed.offset.assign(numComp, 0.0f);
+    packed.validBits.assign((entityCount + 63) / 64, 0);
+    for (std::size_t c = 0; c < numComp; ++c) {
+        if (storage == FieldStorage::FLOAT16) {
+            // 2 的幂缩放只改变指数，不损失半精度的尾数精度
+            const float peak = std::max(std::fabs(lo[c]), std::fabs(hi[c]));
+            int exponent = 0;
+            if (peak > kHalfSafeMax) {
+                std::frexp(peak / kHalfSafeMax, &exponent);
+            }
+            packed.scale[c] = std::ldexp(1.0f, exponent);
+        } else {
+            packed.offset[c] = lo[c];
+            packed.scale[c] = hi[c] > lo[c] ? (hi[c] - lo[c]) / kQuantizedMaxCode : 1.0f;
+        }
+    }
+
+    for (std::size_t i = 0; i < entityCount; ++i) {
+        if (!fieldData.slotValid(i)) continue;
+        packed.validBits[i >> 6] |= std::uint64_t(1) << (i & 63);
+        const float* src = fieldData.values.data() + i * numComp;
+        std::uint16_t* code = packed.codes.data() + i * numComp;
+        for (std::size_t c = 0; c < numComp; ++c) {
+            if (storage == FieldStorage::FLOAT16) {
+                code[c] = floatToHalf(src[c] / packed.scale[c]);
+            } else if (!std::isfinite(src[c])) {
+                // NaN 经 min / max 钳制后仍为 NaN，转换为整数是未定义行为，先单独处理
+                code[c] = kNonFiniteCode;
+            } else {
+                const float q = std::round((src[c] - packed.offset[c]) / packed.scale[c]);
+                code[c] = static_cast<std::uint16_t>(std::min(std::max(q, 0.0f), kQuantizedMaxCode));
+            }
+        }
+    }
+
+    fieldData.packed = std::move(packed);
+    fieldData.storage = storage;
+    std::vector<float>().swap(fieldData.values);
+    std::vector<std::uint8_t>().swap(fieldData.validFlags);
+}
+
+void unpackFieldData(FieldData& fieldData)
+{
+    if (!fieldData.isPacked()) return;
+    decodeValues(fieldData, fieldData.values, fieldData.validFlags);
+    fieldData.packed = PackedFieldValues();
+    fieldData.storage = FieldStorage::FLOAT32;
+}
+
+const FieldData& unpackedView(const FieldData& fieldData, FieldData& scratch)
+{
+    if (!fieldData.isPacked()) return fieldData;
+    scratch.type = fieldData.type;
+    scratch.name = fieldData.name;
+    scratch.description = fieldData.description;
+    scratch.componentLabels = fieldData.componentLabels;
+    scratch.components = fieldData.components;
+    scratch.isNodal = fieldData.isNodal;
+    scratch.unit = fieldData.unit;
+    scratch.integrationPoints = fieldData.integrationPoints;
+    scratch.reduction = fieldData.reduction;
+    scratch.selectedPoint = fieldData.selectedPoint;
+    scratch.stats = fieldData.stats;
+    scratch.sparseIndices = fieldData.sparseIndices;
+    scratch.storage = FieldStorage::FLOAT32;
+    scratch.packed = PackedFieldValues();
+    decodeValues(fieldData, scratch.values, scratch.validFlags);
+    return scratch;
+}
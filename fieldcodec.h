@@ -0,0 +1,22 @@
+#ifndef FIELDCODEC_H
+#define FIELDCODEC_H
+
+#include <cstdint>
+
+#include "fielddata.h"
+
+// 场数据的 16 位紧凑编码：values / validFlags 转为 PackedFieldValues，积分点数据与统计量保持不变
+// 量化误差不超过分量范围的 1/131068，半精度相对误差约 1/2048，均低于 256 级色标的分辨率
+// 非有限值：半精度保留 NaN / Inf；16 位量化用保留码表示，解码为 NaN，不参与范围计算
+
+std::uint16_t floatToHalf(float value);
+float halfToFloat(std::uint16_t half);
+
+// 按 storage 编码；storage 为 FLOAT32 时等价于 unpackFieldData
+void packFieldData(FieldData& fieldData, FieldStorage storage);
+// 就地解码回稠密 float
+void unpackFieldData(FieldData& fieldData);
+// 未编码时直接返回 fieldData，否则解码到 scratch 并返回 scratch
+const FieldData& unpackedView(const FieldData& fieldData, FieldData& scratch);
+
+#endif // FIELDCODEC_H
@@ -0,0 +1,128 @@
+#ifndef FIELDDATA_H
+#define FIELDDATA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class FieldType {
+    DISPLACEMENT,
+    ROTATION,
+    STRESS,
+    GENERIC
+};
+
+// 积分点汇总方式：由保留的全部积分点数据在内存中得到每个单元的一个值
+enum class IPReduction {
+    FIRST_POINT,   // 第一个积分点（未保留全部积分点时的默认行为）
+    CENTROID,      // 各积分点取平均，近似单元质心值
+    MAXIMUM,       // 每个分量在各积分点上的最大值
+    SELECTED_POINT // 指定编号的积分点（超出范围时取最后一个）
+};
+
+// 单元全部积分点的紧凑存储：单元 e 的第 k 个积分点位于 values[(offsets[e] + k) * components + comp]
+struct IntegrationPointData {
+    static constexpr std::size_t kPadding = 8; // values 末尾预留，供 SIMD 整块读取时越界
+
+    std::vector<std::size_t> offsets; // 长度为单元数 + 1，以积分点计
+    std::vector<float> values;
+
+    std::size_t pointCount(std::size_t element) const { return offsets[element + 1] - offsets[element]; }
+};
+
+// 场数据存储方式：FLOAT32 为稠密 float；其余两种用 16 位编码，内存约减半
+enum class FieldStorage {
+    FLOAT32,
+    FLOAT16,    // 半精度浮点，每个分量按 2 的幂缩放以避开半精度的表示范围上限
+    QUANTIZED16 // 每个分量在 [min, max] 上均匀量化为 65536 级
+};
+
+// 16 位紧凑存储，编解码见 fieldcodec.*
+struct PackedFieldValues {
+    std::size_t entityCount{0};
+    std::vector<std::uint16_t> codes;     // [entity * components + comp]
+    std::vector<float> scale;             // 每个分量：FLOAT16 为缩放因子，QUANTIZED16 为量化步长
+    std::vector<float> offset;            // QUANTIZED16 每个分量的下界
+    std::vector<std::uint64_t> validBits; // 有效性位图，每个实体 1 位
+};
+
+// 单一通道（某个分量或模长）的统计量，只统计 validFlags 为 1 的条目
+struct ChannelStats {
+    static constexpr int kQuantileCount = 101; // 0%, 1%, ..., 100%
+
+    std::size_t count{0};
+    float min{0.0f};
+    float max{0.0f};
+    double mean{0.0};
+    std::vector<float> quantiles; // 由抽样估计的近似分位数，count 为 0 时为空
+
+    // p 取 [0, 100]，在相邻百分位之间线性插值；无数据时返回 0
+    float percentile(double p) const;
+};
+
+// 场数据统计：channels[c] 对应分量 c，多分量场最后追加一个模长通道
+struct FieldStats {
+    std::vector<ChannelStats> channels;
+
+    bool empty() const { return channels.empty(); }
+    const ChannelStats* component(int c) const
+    {
+        return (c >= 0 && static_cast<std::size_t>(c) < channels.size()) ? &channels[c] : nullptr;
+    }
+    const ChannelStats* magnitude() const { return channels.empty() ? nullptr : &channels.back(); }
+};
+
+inline float ChannelStats::percentile(double p) const
+{
+    if (quantiles.empty()) return 0.0f;
+    const double pos = std::min(std::max(p, 0.0), 100.0) * (kQuantileCount - 1) / 100.0;
+    const std::size_t lo = static_cast<std::size_t>(pos);
+    if (lo + 1 >= quantiles.size()) return quantiles.back();
+    const double t = pos - static_cast<double>(lo);
+    return static_cast<float>(quantiles[lo] + t * (quantiles[lo + 1] - quantiles[lo]));
+}
+
+struct FieldData {
+    FieldType type;
+    std::string name;
+    std::string description;
+    std::vector<std::string> componentLabels;
+    int components{0};
+
+    // 无效条目的值在提取时即为 0，稠密布局的 values 因而可直接作为 VTK 数组的存储（见 creategrid.cpp）
+    std::vector<float> values;       // 统一存储场数据 [slot * components + comp]，稠密布局时 slot 即全局索引
+    std::vector<uint8_t> validFlags; // 统一有效性标志 (0/1)，稀疏布局时为空
+    bool isNodal{true};              // 标记是节点数据还是单元数据
+    std::string unit;
+
+    // 可选：单元全部积分点数据，values 为按 reduction 汇总后的结果
+    std::shared_ptr<const IntegrationPointData> integrationPoints;
+    IPReduction reduction{IPReduction::FIRST_POINT};
+    int selectedPoint{0};
+
+    // 提取时与数据写入同一遍计算，显示时直接用作色标范围
+    FieldStats stats;
+
+    // storage 非 FLOAT32 时 values / validFlags 为空，数据保存在 packed 中
+    FieldStorage storage{FieldStorage::FLOAT32};
+    PackedFieldValues packed;
+    bool isPacked() const { return storage != FieldStorage::FLOAT32; }
+
+    // 稀疏布局：覆盖率低时只保存出现的实体，第 slot 个值属于全局索引 sparseIndices[slot]
+    std::vector<std::uint32_t> sparseIndices; // 升序
+    bool isSparse() const { return !sparseIndices.empty(); }
+
+    // 按存储槽位遍历（未编码时），稠密与稀疏布局通用
+    std::size_t slotCount() const
+    {
+        if (isSparse()) return sparseIndices.size();
+        return isPacked() ? packed.entityCount : validFlags.size();
+    }
+    bool slotValid(std::size_t slot) const { return isSparse() || validFlags[slot] != 0; }
+    std::size_t entityIndex(std::size_t slot) const { return isSparse() ? sparseIndices[slot] : slot; }
+};
+
+#endif // FIELDDATA_H
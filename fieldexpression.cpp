@@ -0,0 +1,619 @@
+#include "fieldexpression.h"
+#include "fieldcodec.h"
+#include "fieldstats.h"
+#include "threadpool.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <locale>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+// 表达式求值按实体分块并行的块大小
+constexpr std::size_t kChunkSize = 1 << 16;
+
+bool isIdentifierStart(char c)
+{
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+} // namespace
+
+// 递归下降解析为语法树，生成字节码时折叠常量子表达式并把常数指数、常数操作数化简为专用指令
+class FieldExpressionCompiler {
+public:
+    using Op = FieldExpression::Op;
+
+    FieldExpressionCompiler(const std::string& text, FieldExpression& expression)
+        : m_text(text)
+        , m_expression(expression)
+    {
+    }
+
+    bool run(std::string& error)
+    {
+        std::unique_ptr<Node> root = parseSum();
+        skipSpaces();
+        if (root && m_pos < m_text.size()) {
+            fail("unexpected '" + std::string(1, m_text[m_pos]) + "'");
+        }
+        if (!m_error.empty()) {
+            error = "position " + std::to_string(m_errorPos + 1) + ": " + m_error;
+            return false;
+        }
+        emit(*root);
+        return true;
+    }
+
+private:
+    struct Node {
+        Op op;
+        float value{0.0f};
+        std::uint32_t variable{0};
+        std::unique_ptr<Node> a;
+        std::unique_ptr<Node> b;
+    };
+
+    static float apply(Op op, float x, float y)
+    {
+        switch (op) {
+        case Op::NEG: return -x;
+        case Op::ABS: return std::fabs(x);
+        case Op::SQRT: return std::sqrt(x);
+        case Op::SQUARE: return x * x;
+        case Op::CUBE: return x * x * x;
+        case Op::EXP: return std::exp(x);
+        case Op::LOG: return std::log(x);
+        case Op::SIN: return std::sin(x);
+        case Op::COS: return std::cos(x);
+        case Op::TAN: return std::tan(x);
+        case Op::ADD: return x + y;
+        case Op::SUB: return x - y;
+        case Op::MUL: return x * y;
+        case Op::DIV: return x / y;
+        case Op::POW: return std::pow(x, y);
+        case Op::MIN: return std::min(x, y);
+        case Op::MAX: return std::max(x, y);
+        default: return x;
+        }
+    }
+
+    static std::unique_ptr<Node> constant(float value)
+    {
+        auto node = std::make_unique<Node>();
+        node->op = Op::CONST;
+        node->value = value;
+        return node;
+    }
+
+    static std::unique_ptr<Node> unary(Op op, std::unique_ptr<Node> a)
+    {
+        if (a->op == Op::CONST) {
+            return constant(apply(op, a->value, 0.0f));
+        }
+        auto node = std::make_unique<Node>();
+        node->op = op;
+        node->a = std::move(a);
+        return node;
+    }
+
+    static std::unique_ptr<Node> binary(Op op, std::unique_ptr<Node> a, std::unique_ptr<Node> b)
+    {
+        if (a->op == Op::CONST && b->op == Op::CONST) {
+            return constant(apply(op, a->value, b->value));
+        }
+        if (op == Op::POW && b->op == Op::CONST) {
+            if (b->value == 1.0f) return a;
+            if (b->value == 2.0f) return unary(Op::SQUARE, std::move(a));
+            if (b->value == 3.0f) return unary(Op::CUBE, std::move(a));
+            if (b->value == 0.5f) return unary(Op::SQRT, std::move(a));
+        }
+        auto node = std::make_unique<Node>();
+        node->op = op;
+        node->a = std::move(a);
+        node->b = std::move(b);
+        return node;
+    }
+
+    void fail(const std::string& message)
+    {
+        if (m_error.empty()) {
+            m_error = message;
+            m_errorPos = m_pos;
+        }
+    }
+
+    void skipSpaces()
+    {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+    }
+
+    bool accept(char c)
+    {
+        skipSpaces();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    std::unique_ptr<Node> parseSum()
+    {
+        std::unique_ptr<Node> node = parseProduct();
+        while (node) {
+            if (accept('+')) node = combine(Op::ADD, std::move(node), parseProduct());
+            else if (accept('-')) node = combine(Op::SUB, std::move(node), parseProduct());
+            else break;
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> parseProduct()
+    {
+        std::unique_ptr<Node> node = parseUnary();
+        while (node) {
+            if (accept('*')) node = combine(Op::MUL, std::move(node), parseUnary());
+            else if (accept('/')) node = combine(Op::DIV, std::move(node), parseUnary());
+            else break;
+        }
+        return node;
+    }
+
+    // 一元负号的优先级低于 ^：-x^2 = -(x^2)
+    std::unique_ptr<Node> parseUnary()
+    {
+        if (accept('-')) {
+            std::unique_ptr<Node> a = parseUnary();
+            return a ? unary(Op::NEG, std::move(a)) : nullptr;
+        }
+        if (accept('+')) {
+            return parseUnary();
+        }
+        std::unique_ptr<Node> base = parsePrimary();
+        if (base && accept('^')) {
+            return combine(Op::POW, std::move(base), parseUnary());
+        }
+        return base;
+    }
+
+    std::unique_ptr<Node> combine(Op op, std::unique_ptr<Node> a, std::unique_ptr<Node> b)
+    {
+        return (a && b) ? binary(op, std::move(a), std::move(b)) : nullptr;
+    }
+
+    std::unique_ptr<Node> parsePrimary()
+    {
+        skipSpaces();
+        if (m_pos >= m_text.size()) {
+            fail("unexpected end of expression");
+            return nullptr;
+        }
+        const char c = m_text[m_pos];
+        if (accept('(')) {
+            std::unique_ptr<Node> node = parseSum();
+            if (node && !accept(')')) {
+                fail("expected ')'");
+                return nullptr;
+            }
+            return node;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            return parseNumber();
+        }
+        if (isIdentifierStart(c)) {
+            const std::size_t start = m_pos;
+            while (m_pos < m_text.size() && isIdentifierChar(m_text[m_pos])) ++m_pos;
+            const std::string name = m_text.substr(start, m_pos - start);
+            if (accept('(')) {
+                return parseCall(name, start);
+            }
+            return variable(name);
+        }
+        fail("unexpected '" + std::string(1, c) + "'");
+        return nullptr;
+    }
+
+    // 数字按 "C" 区域设置解析，不受界面语言的小数点影响
+    std::unique_ptr<Node> parseNumber()
+    {
+        const std::size_t start = m_pos;
+        auto digits = [&]() {
+            while (m_pos < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[m_pos]))) ++m_pos;
+        };
+        digits();
+        if (m_pos < m_text.size() && m_text[m_pos] == '.') {
+            ++m_pos;
+            digits();
+        }
+        if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E')) {
+            std::size_t p = m_pos + 1;
+            if (p < m_text.size() && (m_text[p] == '+' || m_text[p] == '-')) ++p;
+            if (p < m_text.size() && std::isdigit(static_cast<unsigned char>(m_text[p]))) {
+                m_pos = p;
+                digits();
+            }
+        }
+        std::istringstream in(m_text.substr(start, m_pos - start));
+        in.imbue(std::locale::classic());
+        double value = 0.0;
+        if (!(in >> value)) {
+            m_pos = start;
+            fail("invalid number");
+            return nullptr;
+        }
+        return constant(static_cast<float>(value));
+    }
+
+    std::unique_ptr<Node> parseCall(const std::string& name, std::size_t start)
+    {
+        struct Function {
+            const char* name;
+            Op op;
+            int arity;
+        };
+        static const Function functions[] = {
+            {"sqrt", Op::SQRT, 1}, {"abs", Op::ABS, 1}, {"exp", Op::EXP, 1}, {"log", Op::LOG, 1},
+            {"sin", Op::SIN, 1}, {"cos", Op::COS, 1}, {"tan", Op::TAN, 1},
+            {"min", Op::MIN, 2}, {"max", Op::MAX, 2}, {"pow", Op::POW, 2},
+        };
+        const Function* function = nullptr;
+        for (const Function& f : functions) {
+            if (name == f.name) function = &f;
+        }
+        if (!function) {
+            m_pos = start;
+            fail("unknown function '" + name + "'");
+            return nullptr;
+        }
+        std::unique_ptr<Node> args[2];
+        for (int i = 0; i < function->arity; ++i) {
+            if (i > 0 && !accept(',')) {
+                fail(name + "() expects " + std::to_string(function->arity) + " arguments");
+                return nullptr;
+            }
+            args[i] = parseSum();
+            if (!args[i]) return nullptr;
+        }
+        if (!accept(')')) {
+            fail("expected ')' after arguments of " + name + "()");
+            return nullptr;
+        }
+        return function->arity == 1 ? unary(function->op, std::move(args[0]))
+                                    : binary(function->op, std::move(args[0]), std::move(args[1]));
+    }
+
+    std::unique_ptr<Node> variable(const std::string& name)
+    {
+        std::vector<std::string>& variables = m_expression.m_variables;
+        auto it = std::find(variables.begin(), variables.end(), name);
+        auto node = std::make_unique<Node>();
+        node->op = Op::LOAD;
+        node->variable = static_cast<std::uint32_t>(it - variables.begin());
+        if (it == variables.end()) {
+            variables.push_back(name);
+        }
+        return node;
+    }
+
+    void push(Op op, std::uint32_t operand = 0, float value = 0.0f)
+    {
+        m_expression.m_code.push_back({op, operand, value});
+    }
+
+    void emit(const Node& node)
+    {
+        switch (node.op) {
+        case Op::CONST:
+            push(Op::CONST, 0, node.value);
+            grow(1);
+            return;
+        case Op::LOAD:
+            push(Op::LOAD, node.variable);
+            grow(1);
+            return;
+        default:
+            break;
+        }
+        if (!node.b) {
+            emit(*node.a);
+            push(node.op);
+            return;
+        }
+        // 一侧为常数的加减乘除不占用栈槽
+        const bool constA = node.a->op == Op::CONST;
+        const bool constB = node.b->op == Op::CONST;
+        if (constB && (node.op == Op::ADD || node.op == Op::SUB)) {
+            emit(*node.a);
+            push(Op::ADD_CONST, 0, node.op == Op::ADD ? node.b->value : -node.b->value);
+            return;
+        }
+        if (constB && (node.op == Op::MUL || node.op == Op::DIV)) {
+            emit(*node.a);
+            push(Op::MUL_CONST, 0, node.op == Op::MUL ? node.b->value : 1.0f / node.b->value);
+            return;
+        }
+        if (constA && (node.op == Op::ADD || node.op == Op::MUL)) {
+            emit(*node.b);
+            push(node.op == Op::ADD ? Op::ADD_CONST : Op::MUL_CONST, 0, node.a->value);
+            return;
+        }
+        emit(*node.a);
+        emit(*node.b);
+        push(node.op);
+        grow(-1);
+    }
+
+    void grow(int delta)
+    {
+        m_depth += delta;
+        m_expression.m_stackDepth = std::max(m_expression.m_stackDepth, m_depth);
+    }
+
+    const std::string& m_text;
+    FieldExpression& m_expression;
+    std::size_t m_pos{0};
+    std::size_t m_depth{0};
+    std::string m_error;
+    std::size_t m_errorPos{0};
+};
+
+bool FieldExpression::compile(const std::string& text, FieldExpression& expression, std::string* error)
+{
+    FieldExpression result;
+    result.m_text = text;
+    std::string message;
+    FieldExpressionCompiler compiler(text, result);
+    if (!compiler.run(message)) {
+        if (error) *error = message;
+        return false;
+    }
+    expression = std::move(result);
+    return true;
+}
+
+namespace {
+
+template <typename Fn>
+inline void applyUnary(float* x, std::size_t n, Fn fn)
+{
+    for (std::size_t i = 0; i < n; ++i) x[i] = fn(x[i]);
+}
+
+template <typename Fn>
+inline void applyBinary(float* x, const float* y, std::size_t n, Fn fn)
+{
+    for (std::size_t i = 0; i < n; ++i) x[i] = fn(x[i], y[i]);
+}
+
+} // namespace
+
+void FieldExpression::evaluate(const std::vector<Binding>& bindings, std::size_t begin, std::size_t end,
+                               float* out) const
+{
+    if (m_code.empty() || bindings.size() < m_variables.size()) {
+        std::fill(out + begin, out + end, 0.0f);
+        return;
+    }
+    // 栈的每个槽位是一整块的值
+    std::vector<float> stack(m_stackDepth * kBlockSize);
+    for (std::size_t blockBegin = begin; blockBegin < end; blockBegin += kBlockSize) {
+        const std::size_t n = std::min(kBlockSize, end - blockBegin);
+        std::size_t depth = 0;
+        auto slot = [&](std::size_t d) { return stack.data() + d * kBlockSize; };
+        for (const Instruction& ins : m_code) {
+            float* x = depth > 0 ? slot(depth - 1) : nullptr;
+            switch (ins.op) {
+            case Op::LOAD: {
+                float* dst = slot(depth++);
+                const Binding& b = bindings[ins.operand];
+                const float* src = b.data + blockBegin * b.stride;
+                if (b.stride == 1) {
+                    std::copy_n(src, n, dst);
+                } else {
+                    for (std::size_t i = 0; i < n; ++i) dst[i] = src[i * b.stride];
+                }
+                break;
+            }
+            case Op::CONST: std::fill_n(slot(depth++), n, ins.constant); break;
+            case Op::NEG: applyUnary(x, n, [](float v) { return -v; }); break;
+            case Op::ABS: applyUnary(x, n, [](float v) { return std::fabs(v); }); break;
+            case Op::SQRT: applyUnary(x, n, [](float v) { return std::sqrt(v); }); break;
+            case Op::SQUARE: applyUnary(x, n, [](float v) { return v * v; }); break;
+            case Op::CUBE: applyUnary(x, n, [](float v) { return v * v * v; }); break;
+            case Op::EXP: applyUnary(x, n, [](float v) { return std::exp(v); }); break;
+            case Op::LOG: applyUnary(x, n, [](float v) { return std::log(v); }); break;
+            case Op::SIN: applyUnary(x, n, [](float v) { return std::sin(v); }); break;
+            case Op::COS: applyUnary(x, n, [](float v) { return std::cos(v); }); break;
+            case Op::TAN: applyUnary(x, n, [](float v) { return std::tan(v); }); break;
+            case Op::ADD_CONST: {
+                const float c = ins.constant;
+                applyUnary(x, n, [c](float v) { return v + c; });
+                break;
+            }
+            case Op::MUL_CONST: {
+                const float c = ins.constant;
+                applyUnary(x, n, [c](float v) { return v * c; });
+                break;
+            }
+            default: {
+                // 二元运算：次栈顶 op 栈顶，结果留在次栈顶
+                float* a = slot(depth - 2);
+                switch (ins.op) {
+                case Op::ADD: applyBinary(a, x, n, [](float u, float v) { return u + v; }); break;
+                case Op::SUB: applyBinary(a, x, n, [](float u, float v) { return u - v; }); break;
+                case Op::MUL: applyBinary(a, x, n, [](float u, float v) { return u * v; }); break;
+                case Op::DIV: applyBinary(a, x, n, [](float u, float v) { return u / v; }); break;
+                case Op::POW: applyBinary(a, x, n, [](float u, float v) { return std::pow(u, v); }); break;
+                case Op::MIN: applyBinary(a, x, n, [](float u, float v) { return v < u ? v : u; }); break;
+                case Op::MAX: applyBinary(a, x, n, [](float u, float v) { return u < v ? v : u; }); break;
+                default: break;
+                }
+                --depth;
+                break;
+            }
+            }
+        }
+        std::copy_n(slot(0), n, out + blockBegin);
+    }
+}
+
+namespace {
+
+// 变量到 (场, 分量) 的解析，找不到时返回 false
+bool resolveVariable(const std::string& name, const std::vector<const FieldData*>& fields,
+                     std::size_t& fieldIndex, int& component)
+{
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+        const auto& labels = fields[f]->componentLabels;
+        auto it = std::find(labels.begin(), labels.end(), name);
+        if (it != labels.end()) {
+            fieldIndex = f;
+            component = static_cast<int>(it - labels.begin());
+            return true;
+        }
+    }
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+        if (fields[f]->components == 1 && fields[f]->name == name) {
+            fieldIndex = f;
+            component = 0;
+            return true;
+        }
+    }
+    const std::size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    const std::string fieldName = name.substr(0, dot);
+    const std::string label = name.substr(dot + 1);
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+        if (fields[f]->name != fieldName) continue;
+        const auto& labels = fields[f]->componentLabels;
+        auto it = std::find(labels.begin(), labels.end(), label);
+        if (it != labels.end()) {
+            fieldIndex = f;
+            component = static_cast<int>(it - labels.begin());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool sameLayout(const FieldData& a, const FieldData& b)
+{
+    return a.isNodal == b.isNodal && a.slotCount() == b.slotCount() && a.sparseIndices == b.sparseIndices;
+}
+
+} // namespace
+
+bool evaluateFieldExpression(const FieldExpression& expression, const std::vector<const FieldData*>& fields,
+                             const std::string& resultName, FieldData& result, ThreadPool* pool,
+                             std::string* error)
+{
+    auto fail = [error](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (expression.empty()) {
+        return fail("empty expression");
+    }
+    if (fields.empty() || std::find(fields.begin(), fields.end(), nullptr) != fields.end()) {
+        return fail("no input fields");
+    }
+
+    // 先解析变量，只解码实际用到的场
+    const std::vector<std::string>& variables = expression.variables();
+    std::vector<std::size_t> fieldOf(variables.size());
+    std::vector<int> componentOf(variables.size());
+    for (std::size_t v = 0; v < variables.size(); ++v) {
+        if (!resolveVariable(variables[v], fields, fieldOf[v], componentOf[v])) {
+            return fail("unknown variable '" + variables[v] + "'");
+        }
+    }
+    std::vector<std::size_t> used(fieldOf.begin(), fieldOf.end());
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+    if (used.empty()) {
+        used.push_back(0); // 常数表达式沿用第一个场的布局
+    }
+
+    std::vector<FieldData> scratch(fields.size());
+    std::vector<const FieldData*> views(fields.size(), nullptr);
+    for (std::size_t f : used) {
+        views[f] = &unpackedView(*fields[f], scratch[f]);
+    }
+    const FieldData& layout = *views[used.front()];
+    for (std::size_t f : used) {
+        if (!sameLayout(layout, *views[f])) {
+            return fail("fields '" + layout.name + "' and '" + views[f]->name + "' have different layouts");
+        }
+    }
+
+    tracing::Span span("evaluateFieldExpression", "converter");
+    const std::size_t slots = layout.slotCount();
+    span.arg("entities", slots);
+    span.arg("variables", variables.size());
+
+    std::vector<FieldExpression::Binding> bindings(variables.size());
+    for (std::size_t v = 0; v < variables.size(); ++v) {
+        const FieldData& fd = *views[fieldOf[v]];
+        bindings[v].data = fd.values.data() + componentOf[v];
+        bindings[v].stride = static_cast<std::size_t>(fd.components);
+    }
+
+    FieldData out;
+    out.type = FieldType::GENERIC;
+    out.name = resultName;
+    out.description = expression.text();
+    out.componentLabels = {resultName};
+    out.components = 1;
+    out.isNodal = layout.isNodal;
+    out.sparseIndices = layout.sparseIndices;
+    out.values.resize(slots);
+    const bool dense = !layout.isSparse();
+    if (dense) {
+        out.validFlags.assign(slots, 1);
+    }
+
+    // 无效条目与非有限结果（如负数开方）置 0 且不计入统计，稠密布局同时标记为无效
+    FieldStatsAccumulator stats(1, slots);
+    auto run = [&](std::size_t chunk) {
+        const std::size_t begin = chunk * kChunkSize;
+        const std::size_t end = std::min(slots, begin + kChunkSize);
+        expression.evaluate(bindings, begin, end, out.values.data());
+        FieldStatsAccumulator::Partial partial = stats.makePartial();
+        for (std::size_t s = begin; s < end; ++s) {
+            bool valid = std::isfinite(out.values[s]);
+            if (dense) {
+                for (std::size_t f : used) {
+                    valid = valid && views[f]->validFlags[s] != 0;
+                }
+                out.validFlags[s] = valid ? 1 : 0;
+            }
+            if (valid) {
+                stats.add(partial, s, &out.values[s]);
+            } else {
+                out.values[s] = 0.0f;
+            }
+        }
+        stats.merge(partial);
+    };
+    const std::size_t chunks = (slots + kChunkSize - 1) / kChunkSize;
+    if (pool) {
+        pool->parallelFor(chunks, run);
+    } else {
+        for (std::size_t c = 0; c < chunks; ++c) run(c);
+    }
+    out.stats = stats.finish();
+    result = std::move(out);
+    return true;
+}
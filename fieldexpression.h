@@ -0,0 +1,70 @@
+#ifndef FIELDEXPRESSION_H
+#define FIELDEXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fielddata.h"
+
+class ThreadPool;
+
+// 场分量表达式，如 "S11 - S22"、"sqrt(U1^2 + U2^2)"
+// 解析一次得到栈式字节码；求值时每条指令作用于一整块（kBlockSize 个实体）的值，
+// 内层循环为连续数组上的逐元素运算，可被编译器向量化；按实体区间求值，便于调用方切块并行
+//
+// 语法：数字、变量、括号、+ - * / ^（右结合，优先级高于一元负号）以及函数
+//       sqrt abs exp log sin cos tan min max pow
+// 变量名可含字母、数字、下划线与 '.'，如 S11、U2、S.Mises，由调用方绑定到数据
+class FieldExpression {
+public:
+    static constexpr std::size_t kBlockSize = 256;
+
+    // 变量的输入：第 i 个实体的值为 data[i * stride]
+    struct Binding {
+        const float* data{nullptr};
+        std::size_t stride{1};
+    };
+
+    static bool compile(const std::string& text, FieldExpression& expression, std::string* error = nullptr);
+
+    const std::string& text() const { return m_text; }
+    // 表达式中出现的变量，按首次出现的顺序
+    const std::vector<std::string>& variables() const { return m_variables; }
+    bool empty() const { return m_code.empty(); }
+
+    // bindings[v] 对应 variables()[v]，结果写入 out[i]，i ∈ [begin, end)
+    void evaluate(const std::vector<Binding>& bindings, std::size_t begin, std::size_t end, float* out) const;
+
+private:
+    enum class Op : std::uint8_t {
+        LOAD,  // 压入变量 operand
+        CONST, // 压入常数 constant
+        NEG, ABS, SQRT, SQUARE, CUBE, EXP, LOG, SIN, COS, TAN,
+        ADD, SUB, MUL, DIV, POW, MIN, MAX,
+        ADD_CONST, MUL_CONST // 栈顶与常数运算，由编译时折叠得到
+    };
+    struct Instruction {
+        Op op;
+        std::uint32_t operand{0};
+        float constant{0.0f};
+    };
+
+    friend class FieldExpressionCompiler;
+
+    std::string m_text;
+    std::vector<std::string> m_variables;
+    std::vector<Instruction> m_code;
+    std::size_t m_stackDepth{0};
+};
+
+// 在一组场上求表达式，结果为单分量场（type 为 GENERIC，isNodal 与输入一致），统计量同步计算
+// 变量解析：单独的分量标签（如 S11）取第一个含该分量的场，"场名.标签" 指定场，单分量场也可直接用场名
+// 各场须同为节点或单元数据且槽位布局相同；任一输入无效的条目结果无效且值为 0
+// 紧凑存储的输入先解码；pool 为空时在调用线程计算
+bool evaluateFieldExpression(const FieldExpression& expression, const std::vector<const FieldData*>& fields,
+                             const std::string& resultName, FieldData& result, ThreadPool* pool = nullptr,
+                             std::string* error = nullptr);
+
+#endif // FIELDEXPRESSION_H
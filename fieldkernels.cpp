@@ -0,0 +1,482 @@
+#include "fieldkernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FIELDKERNELS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+void reduceScalar(const float* rows, std::size_t count, int components, IPReduction mode, float* out)
+{
+    for (int c = 0; c < components; ++c) {
+        float acc = rows[c];
+        for (std::size_t k = 1; k < count; ++k) {
+            const float v = rows[k * components + c];
+            acc = (mode == IPReduction::MAXIMUM) ? std::max(acc, v) : acc + v;
+        }
+        out[c] = (mode == IPReduction::MAXIMUM) ? acc : acc / static_cast<float>(count);
+    }
+}
+
+#ifdef FIELDKERNELS_SSE
+// 最多 8 个分量：每行用两个 4 路寄存器累加，行尾多读的部分依赖 kPadding 保证不越界
+void reduceSse(const float* rows, std::size_t count, int components, IPReduction mode, float* out)
+{
+    __m128 a0 = _mm_loadu_ps(rows);
+    __m128 a1 = _mm_loadu_ps(rows + 4);
+    const float* row = rows + components;
+    if (mode == IPReduction::MAXIMUM) {
+        for (std::size_t k = 1; k < count; ++k, row += components) {
+            a0 = _mm_max_ps(a0, _mm_loadu_ps(row));
+            a1 = _mm_max_ps(a1, _mm_loadu_ps(row + 4));
+        }
+    } else {
+        for (std::size_t k = 1; k < count; ++k, row += components) {
+            a0 = _mm_add_ps(a0, _mm_loadu_ps(row));
+            a1 = _mm_add_ps(a1, _mm_loadu_ps(row + 4));
+        }
+        const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(count));
+        a0 = _mm_mul_ps(a0, scale);
+        a1 = _mm_mul_ps(a1, scale);
+    }
+    alignas(16) float tmp[8];
+    _mm_store_ps(tmp, a0);
+    _mm_store_ps(tmp + 4, a1);
+    std::copy(tmp, tmp + components, out);
+}
+
+// 最多 4 个分量、4 个积分点数相同且连续存放的单元：每个积分点读入 4 个单元的一行后转置，
+// 4 路寄存器的各路对应不同单元、每个寄存器对应一个分量，累加完成后再转置回按单元排列
+// rows 为第一个单元的起点，相邻单元相隔 count * components 个值
+void reduceSse4Elements(const float* rows, std::size_t count, int components, IPReduction mode, float* out)
+{
+    const std::size_t stride = count * static_cast<std::size_t>(components);
+    const float* r = rows;
+    __m128 c0 = _mm_loadu_ps(r);
+    __m128 c1 = _mm_loadu_ps(r + stride);
+    __m128 c2 = _mm_loadu_ps(r + 2 * stride);
+    __m128 c3 = _mm_loadu_ps(r + 3 * stride);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    for (std::size_t k = 1; k < count; ++k) {
+        r += components;
+        __m128 v0 = _mm_loadu_ps(r);
+        __m128 v1 = _mm_loadu_ps(r + stride);
+        __m128 v2 = _mm_loadu_ps(r + 2 * stride);
+        __m128 v3 = _mm_loadu_ps(r + 3 * stride);
+        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+        if (mode == IPReduction::MAXIMUM) {
+            c0 = _mm_max_ps(c0, v0);
+            c1 = _mm_max_ps(c1, v1);
+            c2 = _mm_max_ps(c2, v2);
+            c3 = _mm_max_ps(c3, v3);
+        } else {
+            c0 = _mm_add_ps(c0, v0);
+            c1 = _mm_add_ps(c1, v1);
+            c2 = _mm_add_ps(c2, v2);
+            c3 = _mm_add_ps(c3, v3);
+        }
+    }
+    if (mode != IPReduction::MAXIMUM) {
+        const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(count));
+        c0 = _mm_mul_ps(c0, scale);
+        c1 = _mm_mul_ps(c1, scale);
+        c2 = _mm_mul_ps(c2, scale);
+        c3 = _mm_mul_ps(c3, scale);
+    }
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    alignas(16) float tmp[16];
+    _mm_store_ps(tmp, c0);
+    _mm_store_ps(tmp + 4, c1);
+    _mm_store_ps(tmp + 8, c2);
+    _mm_store_ps(tmp + 12, c3);
+    for (int e = 0; e < 4; ++e) {
+        std::copy(tmp + 4 * e, tmp + 4 * e + components, out + e * components);
+    }
+}
+#endif
+
+} // namespace
+
+void reduceIntegrationPoints(const IntegrationPointData& points, int components,
+                             IPReduction mode, int selectedPoint,
+                             std::size_t beginElement, std::size_t endElement, float* out)
+{
+    if (components <= 0) return;
+    const std::size_t stride = static_cast<std::size_t>(components);
+
+    const bool combine = mode == IPReduction::CENTROID || mode == IPReduction::MAXIMUM;
+    for (std::size_t e = beginElement; e < endElement; ++e) {
+        const std::size_t count = points.pointCount(e);
+        if (count == 0) continue;
+        const float* rows = points.values.data() + points.offsets[e] * stride;
+        float* dst = out + e * stride;
+
+#ifdef FIELDKERNELS_SSE
+        // 分量少时单个单元填不满寄存器，改为 4 个单元一组跨单元计算；5 个以上分量的一行已占满
+        // 两个寄存器的大部分，转置的代价高于空闲的几路，仍按单元计算
+        if (combine && components <= 4 && count > 1 && e + 4 <= endElement &&
+            points.offsets[e + 4] - points.offsets[e] == 4 * count &&
+            points.pointCount(e + 1) == count && points.pointCount(e + 2) == count) {
+            reduceSse4Elements(rows, count, components, mode, dst);
+            e += 3;
+            continue;
+        }
+#endif
+        if (!combine || count == 1) {
+            std::size_t k = 0;
+            if (mode == IPReduction::SELECTED_POINT) {
+                k = std::min(static_cast<std::size_t>(std::max(selectedPoint, 0)), count - 1);
+            }
+            std::copy(rows + k * stride, rows + (k + 1) * stride, dst);
+            continue;
+        }
+#ifdef FIELDKERNELS_SSE
+        if (components <= 8) {
+            reduceSse(rows, count, components, mode, dst);
+            continue;
+        }
+#endif
+        reduceScalar(rows, count, components, mode, dst);
+    }
+}
+
+float reducePointValues(const float* rows, std::size_t count, std::size_t stride,
+                        IPReduction mode, int selectedPoint)
+{
+    if (count == 0) return 0.0f;
+    switch (mode) {
+    case IPReduction::SELECTED_POINT:
+        return rows[std::min(static_cast<std::size_t>(std::max(selectedPoint, 0)), count - 1) * stride];
+    case IPReduction::CENTROID: {
+        double sum = 0.0;
+        for (std::size_t k = 0; k < count; ++k) sum += rows[k * stride];
+        return static_cast<float>(sum / static_cast<double>(count));
+    }
+    case IPReduction::MAXIMUM: {
+        float peak = rows[0];
+        for (std::size_t k = 1; k < count; ++k) peak = std::max(peak, rows[k * stride]);
+        return peak;
+    }
+    default:
+        return rows[0];
+    }
+}
+
+namespace {
+
+// 各布局在完整张量 (11, 22, 33, 12, 13, 23) 中的分量位置，-1 表示该分量为 0
+struct TensorLayout {
+    int index[6];
+};
+
+bool tensorLayout(int components, TensorLayout& layout)
+{
+    switch (components) {
+    case 6: layout = {{0, 1, 2, 3, 4, 5}}; return true;
+    case 4: layout = {{0, 1, 2, 3, -1, -1}}; return true;
+    case 3: layout = {{0, 1, -1, 2, -1, -1}}; return true;
+    default: return false;
+    }
+}
+
+constexpr float kSqrt3Half = 0.86602540378f;
+
+// 对称张量 a = (11, 22, 33, 12, 13, 23) 属于特征值 lambda 的单位特征向量：
+// 取 (A - λI) 两两行叉积中模最大者；重根时叉积退化，返回 false
+bool eigenvector(const double a[6], double lambda, double scale, double v[3])
+{
+    const double rows[3][3] = {{a[0] - lambda, a[3], a[4]},
+                               {a[3], a[1] - lambda, a[5]},
+                               {a[4], a[5], a[2] - lambda}};
+    const int pairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    double best = 0.0;
+    for (const auto& pair : pairs) {
+        const double* r = rows[pair[0]];
+        const double* q = rows[pair[1]];
+        const double c[3] = {r[1] * q[2] - r[2] * q[1], r[2] * q[0] - r[0] * q[2], r[0] * q[1] - r[1] * q[0]};
+        const double n2 = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+        if (n2 > best) {
+            best = n2;
+            std::copy(c, c + 3, v);
+        }
+    }
+    // 叉积模长约为 λ 与另两个特征值之差的乘积，相对 scale² 过小视为重根
+    if (best <= 1e-12 * scale * scale * scale * scale) return false;
+    const double inv = 1.0 / std::sqrt(best);
+    for (int k = 0; k < 3; ++k) v[k] *= inv;
+    return true;
+}
+
+// 与单位向量 v 正交的任一单位向量
+void orthogonal(const double v[3], double out[3])
+{
+    // 与 v 分量最小的坐标轴叉乘，避免近平行
+    const int axis = (std::fabs(v[0]) <= std::fabs(v[1]) && std::fabs(v[0]) <= std::fabs(v[2])) ? 0
+                   : (std::fabs(v[1]) <= std::fabs(v[2]) ? 1 : 2);
+    double e[3] = {0.0, 0.0, 0.0};
+    e[axis] = 1.0;
+    const double c[3] = {v[1] * e[2] - v[2] * e[1], v[2] * e[0] - v[0] * e[2], v[0] * e[1] - v[1] * e[0]};
+    const double inv = 1.0 / std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+    for (int k = 0; k < 3; ++k) out[k] = c[k] * inv;
+}
+
+void principalDirections(const float t[6], float maxPrincipal, float minPrincipal, std::size_t i,
+                         const TensorInvariantOutputs& out)
+{
+    const double a[6] = {t[0], t[1], t[2], t[3], t[4], t[5]};
+    const double scale = std::max(std::fabs(static_cast<double>(maxPrincipal)), std::fabs(static_cast<double>(minPrincipal)));
+    double v1[3] = {0.0, 0.0, 0.0};
+    double v2[3] = {0.0, 0.0, 0.0};
+    double v3[3] = {0.0, 0.0, 0.0};
+    if (scale > 0.0) {
+        const bool ok1 = eigenvector(a, maxPrincipal, scale, v1);
+        const bool ok3 = eigenvector(a, minPrincipal, scale, v3);
+        if (!ok1 && !ok3) { // 各向同性：任意正交基
+            v1[0] = 1.0;
+            v3[2] = 1.0;
+        } else if (!ok1) {
+            orthogonal(v3, v1);
+        } else if (!ok3) {
+            orthogonal(v1, v3);
+        } else { // 数值上与 v1 重新正交化
+            const double d = v1[0] * v3[0] + v1[1] * v3[1] + v1[2] * v3[2];
+            for (int k = 0; k < 3; ++k) v3[k] -= d * v1[k];
+            const double n = std::sqrt(v3[0] * v3[0] + v3[1] * v3[1] + v3[2] * v3[2]);
+            if (n > 0.0) {
+                for (int k = 0; k < 3; ++k) v3[k] /= n;
+            } else {
+                orthogonal(v1, v3);
+            }
+        }
+        // v2 = v3 × v1，使 (v1, v2, v3) 构成右手系
+        v2[0] = v3[1] * v1[2] - v3[2] * v1[1];
+        v2[1] = v3[2] * v1[0] - v3[0] * v1[2];
+        v2[2] = v3[0] * v1[1] - v3[1] * v1[0];
+    }
+    float* targets[3] = {out.maxDirection, out.midDirection, out.minDirection};
+    const double* vectors[3] = {v1, v2, v3};
+    for (int d = 0; d < 3; ++d) {
+        if (!targets[d]) continue;
+        for (int k = 0; k < 3; ++k) targets[d][i * 3 + k] = static_cast<float>(vectors[d][k]);
+    }
+}
+
+bool wantsPrincipals(const TensorInvariantOutputs& out)
+{
+    return out.maxPrincipal || out.midPrincipal || out.minPrincipal || out.tresca
+        || out.maxDirection || out.midDirection || out.minDirection;
+}
+
+bool wantsDirections(const TensorInvariantOutputs& out)
+{
+    return out.maxDirection || out.midDirection || out.minDirection;
+}
+
+void invariantsScalar(const float* values, const TensorLayout& layout, std::size_t i,
+                      const TensorInvariantOutputs& out)
+{
+    float t[6];
+    for (int k = 0; k < 6; ++k) t[k] = layout.index[k] < 0 ? 0.0f : values[layout.index[k]];
+    const float mean = (t[0] + t[1] + t[2]) * (1.0f / 3.0f);
+    const float dx = t[0] - mean;
+    const float dy = t[1] - mean;
+    const float dz = t[2] - mean;
+    const float shear2 = t[3] * t[3] + t[4] * t[4] + t[5] * t[5];
+    const float j2 = 0.5f * (dx * dx + dy * dy + dz * dz) + shear2;
+    const float mises = std::sqrt(3.0f * j2);
+
+    if (out.mises) out.mises[i] = mises;
+    if (out.pressure) out.pressure[i] = -mean;
+    if (out.triaxiality) out.triaxiality[i] = mises > 0.0f ? mean / mises : 0.0f;
+    if (!wantsPrincipals(out)) return;
+
+    const float j3 = dx * dy * dz + 2.0f * t[3] * t[4] * t[5] - dx * t[5] * t[5] - dy * t[4] * t[4] - dz * t[3] * t[3];
+    float r = 0.0f;
+    if (j2 > 0.0f) {
+        const float k = 3.0f / j2;
+        r = std::min(1.0f, std::max(-1.0f, 0.5f * j3 * k * std::sqrt(k)));
+    }
+    const float theta = std::acos(r) * (1.0f / 3.0f);
+    const float m = 2.0f * std::sqrt(j2 * (1.0f / 3.0f));
+    const float c = m * std::cos(theta);
+    const float s = m * kSqrt3Half * std::sin(theta);
+    const float p1 = mean + c;
+    const float p2 = mean - 0.5f * c + s;
+    const float p3 = mean - 0.5f * c - s;
+    if (out.maxPrincipal) out.maxPrincipal[i] = p1;
+    if (out.midPrincipal) out.midPrincipal[i] = p2;
+    if (out.minPrincipal) out.minPrincipal[i] = p3;
+    if (out.tresca) out.tresca[i] = p1 - p3;
+    if (wantsDirections(out)) principalDirections(t, p1, p3, i, out);
+}
+
+#ifdef FIELDKERNELS_SSE
+inline __m128 madd(__m128 a, __m128 b, __m128 c)
+{
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// acos：Abramowitz & Stegun 4.4.46，x ∈ [0, 1] 上误差小于 2e-8，负数用 acos(x) = π - acos(-x)
+__m128 acosSse(__m128 x)
+{
+    const __m128 ax = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = madd(p, ax, _mm_set1_ps(0.0066700901f));
+    p = madd(p, ax, _mm_set1_ps(-0.0170881256f));
+    p = madd(p, ax, _mm_set1_ps(0.0308918810f));
+    p = madd(p, ax, _mm_set1_ps(-0.0501743046f));
+    p = madd(p, ax, _mm_set1_ps(0.0889789874f));
+    p = madd(p, ax, _mm_set1_ps(-0.2145988016f));
+    p = madd(p, ax, _mm_set1_ps(1.5707963050f));
+    const __m128 r = _mm_mul_ps(p, _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), ax)));
+    return select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(3.14159265359f), r), r);
+}
+
+// θ ∈ [0, π/3] 上的 Taylor 展开，截断误差小于 1e-8
+void sinCosSse(__m128 x, __m128& s, __m128& c)
+{
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 pc = _mm_set1_ps(-1.0f / 3628800.0f);
+    pc = madd(pc, x2, _mm_set1_ps(1.0f / 40320.0f));
+    pc = madd(pc, x2, _mm_set1_ps(-1.0f / 720.0f));
+    pc = madd(pc, x2, _mm_set1_ps(1.0f / 24.0f));
+    pc = madd(pc, x2, _mm_set1_ps(-0.5f));
+    c = madd(pc, x2, _mm_set1_ps(1.0f));
+    __m128 ps = _mm_set1_ps(-1.0f / 39916800.0f);
+    ps = madd(ps, x2, _mm_set1_ps(1.0f / 362880.0f));
+    ps = madd(ps, x2, _mm_set1_ps(-1.0f / 5040.0f));
+    ps = madd(ps, x2, _mm_set1_ps(1.0f / 120.0f));
+    ps = madd(ps, x2, _mm_set1_ps(-1.0f / 6.0f));
+    s = _mm_mul_ps(x, madd(ps, x2, _mm_set1_ps(1.0f)));
+}
+
+// 4 个条目一组：分量转置到 SoA 寄存器后逐项计算，结果连续写回
+void invariantsSse(const float* values, std::size_t stride, const TensorLayout& layout, std::size_t i,
+                   const TensorInvariantOutputs& out)
+{
+    const float* row = values + i * stride;
+    __m128 t[6];
+    for (int k = 0; k < 6; ++k) {
+        const int idx = layout.index[k];
+        t[k] = idx < 0 ? _mm_setzero_ps()
+                       : _mm_setr_ps(row[idx], row[stride + idx], row[2 * stride + idx], row[3 * stride + idx]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 mean = _mm_mul_ps(_mm_add_ps(_mm_add_ps(t[0], t[1]), t[2]), _mm_set1_ps(1.0f / 3.0f));
+    const __m128 dx = _mm_sub_ps(t[0], mean);
+    const __m128 dy = _mm_sub_ps(t[1], mean);
+    const __m128 dz = _mm_sub_ps(t[2], mean);
+    const __m128 s12 = _mm_mul_ps(t[3], t[3]);
+    const __m128 s13 = _mm_mul_ps(t[4], t[4]);
+    const __m128 s23 = _mm_mul_ps(t[5], t[5]);
+    const __m128 normal2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    const __m128 j2 = madd(normal2, _mm_set1_ps(0.5f), _mm_add_ps(_mm_add_ps(s12, s13), s23));
+    const __m128 mises = _mm_sqrt_ps(_mm_mul_ps(j2, _mm_set1_ps(3.0f)));
+    const __m128 positive = _mm_cmpgt_ps(mises, zero);
+
+    if (out.mises) _mm_storeu_ps(out.mises + i, mises);
+    if (out.pressure) _mm_storeu_ps(out.pressure + i, _mm_sub_ps(zero, mean));
+    if (out.triaxiality) {
+        // mises 为 0 的通道先把除数换成 1，再把结果清零
+        const __m128 safe = select(positive, mises, _mm_set1_ps(1.0f));
+        _mm_storeu_ps(out.triaxiality + i, _mm_and_ps(positive, _mm_div_ps(mean, safe)));
+    }
+    if (!wantsPrincipals(out)) return;
+
+    __m128 j3 = _mm_mul_ps(_mm_mul_ps(dx, dy), dz);
+    j3 = madd(_mm_mul_ps(_mm_mul_ps(t[3], t[4]), t[5]), _mm_set1_ps(2.0f), j3);
+    j3 = _mm_sub_ps(j3, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, s23), _mm_mul_ps(dy, s13)), _mm_mul_ps(dz, s12)));
+
+    const __m128 j2Positive = _mm_cmpgt_ps(j2, zero);
+    const __m128 k = _mm_div_ps(_mm_set1_ps(3.0f), select(j2Positive, j2, _mm_set1_ps(1.0f)));
+    __m128 r = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), j3), _mm_mul_ps(k, _mm_sqrt_ps(k)));
+    r = _mm_and_ps(j2Positive, _mm_min_ps(_mm_set1_ps(1.0f), _mm_max_ps(_mm_set1_ps(-1.0f), r)));
+    const __m128 theta = _mm_mul_ps(acosSse(r), _mm_set1_ps(1.0f / 3.0f));
+    __m128 sinTheta, cosTheta;
+    sinCosSse(theta, sinTheta, cosTheta);
+    const __m128 m = _mm_mul_ps(_mm_set1_ps(2.0f), _mm_sqrt_ps(_mm_mul_ps(j2, _mm_set1_ps(1.0f / 3.0f))));
+    const __m128 c = _mm_mul_ps(m, cosTheta);
+    const __m128 s = _mm_mul_ps(_mm_mul_ps(m, _mm_set1_ps(kSqrt3Half)), sinTheta);
+    const __m128 halfC = _mm_mul_ps(c, _mm_set1_ps(0.5f));
+    const __m128 p1 = _mm_add_ps(mean, c);
+    const __m128 p2 = _mm_add_ps(_mm_sub_ps(mean, halfC), s);
+    const __m128 p3 = _mm_sub_ps(_mm_sub_ps(mean, halfC), s);
+    if (out.maxPrincipal) _mm_storeu_ps(out.maxPrincipal + i, p1);
+    if (out.midPrincipal) _mm_storeu_ps(out.midPrincipal + i, p2);
+    if (out.minPrincipal) _mm_storeu_ps(out.minPrincipal + i, p3);
+    if (out.tresca) _mm_storeu_ps(out.tresca + i, _mm_sub_ps(p1, p3));
+    if (!wantsDirections(out)) return;
+
+    alignas(16) float lanes[8][4];
+    for (int q = 0; q < 6; ++q) _mm_store_ps(lanes[q], t[q]);
+    _mm_store_ps(lanes[6], p1);
+    _mm_store_ps(lanes[7], p3);
+    for (int lane = 0; lane < 4; ++lane) {
+        const float tensor[6] = {lanes[0][lane], lanes[1][lane], lanes[2][lane],
+                                 lanes[3][lane], lanes[4][lane], lanes[5][lane]};
+        principalDirections(tensor, lanes[6][lane], lanes[7][lane], i + lane, out);
+    }
+}
+#endif
+
+} // namespace
+
+bool isTensorLayout(int components)
+{
+    TensorLayout layout;
+    return tensorLayout(components, layout);
+}
+
+void computeTensorInvariants(const float* values, int components, std::size_t begin, std::size_t end,
+                             const TensorInvariantOutputs& out)
+{
+    TensorLayout layout;
+    if (!tensorLayout(components, layout)) return;
+    const std::size_t stride = static_cast<std::size_t>(components);
+    std::size_t i = begin;
+#ifdef FIELDKERNELS_SSE
+    for (; i + 4 <= end; i += 4) {
+        invariantsSse(values, stride, layout, i, out);
+    }
+#endif
+    for (; i < end; ++i) {
+        invariantsScalar(values + i * stride, layout, i, out);
+    }
+}
+
+void deformCoordinates(const float* reference, const float* displacement, int components, float scale,
+                       std::size_t begin, std::size_t end, float* out)
+{
+    if (components == 3) {
+        // 三分量时坐标与位移布局相同，按连续 float 整段处理
+        std::size_t j = begin * 3;
+        const std::size_t last = end * 3;
+#ifdef FIELDKERNELS_SSE
+        const __m128 s = _mm_set1_ps(scale);
+        for (; j + 4 <= last; j += 4) {
+            _mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(reference + j), _mm_mul_ps(s, _mm_loadu_ps(displacement + j))));
+        }
+#endif
+        for (; j < last; ++j) {
+            out[j] = reference[j] + scale * displacement[j];
+        }
+        return;
+    }
+    const std::size_t stride = static_cast<std::size_t>(components);
+    const int used = std::min(components, 3);
+    for (std::size_t i = begin; i < end; ++i) {
+        const float* u = displacement + i * stride;
+        for (int k = 0; k < 3; ++k) {
+            out[i * 3 + k] = reference[i * 3 + k] + (k < used ? scale * u[k] : 0.0f);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef FIELDKERNELS_H
+#define FIELDKERNELS_H
+
+#include <cstddef>
+
+#include "fielddata.h"
+
+// 场数据数值内核：按单元区间处理，便于调用方切块并行
+// 有 SSE 时按 4/8 路向量计算，否则退化为标量循环
+
+// 将单元 [beginElement, endElement) 的积分点数据按 mode 汇总到 out[e * components + comp]
+// 没有积分点的单元保持 out 原值不变
+void reduceIntegrationPoints(const IntegrationPointData& points, int components,
+                             IPReduction mode, int selectedPoint,
+                             std::size_t beginElement, std::size_t endElement, float* out);
+
+// 单个实体单一分量的积分点汇总：第 k 个积分点的值为 rows[k * stride]
+float reducePointValues(const float* rows, std::size_t count, std::size_t stride,
+                        IPReduction mode, int selectedPoint);
+
+// 应力张量导出量的输出位置：指针为空的量不计算，第 i 个条目写入 xxx[i]（方向为 xxxDirection[i * 3 + k]）
+struct TensorInvariantOutputs {
+    float* mises{nullptr};
+    float* maxPrincipal{nullptr};
+    float* midPrincipal{nullptr};
+    float* minPrincipal{nullptr};
+    float* tresca{nullptr};       // 最大主应力 - 最小主应力
+    float* pressure{nullptr};     // -(S11 + S22 + S33) / 3，受压为正
+    float* triaxiality{nullptr};  // -pressure / mises，mises 为 0 时取 0
+    // 主方向为单位向量，符号不定；重根时在对应特征子空间内任取正交基，零张量为零向量
+    float* maxDirection{nullptr};
+    float* midDirection{nullptr};
+    float* minDirection{nullptr};
+};
+
+// 支持的分量布局：6（S11 S22 S33 S12 S13 S23）、4（S11 S22 S33 S12，平面应变 / 轴对称）、
+// 3（S11 S22 S12，平面应力壳，S33 = 0）
+bool isTensorLayout(int components);
+
+// 对 values[i * components + c] 中 [begin, end) 条目一遍算出所需的全部导出量
+// 主应力由偏应力不变量 J2、J3 按三角函数形式解出；有 SSE 时 4 个条目一组按 SoA 计算，方向逐条目计算
+// 布局不受支持时不写任何输出
+void computeTensorInvariants(const float* values, int components, std::size_t begin, std::size_t end,
+                             const TensorInvariantOutputs& out);
+
+// 节点 [begin, end) 的变形坐标：out[i * 3 + k] = reference[i * 3 + k] + scale * displacement[i * components + k]
+// components 为 2 时 z 取参考坐标，多于 3 个分量时只用前 3 个
+void deformCoordinates(const float* reference, const float* displacement, int components, float scale,
+                       std::size_t begin, std::size_t end, float* out);
+
+#endif // FIELDKERNELS_H
@@ -0,0 +1,98 @@
+#include "fieldstats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+FieldStatsAccumulator::FieldStatsAccumulator(int components, std::size_t entityCount)
+    : m_components(std::max(components, 0))
+    , m_channels(m_components > 1 ? m_components + 1 : m_components)
+{
+    m_sampleStride = std::max<std::size_t>(1, (entityCount + kMaxSamples - 1) / kMaxSamples);
+    m_sampleSlots = (entityCount + m_sampleStride - 1) / m_sampleStride;
+    m_samples.assign(m_sampleSlots * static_cast<std::size_t>(m_channels), std::numeric_limits<float>::quiet_NaN());
+    m_total = makePartial();
+}
+
+FieldStatsAccumulator::Partial FieldStatsAccumulator::makePartial() const
+{
+    Partial partial;
+    partial.count.assign(m_channels, 0);
+    partial.min.assign(m_channels, std::numeric_limits<float>::max());
+    partial.max.assign(m_channels, std::numeric_limits<float>::lowest());
+    partial.sum.assign(m_channels, 0.0);
+    return partial;
+}
+
+void FieldStatsAccumulator::add(Partial& partial, std::size_t entity, const float* values)
+{
+    const bool sampled = entity % m_sampleStride == 0;
+    const std::size_t slot = entity / m_sampleStride;
+    double squares = 0.0;
+    for (int c = 0; c < m_channels; ++c) {
+        float v;
+        if (c < m_components) {
+            v = values[c];
+            squares += static_cast<double>(v) * v;
+        } else {
+            v = static_cast<float>(std::sqrt(squares));
+        }
+        ++partial.count[c];
+        partial.min[c] = std::min(partial.min[c], v);
+        partial.max[c] = std::max(partial.max[c], v);
+        partial.sum[c] += v;
+        if (sampled) {
+            m_samples[static_cast<std::size_t>(c) * m_sampleSlots + slot] = v;
+        }
+    }
+}
+
+void FieldStatsAccumulator::merge(const Partial& partial)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int c = 0; c < m_channels; ++c) {
+        m_total.count[c] += partial.count[c];
+        m_total.min[c] = std::min(m_total.min[c], partial.min[c]);
+        m_total.max[c] = std::max(m_total.max[c], partial.max[c]);
+        m_total.sum[c] += partial.sum[c];
+    }
+}
+
+FieldStats FieldStatsAccumulator::finish()
+{
+    FieldStats stats;
+    stats.channels.resize(m_channels);
+    std::vector<float> sorted;
+    sorted.reserve(m_sampleSlots);
+    for (int c = 0; c < m_channels; ++c) {
+        ChannelStats& ch = stats.channels[c];
+        ch.count = m_total.count[c];
+        if (ch.count == 0) continue;
+        ch.min = m_total.min[c];
+        ch.max = m_total.max[c];
+        ch.mean = m_total.sum[c] / static_cast<double>(ch.count);
+
+        sorted.clear();
+        const float* samples = m_samples.data() + static_cast<std::size_t>(c) * m_sampleSlots;
+        for (std::size_t i = 0; i < m_sampleSlots; ++i) {
+            if (!std::isnan(samples[i])) sorted.push_back(samples[i]);
+        }
+        // 抽样未命中有效实体时退化为 [min, max] 线性分布
+        ch.quantiles.resize(ChannelStats::kQuantileCount);
+        if (sorted.empty()) {
+            for (int q = 0; q < ChannelStats::kQuantileCount; ++q) {
+                ch.quantiles[q] = ch.min + (ch.max - ch.min) * q / (ChannelStats::kQuantileCount - 1);
+            }
+            continue;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for (int q = 0; q < ChannelStats::kQuantileCount; ++q) {
+            const std::size_t rank = (sorted.size() - 1) * q / (ChannelStats::kQuantileCount - 1);
+            ch.quantiles[q] = sorted[rank];
+        }
+        // 端点使用精确的最值
+        ch.quantiles.front() = ch.min;
+        ch.quantiles.back() = ch.max;
+    }
+    return stats;
+}
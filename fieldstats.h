@@ -0,0 +1,43 @@
+#ifndef FIELDSTATS_H
+#define FIELDSTATS_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "fielddata.h"
+
+// 在写入场数据的同时累积统计量：各线程先累积到自己的 Partial，结束时合并
+// 分位数由按实体编号等间隔抽样估计，每个样本槽只对应一个实体，并行写入互不冲突
+class FieldStatsAccumulator {
+public:
+    static constexpr std::size_t kMaxSamples = 1 << 16;
+
+    struct Partial {
+        std::vector<std::size_t> count;
+        std::vector<float> min;
+        std::vector<float> max;
+        std::vector<double> sum;
+    };
+
+    FieldStatsAccumulator(int components, std::size_t entityCount);
+
+    int channelCount() const { return m_channels; }
+    Partial makePartial() const;
+    // values 为该实体的 components 个分量
+    void add(Partial& partial, std::size_t entity, const float* values);
+    void merge(const Partial& partial);
+    FieldStats finish();
+
+private:
+    int m_components{0};
+    int m_channels{0};
+    std::size_t m_sampleStride{1};
+    std::size_t m_sampleSlots{0};
+    std::vector<float> m_samples; // [channel * m_sampleSlots + slot]，未写入为 NaN
+
+    std::mutex m_mutex;
+    Partial m_total;
+};
+
+#endif // FIELDSTATS_H
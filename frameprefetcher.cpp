@@ -0,0 +1,103 @@
+#include "frameprefetcher.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <exception>
+
+FramePrefetcher::~FramePrefetcher()
+{
+    stop();
+}
+
+void FramePrefetcher::schedule(std::vector<FieldCacheKey> keys)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return;
+        m_queue.assign(keys.begin(), keys.end());
+        m_cancel.store(true); // 正在执行的旧请求让位给新的选择
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&FramePrefetcher::workerLoop, this);
+        }
+    }
+    m_cv.notify_one();
+}
+
+void FramePrefetcher::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+    m_cancel.store(true);
+}
+
+void FramePrefetcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_queue.clear();
+        m_cancel.store(true);
+    }
+    m_cv.notify_one();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void FramePrefetcher::claim(const std::vector<FieldCacheKey>& keys)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_foreground;
+    auto claimed = [&keys](const FieldCacheKey& key) {
+        return std::find(keys.begin(), keys.end(), key) != keys.end();
+    };
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), claimed), m_queue.end());
+    if (!m_busy) {
+        return;
+    }
+    if (!claimed(m_active)) {
+        m_cancel.store(true);
+        return;
+    }
+    m_doneCv.wait(lock, [this] { return !m_busy; });
+}
+
+void FramePrefetcher::release()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_foreground > 0) --m_foreground;
+    }
+    m_cv.notify_one();
+}
+
+void FramePrefetcher::workerLoop()
+{
+    for (;;) {
+        FieldCacheKey key;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // 前台读取期间不开始新的请求，否则会与前台争抢 ODB 锁
+            m_cv.wait(lock, [this] { return m_stop || (!m_queue.empty() && m_foreground == 0); });
+            if (m_stop) return;
+            key = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_cancel.store(false);
+            m_active = key;
+            m_busy = true;
+        }
+        try {
+            if (m_loader) m_loader(key);
+        } catch (const std::exception& e) {
+            ODB_LOG_WARNING("Prefetch failed: " << e.what());
+        } catch (...) {
+            // Abaqus API 可能抛出非 std::exception 的异常，不能让它终止进程
+            ODB_LOG_WARNING("Prefetch failed: unknown exception");
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+        m_doneCv.notify_all();
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fieldcache.h"
+
+// 后台帧预取：在单独线程中按顺序执行加载请求，加载结果由 loader 写入场缓存
+// schedule 会替换尚未执行的请求并通知正在执行的请求尽快放弃，调用方从不阻塞
+class FramePrefetcher {
+public:
+    using Loader = std::function<void(const FieldCacheKey&)>;
+
+    FramePrefetcher() = default;
+    ~FramePrefetcher();
+
+    void setLoader(Loader loader) { m_loader = std::move(loader); }
+
+    void schedule(std::vector<FieldCacheKey> keys);
+    void cancel();
+    void stop();
+
+    // 前台即将自行读取 keys，调用时不得持有 loader 使用的锁。在对应的 release 之前后台不再开始新的请求：
+    // 尚未执行的同一请求移出队列；正在加载其中某个 key 时等待其结束（结果在缓存中，或加载被放弃）；
+    // 正在加载其他请求时通知其放弃，使前台尽快拿到锁。可嵌套，每次 claim 对应一次 release
+    void claim(const std::vector<FieldCacheKey>& keys);
+    void release();
+
+    // 前台读取的作用域：构造时 claim，析构时 release，读取抛出异常时后台同样恢复
+    class Claim {
+    public:
+        Claim(FramePrefetcher& prefetcher, const std::vector<FieldCacheKey>& keys) : m_prefetcher(prefetcher)
+        {
+            m_prefetcher.claim(keys);
+        }
+        ~Claim() { m_prefetcher.release(); }
+        Claim(const Claim&) = delete;
+        Claim& operator=(const Claim&) = delete;
+
+    private:
+        FramePrefetcher& m_prefetcher;
+    };
+
+    // 正在执行的请求是否已被取消，loader 应在耗时操作中轮询
+    bool cancelRequested() const { return m_cancel.load(); }
+    const std::atomic<bool>& cancelFlag() const { return m_cancel; }
+
+private:
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+    void workerLoop();
+
+    Loader m_loader;
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_doneCv; // 当前请求结束时通知 claim
+    std::deque<FieldCacheKey> m_queue;
+    FieldCacheKey m_active;           // m_busy 为 true 时正在执行的请求
+    bool m_busy{false};
+    int m_foreground{0};              // 未 release 的前台读取数，大于 0 时后台暂停
+    std::atomic<bool> m_cancel{false};
+    bool m_stop{false};
+};
+
+#endif // FRAMEPREFETCHER_H
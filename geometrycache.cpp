@@ -0,0 +1,523 @@
+#include "geometrycache.h"
+#include "odbmanager.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'D', 'B', 'V', 'G', 'E', 'O', '\0'};
+constexpr std::uint32_t kVersion = 1;
+
+enum Section : std::uint32_t {
+    kSourcePath,
+    kCoordinates,
+    kOffsets,
+    kConnectivity,
+    kTypeIds,
+    kTypeNames,
+    kInstances,
+    kInstanceNames,
+    kNodeLabels,
+    kElementLabels,
+    kSectionCount
+};
+
+struct SectionEntry {
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMTime;
+    std::uint64_t nodeCount;
+    std::uint64_t elementCount;
+    std::uint64_t connectivityCount;
+    std::uint32_t wideIndex;
+    std::uint32_t instanceCount;
+    std::uint32_t typeNameCount;
+    std::uint32_t reserved;
+    SectionEntry sections[kSectionCount];
+    std::uint64_t payloadChecksum;
+};
+
+struct InstanceRecord {
+    std::uint64_t nodeStart;
+    std::uint64_t nodeCount;
+    std::uint64_t elementStart;
+    std::uint64_t elementCount;
+    std::uint64_t nameOffset;
+    std::uint64_t nameLength;
+};
+
+static_assert(std::is_trivially_copyable<nodeCoord>::value && sizeof(nodeCoord) == 3 * sizeof(double),
+              "nodeCoord must stay a packed xyz triple for the cache layout");
+
+// 按 8 字节字做 FNV 式混合的校验和，段按 8 字节对齐写入，因此流式计算与整体计算结果一致
+class PayloadHasher {
+public:
+    void update(const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        while (size > 0 && m_pending > 0) {
+            m_word[m_pending++] = *bytes++;
+            --size;
+            if (m_pending == 8) flushWord();
+        }
+        while (size >= 8) {
+            std::uint64_t w;
+            std::memcpy(&w, bytes, 8);
+            mix(w);
+            bytes += 8;
+            size -= 8;
+        }
+        while (size > 0) {
+            m_word[m_pending++] = *bytes++;
+            --size;
+        }
+    }
+    std::uint64_t finish()
+    {
+        for (std::size_t i = 0; i < m_pending; ++i) {
+            m_hash = (m_hash ^ m_word[i]) * kPrime;
+        }
+        m_pending = 0;
+        return m_hash;
+    }
+
+private:
+    static constexpr std::uint64_t kPrime = 1099511628211ull;
+    void mix(std::uint64_t w) { m_hash = (m_hash ^ w) * kPrime; }
+    void flushWord()
+    {
+        std::uint64_t w;
+        std::memcpy(&w, m_word, 8);
+        mix(w);
+        m_pending = 0;
+    }
+
+    std::uint64_t m_hash{1469598103934665603ull};
+    std::uint8_t m_word[8]{};
+    std::size_t m_pending{0};
+};
+
+class CacheWriter {
+public:
+    explicit CacheWriter(std::ofstream& out) : m_out(out) {}
+
+    void beginSection(CacheHeader& header, Section section)
+    {
+        m_current = &header.sections[section];
+        m_current->offset = m_position;
+        m_current->size = 0;
+    }
+    void write(const void* data, std::size_t size)
+    {
+        if (size == 0) return;
+        m_out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        m_hasher.update(data, size);
+        m_position += size;
+        if (m_current) m_current->size += size;
+    }
+    void endSection()
+    {
+        static const std::uint8_t zeros[8] = {};
+        const std::size_t pad = static_cast<std::size_t>((8 - m_position % 8) % 8);
+        m_current = nullptr;
+        write(zeros, pad);
+    }
+    std::uint64_t checksum() { return m_hasher.finish(); }
+
+private:
+    std::ofstream& m_out;
+    std::uint64_t m_position{sizeof(CacheHeader)};
+    PayloadHasher m_hasher;
+    SectionEntry* m_current{nullptr};
+};
+
+template <typename T>
+void writeVector(CacheWriter& writer, CacheHeader& header, Section section, const std::vector<T>& values)
+{
+    writer.beginSection(header, section);
+    writer.write(values.data(), values.size() * sizeof(T));
+    writer.endSection();
+}
+
+} // namespace
+
+bool GeometryCacheKey::fromFile(const std::string& path, GeometryCacheKey& key)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path p = fs::u8path(path);
+    const auto size = fs::file_size(p, ec);
+    if (ec) return false;
+    const auto mtime = fs::last_write_time(p, ec);
+    if (ec) return false;
+    const fs::path absolute = fs::absolute(p, ec);
+    if (ec) return false;
+
+    key.sourcePath = absolute.lexically_normal().u8string();
+    key.sourceSize = static_cast<std::uint64_t>(size);
+    key.sourceMTime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+std::string geometryCachePath(const std::string& odbFullName)
+{
+    return odbFullName + ".geomcache";
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!m_data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool readOdb::saveGeometryCache() const
+{
+    tracing::Span span("saveGeometryCache", "reader");
+    GeometryCacheKey key;
+    if (!GeometryCacheKey::fromFile(m_odbFullName, key)) {
+        return false;
+    }
+
+    // 路径为 UTF-8，统一转换为 fs::path，Windows 上非 ASCII 路径同样可以读写
+    const std::string cachePath = geometryCachePath(m_odbFullName);
+    const std::filesystem::path cacheFile = std::filesystem::u8path(cachePath);
+    std::filesystem::path tempFile = cacheFile;
+    tempFile += ".tmp";
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        ODB_LOG_WARNING("Cannot create geometry cache: " << tempFile.u8string());
+        return false;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(CacheHeader);
+    header.sourceSize = key.sourceSize;
+    header.sourceMTime = key.sourceMTime;
+    header.nodeCount = m_nodesNum;
+    header.elementCount = m_elementsNum;
+    header.connectivityCount = m_elementsConn.connectivitySize();
+    header.wideIndex = m_elementsConn.wideIndex ? 1u : 0u;
+    header.instanceCount = static_cast<std::uint32_t>(m_instanceInfos.size());
+
+    // 文件头最后回填，先占位
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    CacheWriter writer(out);
+
+    writer.beginSection(header, kSourcePath);
+    writer.write(key.sourcePath.data(), key.sourcePath.size());
+    writer.endSection();
+
+    writeVector(writer, header, kCoordinates, m_nodesCoord);
+    if (m_elementsConn.wideIndex) {
+        writeVector(writer, header, kOffsets, *m_elementsConn.offsets64);
+        writeVector(writer, header, kConnectivity, *m_elementsConn.connectivity64);
+    } else {
+        writeVector(writer, header, kOffsets, *m_elementsConn.offsets32);
+        writeVector(writer, header, kConnectivity, *m_elementsConn.connectivity32);
+    }
+
+    // 单元类型：驻留后的编号与名称表
+    header.typeNameCount = static_cast<std::uint32_t>(m_elementTypeNames.size());
+    writeVector(writer, header, kTypeIds, m_elementTypeIds);
+    writer.beginSection(header, kTypeNames);
+    for (const std::string& name : m_elementTypeNames) {
+        writer.write(name.c_str(), name.size() + 1);
+    }
+    writer.endSection();
+
+    std::vector<InstanceRecord> records;
+    std::string instanceNames;
+    std::vector<int> nodeLabels(m_nodesNum, 0);
+    std::vector<int> elementLabels(m_elementsNum, 0);
+    std::vector<int> labels;
+    for (const InstanceInfo& info : m_instanceInfos) {
+        InstanceRecord rec{};
+        rec.nodeStart = info.nodeStartIndex;
+        rec.nodeCount = info.nodeCount;
+        rec.elementStart = info.elementStartIndex;
+        rec.elementCount = info.elementCount;
+        rec.nameOffset = instanceNames.size();
+        rec.nameLength = info.name.size();
+        instanceNames += info.name;
+        records.push_back(rec);
+
+        info.nodeLabelToIndex.exportLabels(labels);
+        std::copy(labels.begin(), labels.end(), nodeLabels.begin() + static_cast<std::ptrdiff_t>(info.nodeStartIndex));
+        info.elementLabelToIndex.exportLabels(labels);
+        std::copy(labels.begin(), labels.end(), elementLabels.begin() + static_cast<std::ptrdiff_t>(info.elementStartIndex));
+    }
+    writeVector(writer, header, kInstances, records);
+    writer.beginSection(header, kInstanceNames);
+    writer.write(instanceNames.data(), instanceNames.size());
+    writer.endSection();
+    writeVector(writer, header, kNodeLabels, nodeLabels);
+    writeVector(writer, header, kElementLabels, elementLabels);
+
+    header.payloadChecksum = writer.checksum();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        ODB_LOG_WARNING("Failed to write geometry cache: " << tempFile.u8string());
+        std::error_code removeEc;
+        std::filesystem::remove(tempFile, removeEc);
+        return false;
+    }
+
+    // 先写临时文件再替换，避免中断时留下半截缓存
+    std::error_code ec;
+    std::filesystem::rename(tempFile, cacheFile, ec);
+    if (ec) {
+        ODB_LOG_WARNING("Failed to install geometry cache: " << ec.message());
+        std::error_code removeEc;
+        std::filesystem::remove(tempFile, removeEc);
+        return false;
+    }
+    ODB_LOG_INFO("Geometry cache written: " << cachePath);
+    return true;
+}
+
+bool readOdb::loadGeometryCache()
+{
+    tracing::Span span("loadGeometryCache", "reader");
+    GeometryCacheKey key;
+    if (!GeometryCacheKey::fromFile(m_odbFullName, key)) {
+        return false;
+    }
+    const std::string cachePath = geometryCachePath(m_odbFullName);
+    MappedFile file;
+    if (!file.open(std::filesystem::u8path(cachePath))) {
+        return false;
+    }
+
+    const std::uint8_t* base = file.data();
+    if (file.size() < sizeof(CacheHeader)) {
+        ODB_LOG_WARNING("Geometry cache truncated, rebuilding.");
+        return false;
+    }
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+        || header.headerSize != sizeof(CacheHeader)) {
+        ODB_LOG_WARNING("Geometry cache format mismatch, rebuilding.");
+        return false;
+    }
+    if (header.sourceSize != key.sourceSize || header.sourceMTime != key.sourceMTime) {
+        ODB_LOG_INFO("Geometry cache is stale, rebuilding.");
+        return false;
+    }
+
+    // 段边界与计数校验
+    const std::uint64_t indexWidth = header.wideIndex ? 8 : 4;
+    const std::uint64_t expectedSize[kSectionCount] = {
+        key.sourcePath.size(),
+        header.nodeCount * sizeof(nodeCoord),
+        (header.elementCount + 1) * indexWidth,
+        header.connectivityCount * indexWidth,
+        header.elementCount * sizeof(std::uint16_t),
+        header.sections[kTypeNames].size,
+        header.instanceCount * sizeof(InstanceRecord),
+        header.sections[kInstanceNames].size,
+        header.nodeCount * sizeof(int),
+        header.elementCount * sizeof(int),
+    };
+    for (std::uint32_t s = 0; s < kSectionCount; ++s) {
+        const SectionEntry& entry = header.sections[s];
+        if (entry.size != expectedSize[s] || entry.offset < sizeof(CacheHeader) || entry.offset % 8 != 0
+            || entry.offset > file.size() || entry.size > file.size() - entry.offset) {
+            ODB_LOG_WARNING("Geometry cache corrupt, rebuilding.");
+            return false;
+        }
+    }
+    const char* storedPath = reinterpret_cast<const char*>(base + header.sections[kSourcePath].offset);
+    if (key.sourcePath.compare(0, std::string::npos, storedPath, header.sections[kSourcePath].size) != 0) {
+        ODB_LOG_INFO("Geometry cache belongs to another file, rebuilding.");
+        return false;
+    }
+    PayloadHasher hasher;
+    hasher.update(base + sizeof(CacheHeader), file.size() - sizeof(CacheHeader));
+    if (hasher.finish() != header.payloadChecksum) {
+        ODB_LOG_WARNING("Geometry cache checksum mismatch, rebuilding.");
+        return false;
+    }
+
+    auto sectionPtr = [&](Section s) { return base + header.sections[s].offset; };
+
+    // 单元类型名称表
+    std::vector<std::string> typeNames;
+    {
+        const char* p = reinterpret_cast<const char*>(sectionPtr(kTypeNames));
+        const char* end = p + header.sections[kTypeNames].size;
+        while (p < end && typeNames.size() < header.typeNameCount) {
+            const std::size_t len = strnlen(p, static_cast<std::size_t>(end - p));
+            typeNames.emplace_back(p, len);
+            p += len + 1;
+        }
+        if (typeNames.size() != header.typeNameCount) {
+            ODB_LOG_WARNING("Geometry cache type table corrupt, rebuilding.");
+            return false;
+        }
+    }
+    const auto* typeIds = reinterpret_cast<const std::uint16_t*>(sectionPtr(kTypeIds));
+    for (std::uint64_t e = 0; e < header.elementCount; ++e) {
+        if (typeIds[e] >= typeNames.size()) {
+            ODB_LOG_WARNING("Geometry cache type ids corrupt, rebuilding.");
+            return false;
+        }
+    }
+
+    std::vector<InstanceRecord> records(header.instanceCount);
+    std::memcpy(records.data(), sectionPtr(kInstances), records.size() * sizeof(InstanceRecord));
+    for (const InstanceRecord& rec : records) {
+        if (rec.nameOffset + rec.nameLength > header.sections[kInstanceNames].size
+            || rec.nodeStart + rec.nodeCount > header.nodeCount
+            || rec.elementStart + rec.elementCount > header.elementCount) {
+            ODB_LOG_WARNING("Geometry cache instance table corrupt, rebuilding.");
+            return false;
+        }
+    }
+
+    // 校验通过，开始填充几何数据
+    m_nodesCoord.resize(header.nodeCount);
+    std::memcpy(m_nodesCoord.data(), sectionPtr(kCoordinates), header.sections[kCoordinates].size);
+
+    m_elementsConn.reset(header.wideIndex != 0);
+    if (m_elementsConn.wideIndex) {
+        const auto* offsets = reinterpret_cast<const std::int64_t*>(sectionPtr(kOffsets));
+        const auto* conn = reinterpret_cast<const std::int64_t*>(sectionPtr(kConnectivity));
+        m_elementsConn.offsets64->assign(offsets, offsets + header.elementCount + 1);
+        m_elementsConn.connectivity64->assign(conn, conn + header.connectivityCount);
+    } else {
+        const auto* offsets = reinterpret_cast<const std::int32_t*>(sectionPtr(kOffsets));
+        const auto* conn = reinterpret_cast<const std::int32_t*>(sectionPtr(kConnectivity));
+        m_elementsConn.offsets32->assign(offsets, offsets + header.elementCount + 1);
+        m_elementsConn.connectivity32->assign(conn, conn + header.connectivityCount);
+    }
+
+    m_elementTypeIds.assign(typeIds, typeIds + header.elementCount);
+    m_elementTypeNames = std::move(typeNames);
+    m_elementTypeIndex.clear();
+    for (std::size_t id = 0; id < m_elementTypeNames.size(); ++id) {
+        m_elementTypeIndex.emplace(m_elementTypeNames[id], static_cast<std::uint16_t>(id));
+    }
+
+    const char* names = reinterpret_cast<const char*>(sectionPtr(kInstanceNames));
+    const auto* nodeLabels = reinterpret_cast<const int*>(sectionPtr(kNodeLabels));
+    const auto* elementLabels = reinterpret_cast<const int*>(sectionPtr(kElementLabels));
+    m_instanceInfos.clear();
+    m_instanceIndexByName.clear();
+    std::vector<int> labels;
+    for (const InstanceRecord& rec : records) {
+        InstanceInfo info;
+        info.name.assign(names + rec.nameOffset, static_cast<std::size_t>(rec.nameLength));
+        info.nodeStartIndex = static_cast<std::size_t>(rec.nodeStart);
+        info.nodeCount = static_cast<std::size_t>(rec.nodeCount);
+        info.elementStartIndex = static_cast<std::size_t>(rec.elementStart);
+        info.elementCount = static_cast<std::size_t>(rec.elementCount);
+        labels.assign(nodeLabels + rec.nodeStart, nodeLabels + rec.nodeStart + rec.nodeCount);
+        info.nodeLabelToIndex.build(labels, info.nodeStartIndex);
+        labels.assign(elementLabels + rec.elementStart, elementLabels + rec.elementStart + rec.elementCount);
+        info.elementLabelToIndex.build(labels, info.elementStartIndex);
+        m_instanceIndexByName[info.name] = m_instanceInfos.size();
+        m_instanceInfos.emplace_back(std::move(info));
+    }
+
+    m_nodesNum = static_cast<std::size_t>(header.nodeCount);
+    m_elementsNum = static_cast<std::size_t>(header.elementCount);
+    ODB_LOG_INFO("Geometry loaded from cache: " << m_nodesNum << " nodes, "
+                 << m_elementsNum << " elements.");
+    return true;
+}
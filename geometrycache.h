@@ -0,0 +1,49 @@
+#ifndef GEOMETRYCACHE_H
+#define GEOMETRYCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// 几何缓存：与 .odb 同目录的旁路文件（<name>.odb.geomcache）
+// 以源文件路径、大小与修改时间作为键，布局为定长文件头 + 8 字节对齐的数据段，
+// 重新打开时直接内存映射读取，跳过 ODB API 的几何遍历
+struct GeometryCacheKey {
+    std::string sourcePath;
+    std::uint64_t sourceSize{0};
+    std::int64_t sourceMTime{0};
+
+    static bool fromFile(const std::string& path, GeometryCacheKey& key);
+};
+
+std::string geometryCachePath(const std::string& odbFullName);
+
+// 只读内存映射文件
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // 路径按平台的宽字符 / 多字节形式打开，调用方用 fs::u8path 由 UTF-8 构造
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    const std::uint8_t* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* m_data{nullptr};
+    std::size_t m_size{0};
+#ifdef _WIN32
+    void* m_fileHandle{nullptr};
+    void* m_mappingHandle{nullptr};
+#else
+    int m_fd{-1};
+#endif
+};
+
+#endif // GEOMETRYCACHE_H
@@ -1,5 +1,7 @@
 #include "global.h"
+#include "allocationcounter.h"
 #include "mainwindow.h"
+#include "tracing.h"
 
 #include <QApplication>
 #include <QSurfaceFormat>
@@ -7,6 +9,7 @@
 
 int main(int argc, char *argv[])
 {
+    tracing::setAllocationCounter(allocatedBytes);
     QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QSurfaceFormat::setDefaultFormat(QVTKOpenGLNativeWidget::defaultFormat());
 
@@ -1,9 +1,22 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <algorithm>
+#include <QActionGroup>
+#include <QApplication>
+#include <QInputDialog>
+#include <QLabel>
 #include <vtkSmartPointer.h>
 #include <vtkInteractorStyleTrackballCamera.h>
 #include "creategrid.h"
+#include "tracing.h"
+
+namespace {
+// 步节点下的占位节点：记录步名与下一页帧的起始位置
+constexpr int kStepNameRole = Qt::UserRole + 3;
+constexpr int kNextFrameRole = Qt::UserRole + 4;
+constexpr int kFramePageSize = 500;
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -18,7 +31,56 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->actionopen, &QAction::triggered, this, &MainWindow::openFile);
     connect(ui->actionsave_as, &QAction::triggered, this, &MainWindow::saveFile);
+    connect(ui->actionExportPartitioned, &QAction::triggered, this, &MainWindow::exportPartitioned);
+    connect(ui->actionFieldExpression, &QAction::triggered, this, &MainWindow::evaluateExpression);
     connect(ui->treeView, &QTreeView::activated, this, &MainWindow::onTreeItemActivated);
+    connect(ui->treeView, &QTreeView::expanded, this, &MainWindow::onTreeItemExpanded);
+
+    // 单元积分点汇总方式，互斥选择
+    auto* reductionGroup = new QActionGroup(this);
+    reductionGroup->addAction(ui->actionIPCentroid);
+    reductionGroup->addAction(ui->actionIPMaximum);
+    reductionGroup->addAction(ui->actionIPFirst);
+    reductionGroup->addAction(ui->actionIPSelected);
+    connect(reductionGroup, &QActionGroup::triggered, this, &MainWindow::onReductionChanged);
+    // 保留积分点默认关闭：开启后读取的单元场可在内存中切换汇总方式
+    connect(ui->actionKeepIntegrationPoints, &QAction::toggled, this, [this](bool keep) {
+        if (!m_odb) return;
+        m_odb->setKeepIntegrationPoints(keep);
+        reloadCurrentField();
+    });
+    connect(ui->actionClipLegend, &QAction::toggled, this, [this]() {
+        if (m_odb && !m_lastFieldName.isEmpty()) {
+            if (auto fd = m_odb->shareFieldData(m_lastFieldName.toStdString())) {
+                displayField(fd, m_lastFieldName);
+            }
+        }
+    });
+
+    // 变形比例：只重算变形坐标缓冲区，不重建网格
+    ui->toolBar->addSeparator();
+    ui->toolBar->addWidget(new QLabel(tr(" 变形比例 "), this));
+    m_deformationScale = new QDoubleSpinBox(this);
+    m_deformationScale->setRange(0.0, 1.0e6);
+    m_deformationScale->setDecimals(3);
+    m_deformationScale->setSingleStep(1.0);
+    m_deformationScale->setValue(0.0);
+    m_deformationScale->setToolTip(tr("变形坐标 = 参考坐标 + 比例 × U，0 为未变形"));
+    ui->toolBar->addWidget(m_deformationScale);
+    connect(m_deformationScale, &QDoubleSpinBox::valueChanged, this, &MainWindow::onDeformationScaleChanged);
+
+    // 后台加载：进度与结果经队列连接回到主线程
+    m_loader = new OdbLoader(this);
+    connect(m_loader, &OdbLoader::progressChanged, this, &MainWindow::onLoadProgress);
+    connect(m_loader, &OdbLoader::loaded, this, &MainWindow::onOdbLoaded);
+    connect(m_loader, &OdbLoader::cancelled, this, [this]() {
+        onLoadFinished();
+        ui->statusBar->showMessage(tr("Loading cancelled"), 5000);
+    });
+    connect(m_loader, &OdbLoader::failed, this, [this](const QString& message) {
+        onLoadFinished();
+        QMessageBox::critical(this, tr("Error"), tr("Failed to open ODB file:\n%1").arg(message));
+    });
 
     // 初始化左侧模型树
     m_treeModel = new QStandardItemModel(this);
@@ -29,47 +91,108 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // 先结束后台加载线程，再释放界面
+    delete m_loader;
     delete ui;
 }
 
 void MainWindow::openFile() {
+    if (m_loader->isRunning()) {
+        return;
+    }
     QString fileName = QFileDialog::getOpenFileName(this, tr("Open ODB File"), QString(),
-                                                    tr("Abaqus ODB File (*.odb)"));
+                                                    tr("Abaqus ODB File (*.odb);;Synthetic Model (*.synth)"));
 
     if (fileName.isEmpty()) {
         return;
     }
 
-    try {
-        m_odb = std::make_unique<readOdb>(fileName.toStdString().c_str());
+    // 先释放当前模型，避免新旧两份几何同时驻留；已显示的网格由渲染管线持有，加载期间仍可交互
+    m_gridBuilder.reset();
+    m_odb.reset();
+    m_lastFieldName.clear();
+    buildModelTree();
+
+    if (!m_loader->start(fileName)) {
+        return;
     }
-    catch (const std::exception& e) {
-        QMessageBox::critical(this, tr("Error"), tr("Failed to open ODB file:\n%1").arg(e.what()));
+    setLoading(true);
+    m_loadDialog = new QProgressDialog(tr("Opening %1").arg(fileName), tr("Cancel"), 0, 1000, this);
+    m_loadDialog->setWindowModality(Qt::NonModal);
+    m_loadDialog->setAutoClose(false);
+    m_loadDialog->setAutoReset(false);
+    m_loadDialog->setMinimumDuration(0);
+    connect(m_loadDialog, &QProgressDialog::canceled, this, [this]() {
+        m_loader->cancel();
+        ui->statusBar->showMessage(tr("Cancelling..."));
+    });
+    m_loadDialog->show();
+}
+
+void MainWindow::onLoadProgress(const QString& phase, qint64 done, qint64 total)
+{
+    if (!m_loadDialog || m_loadDialog->wasCanceled()) {
+        return;
+    }
+    m_loadDialog->setLabelText(phase);
+    m_loadDialog->setValue(total > 0 ? static_cast<int>(done * 1000 / total) : 0);
+}
+
+void MainWindow::onOdbLoaded(const QString& fileName)
+{
+    m_odb = m_loader->takeOdb();
+    m_gridBuilder = m_loader->takeGridBuilder();
+    if (!m_odb || !m_gridBuilder) {
+        onLoadFinished();
         return;
     }
+    // 单元场以节点平均的平滑云图显示
+    m_gridBuilder->setNodalAveraging(true);
+    ui->actionIPCentroid->setChecked(true);
+    m_odb->setKeepIntegrationPoints(ui->actionKeepIntegrationPoints->isChecked());
+    m_odb->setIntegrationPointReduction(std::string(), IPReduction::CENTROID);
+    onLoadProgress(tr("Rendering"), 0, 1);
 
     try {
-        m_gridBuilder = std::make_unique<CreateVTKUnstucturedGrid>(*m_odb);
+        // 打开时不读取 U/UR/S，按需加载；变形比例不为 0 时读取第一帧的 U
+        m_selectedStepFrame = StepFrameInfo();
+        firstStepFrame(m_selectedStepFrame);
+        updateDeformation(true);
+
         m_vtkDisplay.displaySolid(m_gridBuilder->getGrid());
         m_vtkDisplay.setCameraView();
         m_vtkDisplay.addAxes();
 
-        m_odb->releaseGeometryCache();
-        // 打开时不读取 U/UR/S，按需加载
-        const auto frames = m_odb->getAvailableStepsFrames();
-        if (!frames.empty()) {
-            m_selectedStepFrame = frames.front();
+        {
+            tracing::Span span("render", "render");
+            m_vtkDisplay.getRenderWindow()->Render();
         }
-
-        m_vtkDisplay.getRenderWindow()->Render();
         ui->statusBar->showMessage(tr("Successfully opened ODB file: %1").arg(fileName), 5000);
 
         buildModelTree();
     }
     catch (const std::exception& e) {
         QMessageBox::critical(this, tr("Error"), tr("Failed to display ODB data:\n%1").arg(e.what()));
-        return;
     }
+    onLoadFinished();
+}
+
+void MainWindow::onLoadFinished()
+{
+    if (m_loadDialog) {
+        m_loadDialog->close();
+        m_loadDialog->deleteLater();
+        m_loadDialog = nullptr;
+    }
+    setLoading(false);
+}
+
+void MainWindow::setLoading(bool loading)
+{
+    ui->actionopen->setEnabled(!loading);
+    ui->actionsave_as->setEnabled(!loading);
+    ui->actionExportPartitioned->setEnabled(!loading);
+    ui->actionFieldExpression->setEnabled(!loading);
 }
 
 void MainWindow::buildModelTree()
@@ -98,37 +221,32 @@ void MainWindow::buildModelTree()
         instancesRoot->appendRow(instItem);
     }
 
-    //步与帧（按步分组）
-    const auto frames = m_odb->getAvailableStepsFrames();
-    std::map<QString, std::vector<StepFrameInfo>> grouped;
-    for (const auto& sf : frames) {
-        grouped[QString::fromStdString(sf.stepName)].push_back(sf);
-    }
-    for (const auto& [stepName, vec] : grouped) {
-        QStandardItem* stepItem = new QStandardItem(stepName);
+    //步与帧：只建立步节点，帧在展开时分页加载
+    for (const auto& stepName : m_odb->getStepNames()) {
+        const int frameCount = m_odb->getFrameCount(stepName);
+        QStandardItem* stepItem = new QStandardItem(tr("%1 (%2 frames)").arg(QString::fromStdString(stepName)).arg(frameCount));
         stepsRoot->appendRow(stepItem);
-        for (const auto& sf : vec) {
-            QString frameText = tr("Frame %1, Time %2")
-                                    .arg(sf.frameIndex)
-                                    .arg(sf.frameValue);
-            QStandardItem* frameItem = new QStandardItem(frameText);
-            frameItem->setData(sf.frameIndex, Qt::UserRole + 1);
-            frameItem->setData(QString::fromStdString(sf.stepName), Qt::UserRole + 2);
-            stepItem->appendRow(frameItem);
+        if (frameCount > 0) {
+            QStandardItem* pending = new QStandardItem(tr("加载中..."));
+            pending->setData(QString::fromStdString(stepName), kStepNameRole);
+            pending->setData(0, kNextFrameRole);
+            stepItem->appendRow(pending);
         }
     }
 
     //可用场变量
-    if (!frames.empty()) {
-        const auto& first = frames.front();
-        auto fieldInfos = m_odb->listFieldNames(first.stepName, first.frameIndex);
+    StepFrameInfo first;
+    if (firstStepFrame(first)) {
+        const auto fieldInfos = m_odb->listFields(first.stepName, first.frameIndex);
         if (!fieldInfos.empty()) {
-            for (const auto& kv : fieldInfos) {
-                const QString fieldName = QString::fromStdString(kv.first);
+            for (const FieldCatalogEntry* field : fieldInfos) {
+                const QString fieldName = QString::fromStdString(field->name);
                 QStandardItem* fieldItem = new QStandardItem(fieldName);
                 fieldItem->setData(fieldName, Qt::UserRole + 1);
+                fieldItem->setToolTip(tr("%1 (%2)").arg(QString::fromStdString(field->description))
+                                          .arg(field->isNodal ? tr("节点") : tr("单元")));
                 fieldsRoot->appendRow(fieldItem);
-                for (const auto& compLabel : kv.second) {
+                for (const auto& compLabel : field->componentLabels) {
                     fieldItem->appendRow(new QStandardItem(QString::fromStdString(compLabel)));
                 }
             }
@@ -140,6 +258,57 @@ void MainWindow::buildModelTree()
     }
 }
 
+bool MainWindow::firstStepFrame(StepFrameInfo& info) const
+{
+    if (!m_odb) return false;
+    for (const auto& stepName : m_odb->getStepNames()) {
+        if (m_odb->getFrameInfo(stepName, 0, info)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainWindow::onTreeItemExpanded(const QModelIndex& index)
+{
+    QStandardItem* stepItem = m_treeModel ? m_treeModel->itemFromIndex(index) : nullptr;
+    if (!stepItem || stepItem->rowCount() != 1) return;
+    QStandardItem* pending = stepItem->child(0);
+    if (pending->data(kNextFrameRole).isValid() && pending->data(kNextFrameRole).toInt() == 0) {
+        appendFramePage(pending);
+    }
+}
+
+void MainWindow::appendFramePage(QStandardItem* moreItem)
+{
+    // 以占位节点记录下一页的起始位置；加载一页后把占位节点移到末尾或删除
+    if (!m_odb) return;
+    QStandardItem* stepItem = moreItem->parent();
+    const std::string stepName = moreItem->data(kStepNameRole).toString().toStdString();
+    const int begin = moreItem->data(kNextFrameRole).toInt();
+    const int frameCount = m_odb->getFrameCount(stepName);
+    const int end = std::min(frameCount, begin + kFramePageSize);
+    stepItem->removeRow(moreItem->row());
+
+    for (int pos = begin; pos < end; ++pos) {
+        StepFrameInfo sf;
+        if (!m_odb->getFrameInfo(stepName, pos, sf)) break;
+        QString frameText = tr("Frame %1, Time %2")
+                                .arg(sf.frameIndex)
+                                .arg(sf.frameValue);
+        QStandardItem* frameItem = new QStandardItem(frameText);
+        frameItem->setData(sf.frameIndex, Qt::UserRole + 1);
+        frameItem->setData(QString::fromStdString(sf.stepName), Qt::UserRole + 2);
+        stepItem->appendRow(frameItem);
+    }
+    if (end < frameCount) {
+        QStandardItem* more = new QStandardItem(tr("更多帧 (%1 / %2)...").arg(end).arg(frameCount));
+        more->setData(QString::fromStdString(stepName), kStepNameRole);
+        more->setData(end, kNextFrameRole);
+        stepItem->appendRow(more);
+    }
+}
+
 void MainWindow::onTreeItemActivated(const QModelIndex& index)
 {
     if (!m_odb || !m_treeModel) return;
@@ -152,6 +321,10 @@ void MainWindow::onTreeItemActivated(const QModelIndex& index)
     const QString rootName = root->text();
 
     if (rootName == tr("步与帧")) {
+        if (item->data(kNextFrameRole).isValid()) {
+            appendFramePage(item);
+            return;
+        }
         // 选择帧：更新当前选中帧
         const int frameIndex = item->data(Qt::UserRole + 1).toInt();
         const QString stepName = item->data(Qt::UserRole + 2).toString();
@@ -162,6 +335,10 @@ void MainWindow::onTreeItemActivated(const QModelIndex& index)
             sf.frameValue = 0.0;
             sf.description = item->text().toStdString();
             m_selectedStepFrame = sf;
+            // 选择已移动：取消旧的预取，并在后台读取新帧及其相邻帧的同一场
+            if (!m_lastFieldName.isEmpty()) {
+                m_odb->prefetchNeighbours(sf.stepName, sf.frameIndex, m_lastFieldName.toStdString());
+            }
             ui->statusBar->showMessage(tr("当前帧: %1 / %2").arg(stepName).arg(frameIndex), 3000);
         }
         return;
@@ -177,40 +354,32 @@ void MainWindow::onTreeItemActivated(const QModelIndex& index)
 
         // 若未选中帧，使用第一个可用帧
         StepFrameInfo sf = m_selectedStepFrame;
-        const auto frames = m_odb->getAvailableStepsFrames();
-        if (sf.stepName.empty() && !frames.empty()) {
-            sf = frames.front();
+        if (sf.stepName.empty()) {
+            firstStepFrame(sf);
+        }
+
+        // 场目录已记录各帧含有的场，缺失时无需访问 ODB
+        if (!m_odb->isFieldInFrame(sf.stepName, sf.frameIndex, fieldName.toStdString())) {
+            QMessageBox::warning(this, tr("Warning"), tr("字段 %1 不存在于当前帧").arg(fieldName));
+            return;
         }
 
         try {
             // 按需读取：只读取用户选择的场变量，减少内存占用
             m_odb->readSingleField(sf.stepName, sf.frameIndex, fieldName.toStdString());
-            const FieldData* fdPtr = m_odb->getFieldData(fieldName.toStdString());
+            const std::shared_ptr<const FieldData> fdPtr = m_odb->shareFieldData(fieldName.toStdString());
             if (!fdPtr) {
                 QMessageBox::warning(this, tr("Warning"), tr("字段 %1 不存在于当前帧").arg(fieldName));
                 return;
             }
-            if (!m_gridBuilder) {
-                m_gridBuilder = std::make_unique<CreateVTKUnstucturedGrid>(*m_odb);
-            }
-            const FieldData& fd = *fdPtr;
-            if (!m_gridBuilder->addFieldData(fd)) {
-                QMessageBox::warning(this, tr("Warning"), tr("添加字段失败: %1").arg(fieldName));
+            if (!displayField(fdPtr, fieldName)) {
                 return;
             }
-
-            // 对 U/UR 计算模长并显示
-            if (fd.type == FieldType::DISPLACEMENT || fd.type == FieldType::ROTATION) {
-                const QString magName = fieldName + ".Magnitude";
-                m_vtkDisplay.addPointVectorMagnitude(m_gridBuilder->getGrid(), fieldName.toStdString(), magName.toStdString());
-                m_vtkDisplay.displayWithScalarField(m_gridBuilder->getGrid(), magName.toStdString(), true);
-            } else if (fd.type == FieldType::STRESS) {
-                // 默认显示张量第一个分量
-                m_vtkDisplay.displayWithScalarField(m_gridBuilder->getGrid(), fieldName.toStdString(), false);
-            }
-
-            m_vtkDisplay.getRenderWindow()->Render();
             ui->statusBar->showMessage(tr("显示字段: %1 (帧 %2)").arg(fieldName).arg(sf.frameIndex), 3000);
+
+            // 下一次查看的通常是相邻帧，提前在后台读取
+            m_lastFieldName = fieldName;
+            m_odb->prefetchNeighbours(sf.stepName, sf.frameIndex, fieldName.toStdString());
         } catch (const std::exception& e) {
             QMessageBox::critical(this, tr("Error"), tr("加载字段失败: %1").arg(e.what()));
             return;
@@ -218,6 +387,199 @@ void MainWindow::onTreeItemActivated(const QModelIndex& index)
     }
 }
 
+bool MainWindow::displayField(const std::shared_ptr<const FieldData>& field, const QString& fieldName)
+{
+    tracing::Span span("displayField", "render");
+    if (!field) {
+        return false;
+    }
+    if (!m_gridBuilder) {
+        m_gridBuilder = std::make_unique<CreateVTKUnstucturedGrid>(*m_odb);
+        m_gridBuilder->setNodalAveraging(true);
+    }
+    // 共享场数据的缓冲区，网格中的数组不再复制一份
+    const FieldData& fd = *field;
+    if (!m_gridBuilder->addFieldData(field)) {
+        QMessageBox::warning(this, tr("Warning"), tr("添加字段失败: %1").arg(fieldName));
+        return false;
+    }
+
+    // 色标范围直接取提取时计算的统计量，无需再扫描数组
+    double range[2] = {0.0, 1.0};
+
+    // 对 U/UR 计算模长并显示
+    if (fd.type == FieldType::DISPLACEMENT || fd.type == FieldType::ROTATION) {
+        const QString magName = fieldName + ".Magnitude";
+        m_vtkDisplay.addPointVectorMagnitude(m_gridBuilder->getGrid(), fieldName.toStdString(), magName.toStdString());
+        m_vtkDisplay.displayWithScalarField(m_gridBuilder->getGrid(), magName.toStdString(), true,
+                                            legendRange(fd.stats.magnitude(), range) ? range : nullptr);
+    } else if (fd.type == FieldType::STRESS) {
+        // 默认显示张量第一个分量，有节点平均结果时显示平滑云图，色标取平均后点数据的统计量
+        const std::string arrayName = fieldName.toStdString();
+        const bool averaged = m_gridBuilder->getGrid()->GetPointData()->HasArray(arrayName.c_str());
+        const FieldStats* nodalStats = averaged ? m_gridBuilder->nodalAverageStats(arrayName) : nullptr;
+        const ChannelStats* stats = nodalStats ? nodalStats->component(0) : fd.stats.component(0);
+        m_vtkDisplay.displayWithScalarField(m_gridBuilder->getGrid(), arrayName, averaged,
+                                            legendRange(stats, range) ? range : nullptr);
+    }
+    // 变形跟随当前帧；位移读取失败时仍显示未变形的云图
+    try {
+        updateDeformation(true);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, tr("Error"), tr("读取位移场失败: %1").arg(e.what()));
+    }
+
+    {
+        tracing::Span renderSpan("render", "render");
+        m_vtkDisplay.getRenderWindow()->Render();
+    }
+    return true;
+}
+
+bool MainWindow::legendRange(const ChannelStats* stats, double range[2]) const
+{
+    if (!stats || stats->count == 0) {
+        return false;
+    }
+    // 按 1% / 99% 分位数裁剪时少数奇异值不会压缩整个色标
+    const bool clip = ui->actionClipLegend->isChecked();
+    range[0] = clip ? stats->percentile(1.0) : stats->min;
+    range[1] = clip ? stats->percentile(99.0) : stats->max;
+    return true;
+}
+
+void MainWindow::onReductionChanged(QAction* action)
+{
+    IPReduction mode = IPReduction::CENTROID;
+    int selectedPoint = 0;
+    if (action == ui->actionIPMaximum) {
+        mode = IPReduction::MAXIMUM;
+    } else if (action == ui->actionIPFirst) {
+        mode = IPReduction::FIRST_POINT;
+    } else if (action == ui->actionIPSelected) {
+        bool ok = false;
+        const int point = QInputDialog::getInt(this, tr("积分点"), tr("积分点编号 (从 1 开始):"), 1, 1, 27, 1, &ok);
+        if (!ok) return;
+        mode = IPReduction::SELECTED_POINT;
+        selectedPoint = point - 1;
+    }
+    if (!m_odb) return;
+
+    // 当前显示的场保留了积分点时直接在内存中重新汇总并刷新，否则按新的汇总方式重新读取
+    const std::string fieldName = m_lastFieldName.toStdString();
+    const bool shown = m_odb->setIntegrationPointReduction(fieldName, mode, selectedPoint)
+        ? displayField(m_odb->shareFieldData(fieldName), m_lastFieldName)
+        : reloadCurrentField();
+    if (shown) {
+        ui->statusBar->showMessage(tr("已切换积分点汇总方式: %1").arg(action->text()), 3000);
+    }
+}
+
+bool MainWindow::reloadCurrentField()
+{
+    if (!m_odb || m_lastFieldName.isEmpty()) return false;
+    const StepFrameInfo sf = m_odb->getCurrentStepFrame();
+    const std::string fieldName = m_lastFieldName.toStdString();
+    try {
+        if (!m_odb->readSingleField(sf.stepName, sf.frameIndex, fieldName)) {
+            return false;
+        }
+        return displayField(m_odb->shareFieldData(fieldName), m_lastFieldName);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, tr("Error"), tr("加载字段失败: %1").arg(e.what()));
+        return false;
+    }
+}
+
+void MainWindow::updateDeformation(bool reload)
+{
+    if (!m_odb || !m_gridBuilder) return;
+    const double scale = m_deformationScale->value();
+    StepFrameInfo sf = m_selectedStepFrame;
+    if (sf.stepName.empty()) {
+        firstStepFrame(sf);
+    }
+    // 位移场只在所选帧变化时重新读取，重绘同一帧或改变比例只重算坐标
+    const bool current = m_gridBuilder->hasDeformation() && m_deformationFrame.stepName == sf.stepName
+        && m_deformationFrame.frameIndex == sf.frameIndex;
+    if (scale == 0.0 || current || (!reload && m_gridBuilder->hasDeformation())) {
+        m_gridBuilder->setDeformationScale(scale);
+        return;
+    }
+    // 经场缓存单独读取 U，不替换当前帧已加载的场（显示中的 S、表达式所需的分量等）
+    std::shared_ptr<const FieldData> displacement;
+    if (m_odb->isFieldInFrame(sf.stepName, sf.frameIndex, "U")) {
+        displacement = m_odb->loadField(sf.stepName, sf.frameIndex, "U");
+    }
+    if (!displacement) {
+        ui->statusBar->showMessage(tr("当前帧没有位移场 U，显示未变形形状"), 3000);
+    }
+    m_gridBuilder->setDeformation(displacement, scale);
+    m_deformationFrame = displacement ? sf : StepFrameInfo();
+}
+
+void MainWindow::onDeformationScaleChanged(double scale)
+{
+    if (!m_odb || !m_gridBuilder) return;
+    tracing::Span span("deformationScale", "render");
+    try {
+        updateDeformation(false);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, tr("Error"), tr("读取位移场失败: %1").arg(e.what()));
+        return;
+    }
+    {
+        tracing::Span renderSpan("render", "render");
+        m_vtkDisplay.getRenderWindow()->Render();
+    }
+    ui->statusBar->showMessage(tr("变形比例: %1").arg(scale), 2000);
+}
+
+void MainWindow::evaluateExpression()
+{
+    if (!m_odb || !m_gridBuilder) {
+        QMessageBox::warning(this, tr("Warning"), tr("请先显示一个字段"));
+        return;
+    }
+    bool ok = false;
+    const QString text = QInputDialog::getText(this, tr("场表达式"),
+                                               tr("表达式（分量标签如 S11、U2；函数 sqrt abs exp log sin cos tan min max pow）:"),
+                                               QLineEdit::Normal, m_lastExpression, &ok).trimmed();
+    if (!ok || text.isEmpty()) return;
+    m_lastExpression = text;
+
+    tracing::Span span("evaluateExpression", "render");
+    std::string error;
+    FieldExpression expression;
+    if (!FieldExpression::compile(text.toStdString(), expression, &error)) {
+        QMessageBox::warning(this, tr("Warning"), tr("表达式错误: %1").arg(QString::fromStdString(error)));
+        return;
+    }
+    // 变量在当前帧已读取的字段中查找
+    std::vector<std::shared_ptr<const FieldData>> fields;
+    for (const std::string& name : m_odb->getLoadedFieldNames()) {
+        if (auto fd = m_odb->shareFieldData(name)) {
+            fields.push_back(std::move(fd));
+        }
+    }
+    const std::string arrayName = text.toStdString();
+    if (!m_gridBuilder->addFieldExpression(arrayName, expression, fields, &error)) {
+        QMessageBox::warning(this, tr("Warning"),
+                             tr("表达式求值失败: %1（变量须来自当前帧已加载的字段）").arg(QString::fromStdString(error)));
+        return;
+    }
+
+    // 单元场有节点平均结果时显示平滑云图
+    vtkUnstructuredGrid* grid = m_gridBuilder->getGrid();
+    const bool usePointData = grid->GetPointData()->HasArray(arrayName.c_str());
+    m_vtkDisplay.displayWithScalarField(grid, arrayName, usePointData);
+    {
+        tracing::Span renderSpan("render", "render");
+        m_vtkDisplay.getRenderWindow()->Render();
+    }
+    ui->statusBar->showMessage(tr("显示表达式: %1").arg(text), 3000);
+}
+
 void MainWindow::saveFile()
 {
     if (!m_odb) {
@@ -252,3 +614,37 @@ void MainWindow::saveFile()
         return;
     }
 }
+
+void MainWindow::exportPartitioned()
+{
+    if (!m_odb) {
+        QMessageBox::warning(this, tr("Warning"), tr("No ODB file is loaded."));
+        return;
+    }
+
+    QString defaultFull = QString::fromStdString(m_odb->getOdbPath()) + "/"
+        + QString::fromStdString(m_odb->getOdbBaseName()) + ".pvtu";
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Partitioned VTU"), defaultFull,
+        tr("Parallel VTK Unstructured Grid (*.pvtu)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // 导出当前选中的帧的全部场，积分点汇总方式与显示一致
+    PartitionedExportOptions options;
+    options.stepName = m_selectedStepFrame.stepName;
+    options.frameIndex = options.stepName.empty() ? -1 : m_selectedStepFrame.frameIndex;
+    options.reduction = m_odb->integrationPointReduction();
+    options.selectedPoint = m_odb->selectedIntegrationPoint();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    PartitionedExportSummary summary;
+    const bool ok = m_odb->exportPartitioned(fileName.toStdString(), options, &summary);
+    QApplication::restoreOverrideCursor();
+
+    if (!ok) {
+        QMessageBox::critical(this, tr("Error"), tr("Failed to export partitioned VTU:\n%1").arg(fileName));
+        return;
+    }
+    ui->statusBar->showMessage(tr("Exported %1 pieces: %2").arg(summary.pieceCount).arg(fileName), 5000);
+}
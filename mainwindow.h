@@ -7,10 +7,13 @@
 #include <QVTKOpenGLNativeWidget.h>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QDoubleSpinBox>
 #include <map>
 #include <memory>
 #include "vtkdisplay.h"
-#include "odbmanager.h"
+#include "resultsource.h"
+#include "odbloader.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -30,18 +33,41 @@ public:
 private slots:
 	void openFile();
     void saveFile();
+    void exportPartitioned();
     void onTreeItemActivated(const QModelIndex& index);
+    void onTreeItemExpanded(const QModelIndex& index);
+    void onReductionChanged(QAction* action);
+    void evaluateExpression();
+    void onDeformationScaleChanged(double scale);
+    void onLoadProgress(const QString& phase, qint64 done, qint64 total);
+    void onOdbLoaded(const QString& fileName);
+    void onLoadFinished();
 
 private:
     void buildModelTree();
+    void appendFramePage(QStandardItem* moreItem);
+    bool firstStepFrame(StepFrameInfo& info) const;
+    bool displayField(const std::shared_ptr<const FieldData>& field, const QString& fieldName);
+    bool legendRange(const ChannelStats* stats, double range[2]) const;
+    void setLoading(bool loading);
+    // 按当前积分点设置重新读取当前帧最近显示的场并刷新
+    bool reloadCurrentField();
+    // 按变形比例更新网格坐标；reload 时在所选帧与已用位移场的帧不同时读取 U，否则只在尚无位移场时读取
+    void updateDeformation(bool reload);
 
 private:
     Ui::MainWindow *ui;
 
 	VTKDisplayManager m_vtkDisplay;
-	std::unique_ptr<readOdb> m_odb;
+	std::unique_ptr<ResultSource> m_odb;
     std::unique_ptr<CreateVTKUnstucturedGrid> m_gridBuilder;
     StepFrameInfo m_selectedStepFrame;
+    StepFrameInfo m_deformationFrame; // 网格当前变形所用位移场的帧
+    QString m_lastFieldName; // 最近显示的场，切换帧时据此预取
+    QString m_lastExpression;
     QStandardItemModel* m_treeModel{nullptr};
+    OdbLoader* m_loader{nullptr};
+    QProgressDialog* m_loadDialog{nullptr};
+    QDoubleSpinBox* m_deformationScale{nullptr};
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,214 @@
+#include "nodalaverager.h"
+#include "fieldstats.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 按节点切分的任务长度
+constexpr std::size_t kNodeChunkSize = 1 << 15;
+
+template <typename IndexT, typename Fn>
+void forEachElementNode(const std::vector<IndexT>& offsets, const std::vector<IndexT>& connectivity,
+                        std::size_t beginElement, std::size_t endElement, Fn&& fn)
+{
+    for (std::size_t e = beginElement; e < endElement; ++e) {
+        const IndexT end = offsets[e + 1];
+        for (IndexT j = offsets[e]; j < end; ++j) {
+            fn(e, static_cast<std::size_t>(connectivity[static_cast<std::size_t>(j)]));
+        }
+    }
+}
+
+} // namespace
+
+void NodalAverager::clear()
+{
+    m_elementCount = 0;
+    std::vector<std::size_t>().swap(m_offsets);
+    std::vector<std::uint32_t>().swap(m_elements);
+}
+
+void NodalAverager::build(const ElementConnectivity& connectivity, std::size_t nodeCount,
+                          const std::vector<InstanceInfo>& instances)
+{
+    clear();
+    const std::size_t elementCount = connectivity.elementCount();
+    if (elementCount >= kForeignInstance) {
+        ODB_LOG_WARNING("Too many elements for nodal averaging: " << elementCount);
+        return;
+    }
+
+    // 按实例遍历单元，以便判断节点是否属于该实例；无实例信息时视为同一区域
+    struct Range { std::size_t elementBegin, elementEnd, nodeBegin, nodeEnd; };
+    std::vector<Range> ranges;
+    for (const InstanceInfo& info : instances) {
+        ranges.push_back({info.elementStartIndex, std::min(elementCount, info.elementStartIndex + info.elementCount),
+                          info.nodeStartIndex, info.nodeStartIndex + info.nodeCount});
+    }
+    if (ranges.empty()) {
+        ranges.push_back({0, elementCount, 0, nodeCount});
+    }
+
+    // 退化单元可能重复引用同一节点，单元按升序处理，只需与该节点上一次记录的单元比较
+    std::vector<std::uint32_t> lastElement(nodeCount, std::numeric_limits<std::uint32_t>::max());
+    m_offsets.assign(nodeCount + 1, 0);
+    const auto countNode = [&](std::size_t e, std::size_t n) {
+        if (n < nodeCount && lastElement[n] != e) {
+            lastElement[n] = static_cast<std::uint32_t>(e);
+            ++m_offsets[n + 1];
+        }
+    };
+    for (const Range& r : ranges) {
+        if (connectivity.wideIndex) {
+            forEachElementNode(*connectivity.offsets64, *connectivity.connectivity64, r.elementBegin, r.elementEnd, countNode);
+        } else {
+            forEachElementNode(*connectivity.offsets32, *connectivity.connectivity32, r.elementBegin, r.elementEnd, countNode);
+        }
+    }
+    for (std::size_t n = 0; n < nodeCount; ++n) {
+        m_offsets[n + 1] += m_offsets[n];
+    }
+
+    m_elements.resize(m_offsets[nodeCount]);
+    std::vector<std::size_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    std::fill(lastElement.begin(), lastElement.end(), std::numeric_limits<std::uint32_t>::max());
+    for (const Range& r : ranges) {
+        const auto fillNode = [&](std::size_t e, std::size_t n) {
+            if (n < nodeCount && lastElement[n] != e) {
+                lastElement[n] = static_cast<std::uint32_t>(e);
+                const bool foreign = n < r.nodeBegin || n >= r.nodeEnd;
+                m_elements[cursor[n]++] = static_cast<std::uint32_t>(e) | (foreign ? kForeignInstance : 0u);
+            }
+        };
+        if (connectivity.wideIndex) {
+            forEachElementNode(*connectivity.offsets64, *connectivity.connectivity64, r.elementBegin, r.elementEnd, fillNode);
+        } else {
+            forEachElementNode(*connectivity.offsets32, *connectivity.connectivity32, r.elementBegin, r.elementEnd, fillNode);
+        }
+    }
+    m_elementCount = elementCount;
+
+    ODB_LOG_DEBUG("Built node-element adjacency: " << nodeCount << " nodes, "
+                  << m_elements.size() << " entries.");
+}
+
+bool NodalAverager::average(const FieldData& elementField, const NodalAveragingOptions& options, FieldData& nodalField,
+                            ThreadPool& pool)
+{
+    tracing::Span span("nodalAverage", "converter");
+    if (!isBuilt() || elementField.isNodal || elementField.isPacked()) {
+        return false;
+    }
+    if (!elementField.isSparse() && elementField.validFlags.size() != m_elementCount) {
+        return false;
+    }
+    const std::size_t nodeCount = m_offsets.size() - 1;
+    const std::size_t numComp = static_cast<std::size_t>(elementField.components);
+    const float* values = elementField.values.data();
+
+    // 稀疏单元场：临时建立单元到槽位的映射，邻接遍历时按槽位取值
+    constexpr std::uint32_t kNoSlot = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> slotOf;
+    if (elementField.isSparse()) {
+        slotOf.assign(m_elementCount, kNoSlot);
+        for (std::size_t slot = 0; slot < elementField.sparseIndices.size(); ++slot) {
+            if (elementField.sparseIndices[slot] < m_elementCount) {
+                slotOf[elementField.sparseIndices[slot]] = static_cast<std::uint32_t>(slot);
+            }
+        }
+    }
+    const auto elementValues = [&](std::size_t e) -> const float* {
+        if (!slotOf.empty()) {
+            return slotOf[e] == kNoSlot ? nullptr : values + static_cast<std::size_t>(slotOf[e]) * numComp;
+        }
+        return elementField.validFlags[e] ? values + e * numComp : nullptr;
+    };
+
+    nodalField.type = elementField.type;
+    nodalField.name = elementField.name;
+    nodalField.description = elementField.description;
+    nodalField.componentLabels = elementField.componentLabels;
+    nodalField.components = elementField.components;
+    nodalField.unit = elementField.unit;
+    nodalField.isNodal = true;
+    nodalField.integrationPoints.reset();
+    nodalField.values.assign(nodeCount * numComp, 0.0f);
+    nodalField.validFlags.assign(nodeCount, 0);
+
+    // 阈值以全场各分量的取值范围为基准
+    const bool useThreshold = options.threshold < 1.0f;
+    std::vector<float> tolerance(numComp, std::numeric_limits<float>::max());
+    if (useThreshold) {
+        const std::size_t chunks = (m_elementCount + kNodeChunkSize - 1) / kNodeChunkSize;
+        std::vector<float> lo(chunks * numComp, std::numeric_limits<float>::max());
+        std::vector<float> hi(chunks * numComp, std::numeric_limits<float>::lowest());
+        pool.parallelFor(chunks, [&](std::size_t t) {
+            const std::size_t end = std::min(m_elementCount, (t + 1) * kNodeChunkSize);
+            for (std::size_t e = t * kNodeChunkSize; e < end; ++e) {
+                const float* v = elementValues(e);
+                if (!v) continue;
+                for (std::size_t c = 0; c < numComp; ++c) {
+                    lo[t * numComp + c] = std::min(lo[t * numComp + c], v[c]);
+                    hi[t * numComp + c] = std::max(hi[t * numComp + c], v[c]);
+                }
+            }
+        });
+        for (std::size_t c = 0; c < numComp; ++c) {
+            float fieldLo = std::numeric_limits<float>::max();
+            float fieldHi = std::numeric_limits<float>::lowest();
+            for (std::size_t t = 0; t < chunks; ++t) {
+                fieldLo = std::min(fieldLo, lo[t * numComp + c]);
+                fieldHi = std::max(fieldHi, hi[t * numComp + c]);
+            }
+            tolerance[c] = fieldHi >= fieldLo ? std::max(0.0f, options.threshold) * (fieldHi - fieldLo) : 0.0f;
+        }
+    }
+
+    // 统计量与平均结果同一遍得到，色标范围与显示的节点值一致
+    FieldStatsAccumulator stats(elementField.components, nodeCount);
+    const std::size_t chunks = (nodeCount + kNodeChunkSize - 1) / kNodeChunkSize;
+    pool.parallelFor(chunks, [&](std::size_t t) {
+        FieldStatsAccumulator::Partial partial = stats.makePartial();
+        std::vector<double> sum(numComp);
+        std::vector<float> lo(numComp), hi(numComp), peak(numComp);
+        const std::size_t endNode = std::min(nodeCount, (t + 1) * kNodeChunkSize);
+        for (std::size_t n = t * kNodeChunkSize; n < endNode; ++n) {
+            std::fill(sum.begin(), sum.end(), 0.0);
+            std::size_t count = 0;
+            for (std::size_t j = m_offsets[n]; j < m_offsets[n + 1]; ++j) {
+                const std::uint32_t entry = m_elements[j];
+                if (options.perInstance && (entry & kForeignInstance)) continue;
+                const float* v = elementValues(entry & ~kForeignInstance);
+                if (!v) continue;
+                for (std::size_t c = 0; c < numComp; ++c) {
+                    sum[c] += v[c];
+                    if (!useThreshold) continue;
+                    if (count == 0) {
+                        lo[c] = hi[c] = peak[c] = v[c];
+                    } else {
+                        lo[c] = std::min(lo[c], v[c]);
+                        hi[c] = std::max(hi[c], v[c]);
+                        if (std::fabs(v[c]) > std::fabs(peak[c])) peak[c] = v[c];
+                    }
+                }
+                ++count;
+            }
+            if (count == 0) continue;
+
+            float* dst = nodalField.values.data() + n * numComp;
+            for (std::size_t c = 0; c < numComp; ++c) {
+                const bool averaged = !useThreshold || hi[c] - lo[c] <= tolerance[c];
+                dst[c] = averaged ? static_cast<float>(sum[c] / static_cast<double>(count)) : peak[c];
+            }
+            nodalField.validFlags[n] = 1;
+            stats.add(partial, n, dst);
+        }
+        stats.merge(partial);
+    });
+    nodalField.stats = stats.finish();
+    return true;
+}
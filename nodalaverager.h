@@ -0,0 +1,43 @@
+#ifndef NODALAVERAGER_H
+#define NODALAVERAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fielddata.h"
+#include "resultsource.h"
+#include "threadpool.h"
+
+struct NodalAveragingOptions {
+    bool perInstance{true}; // 只平均与节点属于同一实例的单元
+    // 节点处各单元值的差异超过 threshold × 全场范围时不平均，改取绝对值最大的单元值；>= 1 表示总是平均
+    float threshold{1.0f};
+};
+
+// 单元场到节点场的平均：节点→单元邻接表只构建一次，之后每个场按节点并行求平均
+// 每个节点只读取自身的邻接单元并写入自身结果，无需原子操作，结果与线程数无关
+class NodalAverager {
+public:
+    NodalAverager() = default;
+
+    void build(const ElementConnectivity& connectivity, std::size_t nodeCount,
+               const std::vector<InstanceInfo>& instances);
+    bool isBuilt() const { return !m_offsets.empty(); }
+    void clear();
+
+    // 由单元场生成同名节点场（isNodal = true，stats 为平均后的统计量），按节点分块在 pool 上并行；
+    // 邻接表未构建或单元数不一致时返回 false
+    bool average(const FieldData& elementField, const NodalAveragingOptions& options, FieldData& nodalField,
+                 ThreadPool& pool);
+
+private:
+    // 邻接单元编号的最高位标记“单元与节点不属于同一实例”
+    static constexpr std::uint32_t kForeignInstance = 1u << 31;
+
+    std::size_t m_elementCount{0};
+    std::vector<std::size_t> m_offsets;   // 长度为节点数 + 1
+    std::vector<std::uint32_t> m_elements; // 按节点分组的邻接单元编号（升序）
+};
+
+#endif // NODALAVERAGER_H
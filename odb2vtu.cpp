@@ -0,0 +1,628 @@
+// odb2vtu：命令行批量转换工具，不依赖 Qt
+// 每个 .odb 按所选分析步 / 帧 / 场导出为 .vtu（或分块 .pvtu），多个文件由有上限的子进程池并行转换，
+// 结束时输出逐文件的耗时与吞吐汇总
+#include "odbmanager.h"
+#include "creategrid.h"
+#include "partitionedwriter.h"
+#include "threadpool.h"
+#include "tracing.h"
+#include "allocationcounter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CliOptions {
+    std::vector<std::string> files;
+    std::string outputDir;               // 空则与 .odb 同目录
+    std::string stepName;                // 空则取最后一个分析步
+    std::string frames{"last"};          // last | first | all | 逗号分隔的 frameId
+    std::vector<std::string> fields{"U", "S"};
+    int jobs{0};                         // 同时转换的文件数，0 为自动
+    int threads{0};                      // 每个文件的提取线程数，0 为自动
+    std::size_t pieceElements{0};        // 非 0 时流式分块输出 .pvtu
+    bool useGeometryCache{true};
+    bool nodalAverage{false};            // 单元场另输出同名的节点平均点数组
+    std::string ipReduction{"centroid"};  // 单元场积分点汇总方式，提取时直接汇总，不保留积分点
+    IPReduction reduction{IPReduction::CENTROID};
+    int selectedPoint{0};
+    std::string workerResult;            // 子进程模式：单文件转换，结果写入该文件
+    std::string logLevel;                // 空则沿用 ODBVIEWER_LOG_LEVEL / 默认 info
+    std::string traceFile;               // 非空时记录计时事件并写出 Chrome trace JSON
+    std::string invariants;              // 应力导出量列表，空则只输出 VonMises
+    StressInvariantOptions stressInvariants;
+    std::vector<std::string> expressions; // --expression 原文 NAME=EXPR，转发给子进程
+    std::vector<std::pair<std::string, FieldExpression>> compiledExpressions;
+};
+
+struct FileResult {
+    std::string file;
+    bool ok{false};
+    std::string message;
+    std::size_t frames{0};
+    std::size_t nodes{0};
+    std::size_t elements{0};
+    std::uintmax_t bytesWritten{0};
+    double seconds{0.0};
+};
+
+void printUsage()
+{
+    std::cout <<
+        "Usage: odb2vtu [options] <file.odb> [file.odb ...]\n"
+        "  -o, --output DIR          output directory (default: next to each .odb)\n"
+        "  -s, --step NAME           step to export (default: last step)\n"
+        "  -f, --frames SPEC         last | first | all | comma separated frame ids (default: last)\n"
+        "  -F, --fields LIST         comma separated field names (default: U,S)\n"
+        "  -j, --jobs N              files converted concurrently (default: min(files, cores))\n"
+        "  -t, --threads N           extraction threads per file (default: cores / jobs)\n"
+        "      --partitioned N       stream instance by instance into .pvtu, at most N elements per piece\n"
+        "      --no-geometry-cache   do not read or write *.odb.geomcache\n"
+        "      --nodal-average       also write element fields averaged to nodes as point arrays\n"
+        "                            (whole-model conversion only)\n"
+        "      --ip-reduction MODE   element integration points: centroid | max | first | point:N\n"
+        "                            (1-based point number; default: centroid)\n"
+        "      --invariants LIST     stress quantities: mises,principal,directions,tresca,pressure,\n"
+        "                            triaxiality,all (default: mises; whole-model conversion only)\n"
+        "      --expression NAME=EXPR\n"
+        "                            add array NAME computed from all fields exported in the same frame\n"
+        "                            (-F), e.g. \"SD=S11-S22\"; repeatable (whole-model conversion only)\n"
+        "      --log-level LEVEL     error | warning | info | debug (default: info)\n"
+        "      --trace FILE          write a Chrome trace-event JSON; each worker writes FILE_<n>.json\n";
+}
+
+std::vector<std::string> splitList(const std::string& text)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// 解析 --ip-reduction：centroid | max | first | point:N（N 从 1 开始）
+bool parseReduction(const std::string& text, IPReduction& mode, int& selectedPoint)
+{
+    selectedPoint = 0;
+    if (text == "centroid") mode = IPReduction::CENTROID;
+    else if (text == "max") mode = IPReduction::MAXIMUM;
+    else if (text == "first") mode = IPReduction::FIRST_POINT;
+    else if (text.rfind("point:", 0) == 0) {
+        const int point = std::atoi(text.c_str() + 6);
+        if (point < 1) return false;
+        mode = IPReduction::SELECTED_POINT;
+        selectedPoint = point - 1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 解析 --invariants 的逗号分隔列表，列表给出完整集合（未列出的量不输出）
+bool parseInvariants(const std::string& text, StressInvariantOptions& options)
+{
+    options = StressInvariantOptions();
+    options.mises = false;
+    for (const std::string& item : splitList(text)) {
+        if (item == "mises") options.mises = true;
+        else if (item == "principal") options.principals = true;
+        else if (item == "directions") options.directions = true;
+        else if (item == "tresca") options.tresca = true;
+        else if (item == "pressure") options.pressure = true;
+        else if (item == "triaxiality") options.triaxiality = true;
+        else if (item == "all") options = {true, true, true, true, true, true};
+        else return false;
+    }
+    return true;
+}
+
+bool parseArguments(int argc, char* argv[], CliOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) {
+                std::cerr << "[Error] Missing value for " << arg << std::endl;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            std::exit(0);
+        } else if (arg == "-o" || arg == "--output") {
+            if (!value(options.outputDir)) return false;
+        } else if (arg == "-s" || arg == "--step") {
+            if (!value(options.stepName)) return false;
+        } else if (arg == "-f" || arg == "--frames") {
+            if (!value(options.frames)) return false;
+        } else if (arg == "-F" || arg == "--fields") {
+            if (!value(v)) return false;
+            options.fields = splitList(v);
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (!value(v)) return false;
+            options.jobs = std::max(0, std::atoi(v.c_str()));
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!value(v)) return false;
+            options.threads = std::max(0, std::atoi(v.c_str()));
+        } else if (arg == "--partitioned") {
+            if (!value(v)) return false;
+            options.pieceElements = static_cast<std::size_t>(std::max(1LL, std::atoll(v.c_str())));
+        } else if (arg == "--no-geometry-cache") {
+            options.useGeometryCache = false;
+        } else if (arg == "--nodal-average") {
+            options.nodalAverage = true;
+        } else if (arg == "--ip-reduction") {
+            if (!value(options.ipReduction)) return false;
+            if (!parseReduction(options.ipReduction, options.reduction, options.selectedPoint)) {
+                std::cerr << "[Error] Unknown integration point reduction: " << options.ipReduction << std::endl;
+                return false;
+            }
+        } else if (arg == "--invariants") {
+            if (!value(options.invariants)) return false;
+            if (!parseInvariants(options.invariants, options.stressInvariants)) {
+                std::cerr << "[Error] Unknown stress invariant in: " << options.invariants << std::endl;
+                return false;
+            }
+        } else if (arg == "--expression") {
+            if (!value(v)) return false;
+            const std::size_t eq = v.find('=');
+            FieldExpression expression;
+            std::string error;
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "[Error] Expected NAME=EXPR for --expression: " << v << std::endl;
+                return false;
+            }
+            if (!FieldExpression::compile(v.substr(eq + 1), expression, &error)) {
+                std::cerr << "[Error] Invalid expression '" << v.substr(eq + 1) << "': " << error << std::endl;
+                return false;
+            }
+            options.expressions.push_back(v);
+            options.compiledExpressions.emplace_back(v.substr(0, eq), std::move(expression));
+        } else if (arg == "--worker-result") {
+            if (!value(options.workerResult)) return false;
+        } else if (arg == "--log-level") {
+            if (!value(options.logLevel)) return false;
+            LogLevel level;
+            if (!tracing::parseLogLevel(options.logLevel, level)) {
+                std::cerr << "[Error] Unknown log level: " << options.logLevel << std::endl;
+                return false;
+            }
+            tracing::setLogLevel(level);
+        } else if (arg == "--trace") {
+            if (!value(options.traceFile)) return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "[Error] Unknown option: " << arg << std::endl;
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    return !options.files.empty();
+}
+
+// 按 --frames 选出要导出的帧；idAt(pos) 返回步内第 pos 帧的 frameId
+std::vector<int> selectFrames(const std::string& spec, int frameCount, const std::function<int(int)>& idAt)
+{
+    std::vector<int> ids;
+    if (frameCount <= 0) return ids;
+    if (spec == "last") {
+        ids.push_back(idAt(frameCount - 1));
+    } else if (spec == "first") {
+        ids.push_back(idAt(0));
+    } else if (spec == "all") {
+        for (int pos = 0; pos < frameCount; ++pos) ids.push_back(idAt(pos));
+    } else {
+        for (const std::string& item : splitList(spec)) ids.push_back(std::atoi(item.c_str()));
+    }
+    return ids;
+}
+
+std::string sanitize(const std::string& name)
+{
+    std::string out = name;
+    for (char& c : out) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') c = '_';
+    }
+    return out;
+}
+
+fs::path outputDirFor(const std::string& odbFile, const CliOptions& options)
+{
+    return options.outputDir.empty() ? fs::u8path(odbFile).parent_path() : fs::u8path(options.outputDir);
+}
+
+std::uintmax_t fileSize(const fs::path& path)
+{
+    std::error_code ec;
+    const std::uintmax_t size = fs::file_size(path, ec);
+    return ec ? 0 : size;
+}
+
+// 整模型转换：几何只构建一次，逐帧替换场数组后写出
+void convertWhole(const std::string& file, const CliOptions& options, FileResult& result)
+{
+    readOdb odb(file.c_str(), options.useGeometryCache);
+    odb.setPrefetchDepth(0);
+    odb.setFieldCacheBudget(0);
+    odb.setExtractionThreads(options.threads);
+    // 每个场只写出一次，不保留积分点，提取时直接汇总
+    odb.setIntegrationPointReduction(std::string(), options.reduction, options.selectedPoint);
+
+    std::string stepName = options.stepName;
+    if (stepName.empty()) {
+        const auto steps = odb.getStepNames();
+        if (!steps.empty()) stepName = steps.back();
+    }
+    const std::vector<int> frameIds = selectFrames(options.frames, odb.getFrameCount(stepName), [&](int pos) {
+        StepFrameInfo info;
+        odb.getFrameInfo(stepName, pos, info);
+        return info.frameIndex;
+    });
+    if (frameIds.empty()) {
+        throw std::runtime_error("no frames selected in step '" + stepName + "'");
+    }
+
+    CreateVTKUnstucturedGrid grid(odb);
+    grid.setStressInvariants(options.stressInvariants);
+    grid.setNodalAveraging(options.nodalAverage);
+    grid.setThreads(options.threads);
+    odb.releaseGeometryCache();
+    result.nodes = odb.m_nodesNum;
+    result.elements = odb.m_elementsNum;
+
+    const fs::path outDir = outputDirFor(file, options);
+    const std::string base = fs::u8path(file).stem().u8string();
+    for (int frameId : frameIds) {
+        // readSingleField 只保留本次读取的场，表达式的变量从这里收集的本帧各场中查找
+        std::vector<std::shared_ptr<const FieldData>> frameFields;
+        for (const std::string& fieldName : options.fields) {
+            if (!odb.isFieldInFrame(stepName, frameId, fieldName)) {
+                ODB_LOG_WARNING("Field '" << fieldName << "' not in " << stepName << " frame " << frameId);
+                continue;
+            }
+            if (!odb.readSingleField(stepName, frameId, fieldName)) continue;
+            const std::shared_ptr<const FieldData> fd = odb.shareFieldData(fieldName);
+            if (!fd) continue;
+            frameFields.push_back(fd);
+            // 多帧共用同一几何，位移只作为数组输出，不叠加到坐标上
+            if (fd->type == FieldType::DISPLACEMENT) {
+                grid.addDisplacementField(fd, 0.0);
+            } else if (fd->type == FieldType::STRESS) {
+                grid.addStressField(fd);
+            } else {
+                grid.addFieldData(fd);
+            }
+        }
+        if (!options.compiledExpressions.empty()) {
+            for (const auto& named : options.compiledExpressions) {
+                std::string error;
+                if (!grid.addFieldExpression(named.first, named.second, frameFields, &error)) {
+                    ODB_LOG_WARNING("Expression '" << named.first << "' skipped in frame " << frameId << ": " << error);
+                }
+            }
+        }
+        const fs::path outFile = outDir / fs::u8path(base + "_" + sanitize(stepName) + "_" + std::to_string(frameId) + ".vtu");
+        if (!grid.writeToFile(outFile.u8string())) {
+            throw std::runtime_error("failed to write " + outFile.u8string());
+        }
+        result.bytesWritten += fileSize(outFile);
+        ++result.frames;
+    }
+}
+
+// 分块转换：不构建整模型，直接从 ODB 逐实例写出 .pvtu
+void convertPartitioned(const std::string& file, const CliOptions& options, FileResult& result)
+{
+    odb_initializeAPI();
+    odb_Odb& odb = openOdb(file.c_str(), true);
+    try {
+        std::string stepName = options.stepName;
+        if (stepName.empty()) {
+            odb_StepRepositoryIT stepIter(odb.steps());
+            for (stepIter.first(); !stepIter.isDone(); stepIter.next()) {
+                stepName = stepIter.currentKey().CStr();
+            }
+        }
+        const odb_String stepKey(stepName.c_str());
+        if (!odb.steps().isMember(stepKey)) {
+            throw std::runtime_error("step '" + stepName + "' not found");
+        }
+        const odb_SequenceFrame& frames = odb.steps().constGet(stepKey).frames();
+        const std::vector<int> frameIds = selectFrames(options.frames, frames.size(),
+                                                       [&](int pos) { return frames[pos].frameId(); });
+
+        const fs::path outDir = outputDirFor(file, options);
+        const std::string base = fs::u8path(file).stem().u8string();
+        PartitionedVtuWriter writer(odb);
+        for (int frameId : frameIds) {
+            PartitionedExportOptions exportOptions;
+            exportOptions.stepName = stepName;
+            exportOptions.frameIndex = frameId;
+            exportOptions.fieldNames = options.fields;
+            exportOptions.maxElementsPerPiece = options.pieceElements;
+            exportOptions.reduction = options.reduction;
+            exportOptions.selectedPoint = options.selectedPoint;
+
+            const fs::path pvtu = outDir / fs::u8path(base + "_" + sanitize(stepName) + "_" + std::to_string(frameId) + ".pvtu");
+            PartitionedExportSummary summary;
+            if (!writer.write(pvtu.u8string(), exportOptions, &summary)) {
+                throw std::runtime_error("failed to write " + pvtu.u8string());
+            }
+            result.bytesWritten += fileSize(pvtu);
+            for (const std::string& piece : summary.pieceFiles) {
+                result.bytesWritten += fileSize(pvtu.parent_path() / fs::u8path(piece));
+            }
+            result.nodes = summary.nodeCount;
+            result.elements = summary.elementCount;
+            ++result.frames;
+        }
+    }
+    catch (...) {
+        odb.close();
+        throw;
+    }
+    odb.close();
+}
+
+FileResult convertFile(const std::string& file, const CliOptions& options)
+{
+    tracing::Span span("convertFile", "converter");
+    FileResult result;
+    result.file = file;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        std::error_code ec;
+        fs::create_directories(outputDirFor(file, options), ec);
+        if (options.pieceElements > 0) {
+            convertPartitioned(file, options, result);
+        } else {
+            convertWhole(file, options, result);
+        }
+        result.ok = true;
+    }
+    catch (const std::exception& e) {
+        result.message = e.what();
+        ODB_LOG_ERROR(file << ": " << e.what());
+    }
+    catch (...) {
+        // ODB API 的异常（odb_BaseException）不派生自 std::exception，同样只记为该文件失败
+        result.message = "unknown exception";
+        ODB_LOG_ERROR(file << ": unknown exception");
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    span.arg("frames", result.frames);
+    span.arg("elements", result.elements);
+    span.arg("bytesWritten", result.bytesWritten);
+    return result;
+}
+
+bool writeResult(const std::string& path, const FileResult& result)
+{
+    std::ofstream out(fs::u8path(path), std::ios::out | std::ios::trunc);
+    out << "ok=" << (result.ok ? 1 : 0) << "\n"
+        << "frames=" << result.frames << "\n"
+        << "nodes=" << result.nodes << "\n"
+        << "elements=" << result.elements << "\n"
+        << "bytes=" << result.bytesWritten << "\n"
+        << "seconds=" << result.seconds << "\n"
+        << "message=" << result.message << "\n";
+    return static_cast<bool>(out);
+}
+
+bool readResult(const std::string& path, FileResult& result)
+{
+    std::ifstream in(fs::u8path(path));
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string key = line.substr(0, eq);
+        const std::string value = line.substr(eq + 1);
+        if (key == "ok") result.ok = value == "1";
+        else if (key == "frames") result.frames = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "nodes") result.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "elements") result.elements = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "bytes") result.bytesWritten = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "seconds") result.seconds = std::atof(value.c_str());
+        else if (key == "message") result.message = value;
+    }
+    return true;
+}
+
+std::string quoteArgument(const std::string& arg)
+{
+    std::string quoted = "\"";
+    for (char c : arg) {
+        if (c == '"') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// ODB API 不保证线程安全，多个文件并行时每个文件在独立子进程中转换
+FileResult convertInChild(const std::string& exe, const std::string& file, const CliOptions& options, std::size_t index)
+{
+    tracing::Span span("convertInChild", "converter");
+    FileResult result;
+    result.file = file;
+
+    std::random_device rd;
+    const fs::path resultFile = fs::temp_directory_path() /
+        ("odb2vtu_" + std::to_string(rd()) + "_" + std::to_string(index) + ".result");
+    const fs::path logFile = outputDirFor(file, options) / fs::u8path(fs::u8path(file).stem().u8string() + ".odb2vtu.log");
+    std::error_code ec;
+    fs::create_directories(logFile.parent_path(), ec);
+
+    std::string command = quoteArgument(exe);
+    if (!options.outputDir.empty()) command += " -o " + quoteArgument(options.outputDir);
+    if (!options.stepName.empty()) command += " -s " + quoteArgument(options.stepName);
+    command += " -f " + quoteArgument(options.frames);
+    std::string fields;
+    for (const std::string& f : options.fields) fields += (fields.empty() ? "" : ",") + f;
+    command += " -F " + quoteArgument(fields);
+    command += " -t " + std::to_string(options.threads);
+    if (options.pieceElements > 0) command += " --partitioned " + std::to_string(options.pieceElements);
+    if (!options.useGeometryCache) command += " --no-geometry-cache";
+    command += " --ip-reduction " + quoteArgument(options.ipReduction);
+    if (options.nodalAverage) command += " --nodal-average";
+    if (!options.invariants.empty()) command += " --invariants " + quoteArgument(options.invariants);
+    for (const std::string& e : options.expressions) command += " --expression " + quoteArgument(e);
+    if (!options.logLevel.empty()) command += " --log-level " + options.logLevel;
+    if (!options.traceFile.empty()) {
+        const fs::path trace = fs::u8path(options.traceFile);
+        const fs::path workerTrace = trace.parent_path() /
+            fs::u8path(trace.stem().u8string() + "_" + std::to_string(index) + trace.extension().u8string());
+        command += " --trace " + quoteArgument(workerTrace.u8string());
+    }
+    command += " --worker-result " + quoteArgument(resultFile.u8string());
+    command += " " + quoteArgument(file);
+    command += " > " + quoteArgument(logFile.u8string()) + " 2>&1";
+#ifdef _WIN32
+    command = "\"" + command + "\""; // cmd /c 会去掉最外层引号
+#endif
+
+    const auto start = std::chrono::steady_clock::now();
+    const int rc = std::system(command.c_str());
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!readResult(resultFile.u8string(), result)) {
+        result.ok = false;
+        result.message = "worker exited with code " + std::to_string(rc) + ", see " + logFile.u8string();
+    }
+    result.file = file;
+    result.seconds = elapsed; // 包含子进程启动与 ODB 打开的完整耗时
+    fs::remove(resultFile, ec);
+    return result;
+}
+
+// 启动子进程本身失败（临时目录、内存等）时只记为该文件失败，其余文件继续转换
+FileResult convertInChildSafe(const std::string& exe, const std::string& file, const CliOptions& options,
+                              std::size_t index)
+{
+    std::string message;
+    try {
+        return convertInChild(exe, file, options, index);
+    }
+    catch (const std::exception& e) {
+        message = e.what();
+    }
+    catch (...) {
+        message = "unknown exception";
+    }
+    ODB_LOG_ERROR(file << ": " << message);
+    FileResult result;
+    result.file = file;
+    result.message = message;
+    return result;
+}
+
+void printSummary(const std::vector<FileResult>& results, double wallSeconds)
+{
+    std::cout << "\n" << std::left << std::setw(40) << "File" << std::right
+              << std::setw(7) << "Status" << std::setw(8) << "Frames" << std::setw(12) << "Elements"
+              << std::setw(10) << "Time(s)" << std::setw(10) << "MB/s" << std::setw(14) << "Elem-frm/s" << "\n";
+    std::size_t failures = 0;
+    std::uintmax_t totalBytes = 0;
+    for (const FileResult& r : results) {
+        const double mb = static_cast<double>(r.bytesWritten) / (1024.0 * 1024.0);
+        const double rate = r.seconds > 0 ? mb / r.seconds : 0.0;
+        const double elementRate = r.seconds > 0 ? static_cast<double>(r.elements * r.frames) / r.seconds : 0.0;
+        std::string name = fs::u8path(r.file).filename().u8string();
+        if (name.size() > 39) name = name.substr(0, 36) + "...";
+        std::cout << std::left << std::setw(40) << name << std::right
+                  << std::setw(7) << (r.ok ? "ok" : "FAIL") << std::setw(8) << r.frames
+                  << std::setw(12) << r.elements << std::setw(10) << std::fixed << std::setprecision(2) << r.seconds
+                  << std::setw(10) << std::setprecision(1) << rate << std::setw(14) << std::setprecision(0) << elementRate
+                  << "\n";
+        if (!r.ok) {
+            ++failures;
+            std::cout << "    " << r.message << "\n";
+        }
+        totalBytes += r.bytesWritten;
+    }
+    std::cout << std::setprecision(2) << "\n[Info] " << results.size() - failures << " / " << results.size()
+              << " files converted in " << wallSeconds << " s, "
+              << static_cast<double>(totalBytes) / (1024.0 * 1024.0) << " MiB written." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    CliOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+    tracing::setAllocationCounter(allocatedBytes);
+    if (!options.traceFile.empty()) {
+        tracing::setEnabled(true);
+    }
+
+    // 子进程模式：只转换一个文件并把结果写回给父进程
+    if (!options.workerResult.empty()) {
+        const FileResult result = convertFile(options.files.front(), options);
+        const bool written = writeResult(options.workerResult, result);
+        if (!written) {
+            ODB_LOG_ERROR("Cannot write worker result " << options.workerResult);
+        }
+        if (!options.traceFile.empty()) {
+            tracing::writeChromeTrace(options.traceFile);
+        }
+        return result.ok && written ? 0 : 1;
+    }
+
+    const unsigned cores = ThreadPool::resolveThreadCount(0);
+    const std::size_t fileCount = options.files.size();
+    const unsigned jobs = static_cast<unsigned>(std::min<std::size_t>(
+        fileCount, options.jobs > 0 ? static_cast<unsigned>(options.jobs) : cores));
+    if (options.threads == 0) {
+        options.threads = static_cast<int>(std::max(1u, cores / std::max(1u, jobs)));
+    }
+    std::cout << "[Info] Converting " << fileCount << " files with " << jobs << " jobs, "
+              << options.threads << " extraction threads each." << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<FileResult> results(fileCount);
+    if (jobs <= 1) {
+        for (std::size_t i = 0; i < fileCount; ++i) {
+            results[i] = convertFile(options.files[i], options);
+        }
+    } else {
+        // 每个线程（含调用线程）同一时刻只等待一个子进程，并发子进程数即为 jobs
+        ThreadPool pool(jobs - 1);
+        const std::string exe = argv[0];
+        pool.parallelFor(fileCount, [&](std::size_t i) {
+            results[i] = convertInChildSafe(exe, options.files[i], options, i);
+        });
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printSummary(results, wall);
+    if (!options.traceFile.empty()) {
+        tracing::writeChromeTrace(options.traceFile);
+    }
+    const bool allOk = std::all_of(results.begin(), results.end(), [](const FileResult& r) { return r.ok; });
+    return allOk ? 0 : 1;
+}
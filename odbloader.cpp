@@ -0,0 +1,116 @@
+#include "odbloader.h"
+#include "syntheticsource.h"
+#include "tracing.h"
+#ifdef ODBVIEWER_WITH_ABAQUS
+#include "odbmanager.h"
+#endif
+
+OdbLoader::OdbLoader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+OdbLoader::~OdbLoader()
+{
+    // 窗口关闭时任务可能仍在运行，取消并等待其释放 ODB
+    cancel();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+bool OdbLoader::start(const QString& fileName)
+{
+    if (m_running.load()) {
+        return false;
+    }
+    if (m_worker.joinable()) {
+        m_worker.join(); // 上一个任务已结束，回收线程
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_resultMutex);
+        m_gridBuilder.reset();
+        m_odb.reset();
+    }
+    m_cancel.store(false);
+    m_running.store(true);
+    m_worker = std::thread([this, fileName]() { run(fileName); });
+    return true;
+}
+
+void OdbLoader::cancel()
+{
+    m_cancel.store(true);
+}
+
+std::unique_ptr<ResultSource> OdbLoader::takeOdb()
+{
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    return std::move(m_odb);
+}
+
+std::unique_ptr<CreateVTKUnstucturedGrid> OdbLoader::takeGridBuilder()
+{
+    std::lock_guard<std::mutex> lock(m_resultMutex);
+    return std::move(m_gridBuilder);
+}
+
+void OdbLoader::run(const QString& fileName)
+{
+    tracing::Span span("loadResultFile", "reader");
+    auto progress = [this](const std::string& phase, std::size_t done, std::size_t total) {
+        emit progressChanged(QString::fromStdString(phase), static_cast<qint64>(done), static_cast<qint64>(total));
+        return !m_cancel.load();
+    };
+
+    // 局部对象按声明逆序析构：取消或失败时先释放网格，再关闭 ODB
+    std::unique_ptr<ResultSource> odb;
+    std::unique_ptr<CreateVTKUnstucturedGrid> gridBuilder;
+    try {
+        const std::string path = fileName.toStdString();
+        if (fileName.endsWith(".synth", Qt::CaseInsensitive)) {
+            SyntheticModelSpec spec;
+            std::string error;
+            if (!SyntheticModelSpec::loadFile(path, spec, &error)) {
+                throw std::runtime_error(error);
+            }
+            odb = std::make_unique<SyntheticSource>(spec, path, progress);
+        } else {
+#ifdef ODBVIEWER_WITH_ABAQUS
+            odb = std::make_unique<readOdb>(path.c_str(), true, progress);
+#else
+            throw std::runtime_error("This build has no Abaqus ODB support, only *.synth models can be opened");
+#endif
+        }
+
+        if (!progress("Building grid", 0, 1)) {
+            throw OdbLoadCancelled();
+        }
+        gridBuilder = std::make_unique<CreateVTKUnstucturedGrid>(*odb);
+        odb->releaseGeometryCache();
+        if (!progress("Building grid", 1, 1)) {
+            throw OdbLoadCancelled();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_resultMutex);
+            m_odb = std::move(odb);
+            m_gridBuilder = std::move(gridBuilder);
+        }
+        m_running.store(false);
+        emit loaded(fileName);
+    }
+    catch (const OdbLoadCancelled&) {
+        gridBuilder.reset();
+        odb.reset();
+        ODB_LOG_INFO("Loading cancelled: " << fileName.toStdString());
+        m_running.store(false);
+        emit cancelled();
+    }
+    catch (const std::exception& e) {
+        gridBuilder.reset();
+        odb.reset();
+        m_running.store(false);
+        emit failed(QString::fromLocal8Bit(e.what()));
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef ODBLOADER_H
+#define ODBLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "resultsource.h"
+#include "creategrid.h"
+
+// 后台打开 ODB：在工作线程中读取步与帧、逐实例几何并构建 VTK 网格，主线程保持响应
+// .synth 文件按其中的参数生成合成模型（SyntheticSource），不需要 Abaqus
+// 进度与结果通过信号投递到主线程；取消后工作线程丢弃已读取的部分数据并关闭 ODB
+class OdbLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit OdbLoader(QObject* parent = nullptr);
+    ~OdbLoader() override;
+
+    // 已有任务在运行时返回 false
+    bool start(const QString& fileName);
+    void cancel();
+    bool isRunning() const { return m_running.load(); }
+
+    // loaded 信号之后由主线程取走结果
+    std::unique_ptr<ResultSource> takeOdb();
+    std::unique_ptr<CreateVTKUnstucturedGrid> takeGridBuilder();
+
+signals:
+    void progressChanged(const QString& phase, qint64 done, qint64 total);
+    void loaded(const QString& fileName);
+    void failed(const QString& message);
+    void cancelled();
+
+private:
+    void run(const QString& fileName);
+
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{false};
+    std::atomic<bool> m_running{false};
+
+    std::mutex m_resultMutex;
+    std::unique_ptr<ResultSource> m_odb;
+    std::unique_ptr<CreateVTKUnstucturedGrid> m_gridBuilder;
+};
+
+#endif // ODBLOADER_H
@@ -1,33 +1,121 @@
 #include "odbmanager.h"
+#include "fieldcodec.h"
+#include "fieldkernels.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+// Abaqus 单元最多 27 个节点（C3D27），用于在加载前判断 32 位索引是否足够
+static constexpr std::size_t kMaxNodesPerElement = 27;
+
+// 并行提取：总量低于阈值时线程调度开销不划算；大数据块按该长度切分成多个任务
+static constexpr std::size_t kParallelExtractThreshold = 1 << 15;
+static constexpr int kExtractChunkSize = 1 << 16;
+static constexpr int kProgressMask = (1 << 16) - 1; // 几何读取每 65536 个实体报告一次进度
+static constexpr int kCancelCheckMask = (1 << 12) - 1; // 预取提取中每 4096 个实体检查一次取消
+
+// 作用域内让提取过程轮询取消标志；退出时（包括异常）恢复为空，之后的前台提取不会被预取的取消截断
+class ExtractCancelScope {
+public:
+    ExtractCancelScope(const std::atomic<bool>*& slot, const std::atomic<bool>& flag) : m_slot(slot)
+    {
+        m_slot = &flag;
+    }
+    ~ExtractCancelScope() { m_slot = nullptr; }
+    ExtractCancelScope(const ExtractCancelScope&) = delete;
+    ExtractCancelScope& operator=(const ExtractCancelScope&) = delete;
+
+private:
+    const std::atomic<bool>*& m_slot;
+};
 
-readOdb::readOdb(const char* odbFullname)
+readOdb::readOdb(const char* odbFullname, bool useGeometryCache, LoadProgressCallback progress)
+    : m_loadProgress(std::move(progress))
 {
+    tracing::Span span("openOdb", "reader");
     odb_initializeAPI();
     odb_String odbFile = odb_String(odbFullname);
     m_odbFullName = std::string(odbFullname);
     m_odbPath = m_odbFullName.substr(0, m_odbFullName.find_last_of("/\\"));
     m_odbBaseName = m_odbFullName.substr(m_odbFullName.find_last_of("/\\") + 1);
+    m_prefetcher.setLoader([this](const FieldCacheKey& key) { prefetchField(key); });
+    reportLoadProgress("Opening ODB", 0, 1);
     m_odb = &openOdb(odbFile.CStr(), true);
-    readStepFrameInfo();
-    initializeGeometry();
+    try {
+        readStepFrameInfo();
+        if (useGeometryCache) {
+            reportLoadProgress("Loading geometry cache", 0, 1);
+        }
+        if (!useGeometryCache || !loadGeometryCache()) {
+            initializeGeometry();
+            if (useGeometryCache) {
+                reportLoadProgress("Writing geometry cache", 0, 1);
+                saveGeometryCache();
+            }
+        }
+    }
+    catch (...) {
+        // 构造失败时析构函数不会执行，在这里关闭 ODB；已读取的成员随对象一起释放
+        m_odb->close();
+        throw;
+    }
+    m_loadProgress = nullptr;
+    span.arg("nodes", m_nodesNum);
+    span.arg("elements", m_elementsNum);
+}
+
+void readOdb::reportLoadProgress(const std::string& phase, std::size_t done, std::size_t total) const
+{
+    if (m_loadProgress && !m_loadProgress(phase, done, total)) {
+        throw OdbLoadCancelled();
+    }
 }
 
 readOdb::~readOdb()
 {
+    // 先停止后台预取，确保没有线程仍在访问 ODB
+    m_prefetcher.stop();
     m_odb->close();
 }
 
 void readOdb::initializeGeometry()
 {
+    tracing::Span span("initializeGeometry", "reader");
     m_nodesCoord.clear();
     m_elementsConn.clear();
-    m_elementTypes.clear();
+    m_elementTypeIds.clear();
+    m_elementTypeNames.clear();
+    m_elementTypeIndex.clear();
     m_instanceInfos.clear();
+    m_instanceIndexByName.clear();
+
+    odb_Assembly& rootAssy = m_odb->rootAssembly();
+
+    // 先统计总规模，据此选择连通性索引宽度并一次性预留
+    std::size_t totalNodes = 0;
+    std::size_t totalElements = 0;
+    {
+        odb_InstanceRepositoryIT countIter(rootAssy.instances());
+        for (countIter.first(); !countIter.isDone(); countIter.next()) {
+            const odb_Instance& inst = countIter.currentValue();
+            totalNodes += static_cast<std::size_t>(inst.nodes().size());
+            totalElements += static_cast<std::size_t>(inst.elements().size());
+        }
+    }
+    const bool wideIndex = totalNodes > static_cast<std::size_t>(INT32_MAX)
+        || totalElements * kMaxNodesPerElement > static_cast<std::size_t>(INT32_MAX);
+    m_elementsConn.reset(wideIndex);
+    m_elementsConn.reserveElements(totalElements);
+    m_nodesCoord.reserve(totalNodes);
+    m_elementTypeIds.reserve(totalElements);
 
     std::size_t nodeGlobalIndex = 0;
     std::size_t elementGlobalIndex = 0;
+    std::vector<std::size_t> globalConn; // 复用的单元节点缓冲，避免逐单元分配
+    std::vector<int> labels;             // 复用的标签缓冲，用于构建查找表
 
-    odb_Assembly& rootAssy = m_odb->rootAssembly();
     odb_InstanceRepositoryIT instIter(rootAssy.instances());
     for (instIter.first(); !instIter.isDone(); instIter.next()) {
         InstanceInfo info;
@@ -36,74 +124,221 @@ void readOdb::initializeGeometry()
 
         auto node_list = inst.nodes();
         auto element_list = inst.elements();
+        const std::string phase = "Reading geometry: " + info.name;
+        reportLoadProgress(phase, nodeGlobalIndex + elementGlobalIndex, totalNodes + totalElements);
 
         info.nodeStartIndex = nodeGlobalIndex;
 
-        // 节点：建立映射并填充坐标
+        // 节点：填充坐标并建立标签查找表
+        labels.clear();
+        labels.reserve(static_cast<std::size_t>(node_list.size()));
         for (int i = 0; i < node_list.size(); ++i) {
+            if ((i & kProgressMask) == kProgressMask) {
+                reportLoadProgress(phase, nodeGlobalIndex + elementGlobalIndex, totalNodes + totalElements);
+            }
             auto node = node_list[i];
-            info.nodeLabelToIndex[node.label()] = nodeGlobalIndex;
+            labels.push_back(node.label());
             const float* const coord = node.coordinates();
             m_nodesCoord.emplace_back(coord[0], coord[1], coord[2]);
             ++nodeGlobalIndex;
         }
         info.nodeCount = static_cast<std::size_t>(node_list.size());
+        info.nodeLabelToIndex.build(labels, info.nodeStartIndex);
+        labels.clear();
+        labels.reserve(static_cast<std::size_t>(element_list.size()));
 
         // 单元：建立映射并填充连通性与类型
         info.elementStartIndex = elementGlobalIndex;
+        if (element_list.size() > 0) {
+            // 以首个单元的节点数估算本实例的连通性长度，每个实例只预留一次
+            int firstNodes = 0;
+            element_list[0].connectivity(firstNodes);
+            m_elementsConn.reserveConnectivity(m_elementsConn.connectivitySize()
+                + static_cast<std::size_t>(element_list.size()) * static_cast<std::size_t>(firstNodes));
+        }
         for (int i = 0; i < element_list.size(); ++i) {
+            if ((i & kProgressMask) == kProgressMask) {
+                reportLoadProgress(phase, nodeGlobalIndex + elementGlobalIndex, totalNodes + totalElements);
+            }
             auto element = element_list[i];
-            info.elementLabelToIndex[element.label()] = elementGlobalIndex;
+            labels.push_back(element.label());
 
             int nNodes = 0;
             const int* const conn = element.connectivity(nNodes);
-            std::vector<std::size_t> globalConn;
             globalConn.resize(nNodes);
             for (int j = 0; j < nNodes; ++j) {
-                auto it = info.nodeLabelToIndex.find(conn[j]);
-                if (it != info.nodeLabelToIndex.end()) {
-                    globalConn[j] = it->second;
+                const std::size_t nodeIdx = info.nodeLabelToIndex.find(conn[j]);
+                if (nodeIdx != SIZE_MAX) {
+                    globalConn[j] = nodeIdx;
                 } else {
-                    std::cerr << "[Error] Node label " << conn[j] << " not found in instance " << info.name << std::endl;
+                    ODB_LOG_ERROR("Node label " << conn[j] << " not found in instance " << info.name);
                     globalConn[j] = 0; // 使用默认值
                 }
             }
-            m_elementsConn.emplace_back(std::move(globalConn));
-            m_elementTypes.emplace_back(element.type().CStr());
+            m_elementsConn.appendElement(globalConn.data(), nNodes);
+            m_elementTypeIds.push_back(internElementType(element.type().CStr()));
             ++elementGlobalIndex;
         }
         info.elementCount = static_cast<std::size_t>(element_list.size());
+        info.elementLabelToIndex.build(labels, info.elementStartIndex);
 
+        m_instanceIndexByName[info.name] = m_instanceInfos.size();
         m_instanceInfos.emplace_back(std::move(info));
     }
     m_nodesNum = nodeGlobalIndex;
     m_elementsNum = elementGlobalIndex;
+
+    ODB_LOG_INFO("Geometry loaded: " << m_nodesNum << " nodes, " << m_elementsNum << " elements, "
+                 << (m_elementsConn.wideIndex ? 64 : 32) << "-bit connectivity indices.");
 }
 
-//读取所有可用的step和frame信息
+std::uint16_t readOdb::internElementType(const char* typeName)
+{
+    // 相邻单元通常类型相同，先与上一个单元比较以省去哈希查找
+    if (!m_elementTypeIds.empty()) {
+        const std::uint16_t last = m_elementTypeIds.back();
+        if (m_elementTypeNames[last] == typeName) {
+            return last;
+        }
+    }
+    auto it = m_elementTypeIndex.find(typeName);
+    if (it != m_elementTypeIndex.end()) {
+        return it->second;
+    }
+    if (m_elementTypeNames.size() >= UINT16_MAX) {
+        throw std::runtime_error("Too many distinct element types");
+    }
+    const std::uint16_t id = static_cast<std::uint16_t>(m_elementTypeNames.size());
+    m_elementTypeNames.emplace_back(typeName);
+    m_elementTypeIndex.emplace(m_elementTypeNames.back(), id);
+    return id;
+}
+
+//建立分析步目录：只记录步名与帧数，不逐帧读取元数据
 void readOdb::readStepFrameInfo()
 {
-    m_availableStepsFrames.clear();
+    m_steps.clear();
+    m_stepIndexByName.clear();
+    m_fieldCatalog.clear();
+    m_fieldIndexByName.clear();
     m_hasFieldData = false;
 
+    const std::size_t stepCount = static_cast<std::size_t>(m_odb->steps().size());
+    std::size_t totalFrames = 0;
     odb_StepRepositoryIT stepIter(m_odb->steps());
     for (stepIter.first(); !stepIter.isDone(); stepIter.next()) {
+        reportLoadProgress("Reading steps and frames", m_steps.size(), stepCount);
         const odb_Step& step = stepIter.currentValue();
-        std::string stepName = step.name().cStr();
 
-        const odb_SequenceFrame& allFramesInStep = step.frames();
-        int numFrames = allFramesInStep.size();
-        for (int frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
-            const odb_Frame& frame = allFramesInStep[frameIdx];
-            StepFrameInfo info;
-            info.stepName = stepName;
-            info.frameIndex = frame.frameId();
-            info.frameValue = frame.frameValue();
-            info.description = frame.description().cStr();
-            m_availableStepsFrames.push_back(info);
+        StepCatalogEntry entry;
+        entry.name = step.name().cStr();
+        entry.frames = &step.frames();
+        entry.frameCount = entry.frames->size();
+        entry.frameInfos.resize(static_cast<std::size_t>(entry.frameCount));
+        entry.frameLoaded.assign(static_cast<std::size_t>(entry.frameCount), 0);
+        entry.frameFields.resize(static_cast<std::size_t>(entry.frameCount));
+        entry.fieldsScanned.assign(static_cast<std::size_t>(entry.frameCount), 0);
+        totalFrames += static_cast<std::size_t>(entry.frameCount);
+
+        m_stepIndexByName[entry.name] = m_steps.size();
+        m_steps.emplace_back(std::move(entry));
+    }
+    ODB_LOG_INFO("Found " << totalFrames << " frames across " << m_steps.size() << " steps.");
+}
+
+const readOdb::StepCatalogEntry* readOdb::findStep(const std::string& stepName) const
+{
+    auto it = m_stepIndexByName.find(stepName);
+    return it != m_stepIndexByName.end() ? &m_steps[it->second] : nullptr;
+}
+
+int readOdb::framePosition(const StepCatalogEntry& entry, int frameId) const
+{
+    // frameId 通常就是帧在步中的位置，先直接核对；不一致时一次性建立索引
+    if (!entry.indexed) {
+        if (frameId >= 0 && frameId < entry.frameCount && (*entry.frames)[frameId].frameId() == frameId) {
+            return frameId;
+        }
+        for (int i = 0; i < entry.frameCount; ++i) {
+            entry.positionById[(*entry.frames)[i].frameId()] = i;
+        }
+        entry.indexed = true;
+    }
+    auto it = entry.positionById.find(frameId);
+    return it != entry.positionById.end() ? it->second : -1;
+}
+
+const StepFrameInfo& readOdb::frameInfoAt(const StepCatalogEntry& entry, int position) const
+{
+    const std::size_t pos = static_cast<std::size_t>(position);
+    if (!entry.frameLoaded[pos]) {
+        const odb_Frame& frame = (*entry.frames)[position];
+        StepFrameInfo& info = entry.frameInfos[pos];
+        info.stepName = entry.name;
+        info.frameIndex = frame.frameId();
+        info.frameValue = frame.frameValue();
+        info.description = frame.description().cStr();
+        entry.frameLoaded[pos] = 1;
+    }
+    return entry.frameInfos[pos];
+}
+
+std::uint16_t readOdb::catalogField(const odb_FieldOutput& fieldOutput, const std::string& name) const
+{
+    auto it = m_fieldIndexByName.find(name);
+    if (it != m_fieldIndexByName.end()) {
+        return it->second;
+    }
+    FieldCatalogEntry entry;
+    entry.name = name;
+    entry.description = fieldOutput.description().cStr();
+    const odb_SequenceString& componentLabels = fieldOutput.componentLabels();
+    for (int c = 0; c < componentLabels.size(); ++c) {
+        entry.componentLabels.emplace_back(componentLabels[c].cStr());
+    }
+    entry.isNodal = fieldOutput.locations().size() == 0
+        || fieldOutput.locations()[0].position() == odb_Enum::NODAL;
+
+    const std::uint16_t id = static_cast<std::uint16_t>(m_fieldCatalog.size());
+    m_fieldCatalog.push_back(std::move(entry));
+    m_fieldIndexByName.emplace(name, id);
+    return id;
+}
+
+const std::vector<std::uint16_t>& readOdb::frameFieldsAt(const StepCatalogEntry& entry, int position) const
+{
+    const std::size_t pos = static_cast<std::size_t>(position);
+    if (entry.fieldsScanned[pos]) {
+        return entry.frameFields[pos];
+    }
+    // 已见过的场只读取名称，新场才读取元数据
+    std::vector<std::uint16_t>& ids = entry.frameFields[pos];
+    const odb_FieldOutputRepository& fieldOutputs = (*entry.frames)[position].fieldOutputs();
+    try {
+        odb_FieldOutputRepositoryIT foIter(fieldOutputs);
+        for (foIter.first(); !foIter.isDone(); foIter.next()) {
+            const std::string name = foIter.currentKey().CStr();
+            auto it = m_fieldIndexByName.find(name);
+            ids.push_back(it != m_fieldIndexByName.end() ? it->second : catalogField(foIter.currentValue(), name));
         }
+    } catch (const std::exception& e) {
+        ODB_LOG_ERROR("Failed to list field names: " << e.what());
     }
-    std::cout << "[Info] Found " << m_availableStepsFrames.size() << " frames across all steps." << std::endl;
+
+    // 若迭代方式不可用或无结果，回退到常用字段探测
+    if (ids.empty()) {
+        const char* commonFields[] = {"U", "UR", "S"};
+        for (const char* name : commonFields) {
+            if (fieldOutputs.isMember(name)) {
+                ids.push_back(catalogField(fieldOutputs[name], name));
+            }
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    ids.shrink_to_fit();
+    entry.fieldsScanned[pos] = 1;
+    return ids;
 }
 
 bool readOdb::readFieldOutput(const std::string& stepName, int frameIndex)
@@ -111,7 +346,7 @@ bool readOdb::readFieldOutput(const std::string& stepName, int frameIndex)
     return readAllFields(stepName, frameIndex);
 }
 
-void readOdb::readDisplacementField(const odb_FieldOutput& fieldOutput)
+FieldData readOdb::readDisplacementField(const odb_FieldOutput& fieldOutput)
 {
     FieldData fieldData;
     fieldData.type = FieldType::DISPLACEMENT;
@@ -125,13 +360,12 @@ void readOdb::readDisplacementField(const odb_FieldOutput& fieldOutput)
     }
     fieldData.components = static_cast<int>(fieldOutput.componentLabels().size());
     extractFieldData(fieldOutput, fieldData);
-    m_fieldDataMap["U"] = std::move(fieldData);
-
-    std::cout << "[Info] Read displacement field with " << m_nodesNum
-              << " nodes, " << m_fieldDataMap["U"].components << " components." << std::endl;
+    ODB_LOG_DEBUG("Read displacement field with " << m_nodesNum
+                  << " nodes, " << fieldData.components << " components.");
+    return fieldData;
 }
 
-void readOdb::readRotationField(const odb_FieldOutput& fieldOutput)
+FieldData readOdb::readRotationField(const odb_FieldOutput& fieldOutput)
 {
     FieldData fieldData;
     fieldData.type = FieldType::ROTATION;
@@ -145,13 +379,12 @@ void readOdb::readRotationField(const odb_FieldOutput& fieldOutput)
     }
     fieldData.components = static_cast<int>(fieldOutput.componentLabels().size());
     extractFieldData(fieldOutput, fieldData);
-    m_fieldDataMap["UR"] = std::move(fieldData);
-
-    std::cout << "[Info] Read rotation field with " << m_nodesNum
-              << " nodes, " << m_fieldDataMap["UR"].components << " components." << std::endl;
+    ODB_LOG_DEBUG("Read rotation field with " << m_nodesNum
+                  << " nodes, " << fieldData.components << " components.");
+    return fieldData;
 }
 
-void readOdb::readStressField(const odb_FieldOutput& fieldOutput)
+FieldData readOdb::readStressField(const odb_FieldOutput& fieldOutput)
 {
     FieldData fieldData;
     fieldData.type = FieldType::STRESS;
@@ -165,14 +398,14 @@ void readOdb::readStressField(const odb_FieldOutput& fieldOutput)
     }
     fieldData.components = static_cast<int>(fieldOutput.componentLabels().size());
     extractFieldData(fieldOutput, fieldData);
-    m_fieldDataMap["S"] = std::move(fieldData);
-
-    std::cout << "[Info] Read stress field with " << m_elementsNum
-              << " elements, " << m_fieldDataMap["S"].components << " components." << std::endl;
+    ODB_LOG_DEBUG("Read stress field with " << m_elementsNum
+                  << " elements, " << fieldData.components << " components.");
+    return fieldData;
 }
 
 void readOdb::extractFieldData(const odb_FieldOutput& fieldOutput, FieldData& fieldData)
 {
+    tracing::Span span("extractFieldData", "reader");
     const odb_SequenceFieldBulkData& bulkDataBlocks = fieldOutput.bulkDataBlocks();
     int numBlocks = bulkDataBlocks.size();
     int numComponents = fieldData.components;
@@ -188,203 +421,768 @@ void readOdb::extractFieldData(const odb_FieldOutput& fieldOutput, FieldData& fi
         isNodalData = false;
     }
     fieldData.isNodal = isNodalData;
+    if (!isNodalData) {
+        // 未保留积分点时提取过程中直接按该方式汇总；保留时作为首次汇总的方式
+        fieldData.reduction = m_ipReduction;
+        fieldData.selectedPoint = m_selectedPoint;
+    }
 
-    if (isNodalData) {
-        fieldData.values.assign(m_nodesNum * numComponents, 0.0f);
-        fieldData.validFlags.assign(m_nodesNum, 0);
-
-        for (int iblock = 0; iblock < numBlocks; iblock++) {
-            const odb_FieldBulkData& bulkData = bulkDataBlocks[iblock];
-            int numNodes = bulkData.length();        // 节点数量
-            int numComp = bulkData.width();          // 组件数量
-            float* data = bulkData.data();           // 数据数组
-            int* nodeLabels = bulkData.nodeLabels(); // 节点标签数组
-
-            int pos = 0;
-            for (int node = 0; node < numNodes; node++) {
-                int nodeLabel = nodeLabels[node];
-                // 未区分实例时，遍历所有实例查找
-                std::size_t globalIdx = findGlobalIndex("", nodeLabel, true);
-                if (globalIdx < m_nodesNum) {
-                    const std::size_t base = globalIdx * numComponents;
-                    for (int comp = 0; comp < numComp; comp++) {
-                        fieldData.values[base + comp] = data[pos++];
-                    }
-                    fieldData.validFlags[globalIdx] = 1;
-                } else {
-                    pos += numComp; // 跳过无效节点的数据
+    const std::size_t entityCount = isNodalData ? m_nodesNum : m_elementsNum;
+
+    // 场目录的精度只能从数据块得知，第一次提取时补全
+    if (numBlocks > 0) {
+        FieldCatalogEntry& catalog = m_fieldCatalog[catalogField(fieldOutput, fieldOutput.name().CStr())];
+        if (catalog.precision == FieldPrecision::UNKNOWN) {
+            catalog.precision = bulkDataBlocks[0].precision() == odb_Enum::DOUBLE_PRECISION
+                ? FieldPrecision::DOUBLE : FieldPrecision::SINGLE;
+        }
+    }
+
+    // 串行取出各数据块的原始指针（ODB API 不保证线程安全）
+    std::vector<BulkBlockView> blocks;
+    blocks.reserve(static_cast<std::size_t>(numBlocks));
+    std::size_t totalEntities = 0;
+    for (int iblock = 0; iblock < numBlocks; iblock++) {
+        const odb_FieldBulkData& bulkData = bulkDataBlocks[iblock];
+        BulkBlockView block;
+        block.data = bulkData.data();
+        block.width = bulkData.width();
+        // 数据块属于单一实例，直接使用该实例的查找表
+        block.instance = findInstance(bulkData.instance().name().CStr());
+        if (isNodalData) {
+            block.count = bulkData.length();
+            block.labels = bulkData.nodeLabels();
+        } else {
+            const int numValues = bulkData.length();  // 总输出位置数
+            block.count = bulkData.numberOfElements();
+            block.labels = bulkData.elementLabels();
+            block.valuesPerEntity = (block.count > 0) ? numValues / block.count : 1;
+        }
+        totalEntities += static_cast<std::size_t>(block.count);
+        blocks.push_back(block);
+    }
+
+    // 数据块只覆盖模型一小部分（接触输出、单个实例的场）时改用稀疏布局，内存随覆盖率缩减
+    const bool sparse = static_cast<double>(totalEntities) < m_sparseCoverage * static_cast<double>(entityCount) &&
+                        entityCount <= UINT32_MAX;
+    if (sparse) {
+        std::vector<std::uint32_t>& indices = fieldData.sparseIndices;
+        indices.reserve(totalEntities);
+        for (const BulkBlockView& block : blocks) {
+            for (int i = 0; i < block.count; ++i) {
+                const std::size_t globalIdx = resolveBlockIndex(block, i, isNodalData);
+                if (globalIdx < entityCount) {
+                    indices.push_back(static_cast<std::uint32_t>(globalIdx));
                 }
             }
         }
-    } 
-    else {
-        fieldData.values.assign(m_elementsNum * numComponents, 0.0f);
-        fieldData.validFlags.assign(m_elementsNum, 0);
-
-        for (int jblock = 0; jblock < numBlocks; jblock++) {
-            const odb_FieldBulkData& bulkData = bulkDataBlocks[jblock];
-            int numValues = bulkData.length();           // 总输出位置数
-            int numComp = bulkData.width();              // 组件数量
-            float* data = bulkData.data();               // 数据数组
-            int nElems = bulkData.numberOfElements();    // 单元数量
-            int* elementLabels = bulkData.elementLabels(); // 单元标签数组
-
-            int numIP = (nElems > 0) ? numValues / nElems : 1; // 每单元积分点数
-            int dataPosition = 0;
-
-            for (int elem = 0; elem < nElems; elem++) {
-                int elementLabel = elementLabels[elem];
-                std::size_t globalIdx = findGlobalIndex("", elementLabel, false);
-                if (globalIdx < m_elementsNum) {
-                    const std::size_t base = globalIdx * numComponents;
-                    // 取第一个积分点的值
-                    for (int comp = 0; comp < numComp; comp++) {
-                        fieldData.values[base + comp] = data[dataPosition + comp];
-                    }
-                    fieldData.validFlags[globalIdx] = 1;
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        indices.shrink_to_fit();
+        fieldData.values.assign(indices.size() * numComponents, 0.0f);
+    } else {
+        fieldData.values.assign(entityCount * numComponents, 0.0f);
+        fieldData.validFlags.assign(entityCount, 0);
+    }
+    const std::size_t slotCount = fieldData.slotCount();
+
+    // 壳的多个截面点、同一实例的多个输出区域会产生标签相同的多个数据块；此时并行写入同一槽位是数据竞争，
+    // 改为按块顺序串行写入（后面的块覆盖前面的块，与单线程结果一致），统计量在写入完成后另行计算
+    const bool disjoint = !blocksOverlap(blocks, isNodalData, entityCount);
+    if (!disjoint) {
+        ODB_LOG_DEBUG("Field '" << fieldData.name << "' has overlapping bulk data blocks, extracting serially.");
+    }
+
+    // 保留全部积分点：先统计每个单元的积分点数得到偏移，再在提取时整段复制
+    std::shared_ptr<IntegrationPointData> points;
+    if (!isNodalData && m_keepIntegrationPoints) {
+        points = std::make_shared<IntegrationPointData>();
+        points->offsets.assign(slotCount + 1, 0);
+        forEachBlockRange(blocks, totalEntities, disjoint, [&](const BulkBlockView& block, int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const std::size_t slot = findSlot(fieldData, resolveBlockIndex(block, i, false));
+                if (slot < slotCount) {
+                    points->offsets[slot + 1] = static_cast<std::size_t>(block.valuesPerEntity);
                 }
-                dataPosition += numIP * numComp; // 跳过该单元其他积分点
             }
+        });
+        std::partial_sum(points->offsets.begin(), points->offsets.end(), points->offsets.begin());
+        points->values.assign(points->offsets.back() * numComponents + IntegrationPointData::kPadding, 0.0f);
+    }
+
+    // 数据块互不相交时大数据块再按固定长度切分并行写入
+    // 统计量与写入同一遍累积；保留积分点时 values 由汇总重新生成，统计量在汇总时计算
+    FieldStatsAccumulator stats(numComponents, slotCount);
+    const bool statsInPass = !points && disjoint;
+    forEachBlockRange(blocks, totalEntities, disjoint, [&](const BulkBlockView& block, int begin, int end) {
+        extractBlockRange(block, begin, end, fieldData, points.get(), statsInPass ? &stats : nullptr);
+    });
+
+    if (points) {
+        fieldData.integrationPoints = std::move(points);
+        reduceFieldValues(fieldData);
+    } else {
+        if (!statsInPass) {
+            // 重叠的槽位被写入多次，按最终值统计每个槽位一次
+            FieldStatsAccumulator::Partial partial = stats.makePartial();
+            for (std::size_t slot = 0; slot < slotCount; ++slot) {
+                if (fieldData.slotValid(slot)) {
+                    stats.add(partial, slot, fieldData.values.data() + slot * numComponents);
+                }
+            }
+            stats.merge(partial);
         }
+        fieldData.stats = stats.finish();
     }
 
-    std::cout << "[Info] Bulk data extraction completed. Processed " << numBlocks
-              << " blocks with " << numComponents << " components." << std::endl;
+    span.arg("blocks", static_cast<std::uint64_t>(numBlocks));
+    span.arg("entities", totalEntities);
+    span.arg("bytes", fieldData.values.size() * sizeof(float));
+    ODB_LOG_DEBUG("Bulk data extraction completed. Processed " << numBlocks
+                  << " blocks with " << numComponents << " components.");
 }
 
-std::size_t readOdb::findGlobalIndex(const std::string& instanceName, int label, bool isNode)
+ThreadPool* readOdb::acquireExtractPool(std::size_t workItems)
 {
-    // 如提供实例名，优先在该实例查找；否则遍历所有实例
-    if (!instanceName.empty()) {
-        for (const auto& info : m_instanceInfos) {
-            if (info.name == instanceName) {
-                const auto& mapRef = isNode ? info.nodeLabelToIndex : info.elementLabelToIndex;
-                auto it = mapRef.find(label);
-                if (it != mapRef.end()) return it->second;
-                break;
+    const unsigned threads = ThreadPool::resolveThreadCount(m_extractionThreads);
+    if (threads <= 1 || workItems < kParallelExtractThreshold) {
+        return nullptr;
+    }
+    if (!m_extractPool || m_extractPool->threadCount() != threads) {
+        m_extractPool = std::make_unique<ThreadPool>(threads);
+    }
+    return m_extractPool.get();
+}
+
+bool readOdb::blocksOverlap(const std::vector<BulkBlockView>& blocks, bool isNodal, std::size_t entityCount) const
+{
+    // 不同实例的全局索引区间互不相交，只需检查同一实例的多个数据块
+    std::unordered_map<const InstanceInfo*, int> blocksPerInstance;
+    bool shared = false;
+    for (const BulkBlockView& block : blocks) {
+        shared |= ++blocksPerInstance[block.instance] > 1;
+    }
+    if (!shared) {
+        return false;
+    }
+    std::vector<bool> seen(entityCount, false);
+    for (const BulkBlockView& block : blocks) {
+        if (blocksPerInstance[block.instance] < 2) continue;
+        for (int i = 0; i < block.count; ++i) {
+            const std::size_t globalIdx = resolveBlockIndex(block, i, isNodal);
+            if (globalIdx >= entityCount) continue;
+            if (seen[globalIdx]) {
+                return true;
             }
+            seen[globalIdx] = true;
         }
     }
-    for (const auto& info : m_instanceInfos) {
-        const auto& mapRef = isNode ? info.nodeLabelToIndex : info.elementLabelToIndex;
-        auto it = mapRef.find(label);
-        if (it != mapRef.end()) return it->second;
+    return false;
+}
+
+void readOdb::forEachBlockRange(const std::vector<BulkBlockView>& blocks, std::size_t totalEntities, bool disjoint,
+                                const std::function<void(const BulkBlockView&, int, int)>& fn)
+{
+    const std::atomic<bool>* cancel = m_extractCancel;
+    ThreadPool* pool = disjoint ? acquireExtractPool(totalEntities) : nullptr;
+    if (!pool) {
+        // 串行时同样按固定长度切分，便于在大数据块中途响应取消
+        for (const BulkBlockView& block : blocks) {
+            for (int begin = 0; begin < block.count; begin += kExtractChunkSize) {
+                if (cancel && cancel->load()) return;
+                fn(block, begin, std::min(block.count, begin + kExtractChunkSize));
+            }
+        }
+        return;
     }
-    return SIZE_MAX;
+
+    struct Task { std::size_t block; int begin; int end; };
+    std::vector<Task> tasks;
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        for (int begin = 0; begin < blocks[b].count; begin += kExtractChunkSize) {
+            tasks.push_back({b, begin, std::min(blocks[b].count, begin + kExtractChunkSize)});
+        }
+    }
+    pool->parallelFor(tasks.size(), [&](std::size_t t) {
+        if (cancel && cancel->load()) return;
+        const Task& task = tasks[t];
+        fn(blocks[task.block], task.begin, task.end);
+    });
 }
 
-bool readOdb::readAllFields(const std::string& stepName, int frameIndex)
+std::size_t readOdb::findSlot(const FieldData& fieldData, std::size_t globalIdx)
 {
-    const odb_String& stepNameOdbStr = odb_String(stepName.c_str());
-    const odb_StepRepository& steps = m_odb->steps();
-    if (!steps.isMember(stepNameOdbStr)) {
-        std::cerr << "[Error] Step '" << stepName << "' not found." << std::endl;
-        return false;
+    if (!fieldData.isSparse()) {
+        return globalIdx < fieldData.validFlags.size() ? globalIdx : SIZE_MAX;
     }
+    const auto& indices = fieldData.sparseIndices;
+    auto it = std::lower_bound(indices.begin(), indices.end(), globalIdx);
+    return (it != indices.end() && *it == globalIdx) ? static_cast<std::size_t>(it - indices.begin()) : SIZE_MAX;
+}
 
-    const odb_Step& step = steps.constGet(stepNameOdbStr);
-    const odb_SequenceFrame& allFramesInStep = step.frames();
+std::size_t readOdb::resolveBlockIndex(const BulkBlockView& block, int i, bool isNodal) const
+{
+    const int label = block.labels[i];
+    if (block.instance) {
+        return isNodal ? block.instance->nodeLabelToIndex.find(label)
+                       : block.instance->elementLabelToIndex.find(label);
+    }
+    return findGlobalIndex("", label, isNodal);
+}
 
-    // 查找指定的frame
-    odb_Frame* targetFrame = nullptr;
-    int numFrames = allFramesInStep.size();
-    for (int i = 0; i < numFrames; ++i) {
-        const odb_Frame& frame = allFramesInStep[i];
-        if (frame.frameId() == frameIndex) {
-            targetFrame = const_cast<odb_Frame*>(&frame);
+void readOdb::extractBlockRange(const BulkBlockView& block, int begin, int end, FieldData& fieldData,
+                                IntegrationPointData* points, FieldStatsAccumulator* stats) const
+{
+    const bool isNodalData = fieldData.isNodal;
+    const std::size_t limit = isNodalData ? m_nodesNum : m_elementsNum;
+    const bool sparse = fieldData.isSparse();
+    const std::size_t numComponents = static_cast<std::size_t>(fieldData.components);
+    const int numComp = std::min(block.width, fieldData.components);
+    // 保留积分点时 values 先取第一个积分点，该单元全部积分点另存一份，之后统一汇总；
+    // 未保留时在复制的同时按 fieldData.reduction 汇总，积分点不另存
+    const bool reduceInPass = !points && !isNodalData && block.valuesPerEntity > 1
+        && fieldData.reduction != IPReduction::FIRST_POINT;
+    const std::size_t width = static_cast<std::size_t>(block.width);
+    const std::size_t stride = static_cast<std::size_t>(block.valuesPerEntity) * width;
+    FieldStatsAccumulator::Partial partial;
+    if (stats) {
+        partial = stats->makePartial();
+    }
+
+    const std::atomic<bool>* cancel = m_extractCancel;
+    for (int i = begin; i < end; ++i) {
+        // 后台预取被取消时尽快结束以释放 ODB 锁，不完整的结果由调用方丢弃
+        if (cancel && (i & kCancelCheckMask) == 0 && cancel->load()) {
             break;
         }
+        const std::size_t globalIdx = resolveBlockIndex(block, i, isNodalData);
+        if (globalIdx >= limit) {
+            continue; // 跳过无效标签的数据
+        }
+        const std::size_t slot = sparse ? findSlot(fieldData, globalIdx) : globalIdx;
+        if (slot == SIZE_MAX) {
+            continue;
+        }
+        const float* src = block.data + static_cast<std::size_t>(i) * stride;
+        float* dst = fieldData.values.data() + slot * numComponents;
+        if (reduceInPass) {
+            const std::size_t numIP = static_cast<std::size_t>(block.valuesPerEntity);
+            for (int comp = 0; comp < numComp; comp++) {
+                dst[comp] = reducePointValues(src + comp, numIP, width, fieldData.reduction, fieldData.selectedPoint);
+            }
+        } else {
+            for (int comp = 0; comp < numComp; comp++) {
+                dst[comp] = src[comp];
+            }
+        }
+        if (!sparse) {
+            fieldData.validFlags[globalIdx] = 1;
+        }
+        if (stats) {
+            stats->add(partial, slot, dst);
+        }
+
+        if (points) {
+            // 重叠的数据块按块顺序写入，偏移取最后一个块的积分点数；各块只复制两者中较少的部分，
+            // 既不越过本单元在 values 中的区段，也不读出本块该单元的数据之外
+            float* ipDst = points->values.data() + points->offsets[slot] * numComponents;
+            const std::size_t numIP = std::min(points->pointCount(slot), static_cast<std::size_t>(block.valuesPerEntity));
+            for (std::size_t ip = 0; ip < numIP; ++ip) {
+                const float* ipSrc = src + ip * width;
+                for (int comp = 0; comp < numComp; comp++) {
+                    ipDst[ip * numComponents + comp] = ipSrc[comp];
+                }
+            }
+        }
+    }
+    if (stats) {
+        stats->merge(partial);
     }
+}
 
-    if (!targetFrame) {
-        std::cerr << "[Error] Frame " << frameIndex << " not found in step '" << stepName << "'." << std::endl;
-        return false;
+void readOdb::reduceFieldValues(FieldData& fieldData)
+{
+    const IntegrationPointData* points = fieldData.integrationPoints.get();
+    if (!points) return;
+    const std::size_t elements = points->offsets.size() - 1;
+    const std::size_t numComponents = static_cast<std::size_t>(fieldData.components);
+    float* out = fieldData.values.data();
+    FieldStatsAccumulator stats(fieldData.components, elements);
+    const auto reduceRange = [&](std::size_t begin, std::size_t end) {
+        reduceIntegrationPoints(*points, fieldData.components, fieldData.reduction,
+                                fieldData.selectedPoint, begin, end, out);
+        FieldStatsAccumulator::Partial partial = stats.makePartial();
+        for (std::size_t e = begin; e < end; ++e) {
+            if (fieldData.slotValid(e)) {
+                stats.add(partial, e, out + e * numComponents);
+            }
+        }
+        stats.merge(partial);
+    };
+
+    ThreadPool* pool = acquireExtractPool(elements);
+    if (!pool) {
+        reduceRange(0, elements);
+    } else {
+        const std::size_t chunk = static_cast<std::size_t>(kExtractChunkSize);
+        pool->parallelFor((elements + chunk - 1) / chunk, [&](std::size_t t) {
+            reduceRange(t * chunk, std::min(elements, (t + 1) * chunk));
+        });
+    }
+    fieldData.stats = stats.finish();
+}
+
+std::shared_ptr<const FieldData> readOdb::withReduction(const FieldData& source, IPReduction mode, int selectedPoint)
+{
+    // values 完全由积分点数据重新汇总：只复制元数据与有效性，积分点数据共享，旧的 values 不复制也不解码
+    FieldData reduced;
+    reduced.type = source.type;
+    reduced.name = source.name;
+    reduced.description = source.description;
+    reduced.componentLabels = source.componentLabels;
+    reduced.components = source.components;
+    reduced.isNodal = source.isNodal;
+    reduced.unit = source.unit;
+    reduced.integrationPoints = source.integrationPoints;
+    reduced.sparseIndices = source.sparseIndices;
+    const std::size_t slotCount = source.slotCount();
+    if (!source.isPacked()) {
+        reduced.validFlags = source.validFlags;
+    } else if (!source.isSparse()) {
+        const std::vector<std::uint64_t>& bits = source.packed.validBits;
+        reduced.validFlags.assign(slotCount, 0);
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            reduced.validFlags[i] = static_cast<std::uint8_t>((bits[i >> 6] >> (i & 63)) & 1u);
+        }
+    }
+    reduced.values.assign(slotCount * static_cast<std::size_t>(source.components), 0.0f);
+    const FieldStorage storage = source.storage;
+    reduced.reduction = mode;
+    reduced.selectedPoint = selectedPoint;
+    reduceFieldValues(reduced);
+    packFieldData(reduced, storage);
+    return std::make_shared<const FieldData>(std::move(reduced));
+}
+
+void readOdb::setKeepIntegrationPoints(bool keep)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    if (m_keepIntegrationPoints == keep) return;
+    m_keepIntegrationPoints = keep;
+    // 已缓存的场与新的存储方式不一致
+    m_fieldCache.clear();
+}
+
+const FieldData* readOdb::setIntegrationPointReduction(const std::string& fieldName, IPReduction mode, int selectedPoint)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    m_ipReduction = mode;
+    m_selectedPoint = selectedPoint;
+    if (fieldName.empty()) {
+        return nullptr;
+    }
+
+    auto it = m_fieldDataMap.find(fieldName);
+    if (it == m_fieldDataMap.end() || !it->second->integrationPoints) {
+        ODB_LOG_WARNING("Field '" << fieldName << "' has no integration point data.");
+        return nullptr;
+    }
+    if (it->second->reduction != mode || it->second->selectedPoint != selectedPoint) {
+        it->second = withReduction(*it->second, mode, selectedPoint);
+        m_fieldCache.insert(FieldCacheKey{m_currentStepFrame.stepName, m_currentStepFrame.frameIndex, fieldName},
+                            it->second);
+    }
+    return it->second.get();
+}
+
+std::size_t readOdb::findGlobalIndex(const std::string& instanceName, int label, bool isNode) const
+{
+    // 如提供实例名，优先在该实例查找；否则遍历所有实例（标签可能跨实例重复，仅作兜底）
+    if (const InstanceInfo* info = findInstance(instanceName)) {
+        const auto& mapRef = isNode ? info->nodeLabelToIndex : info->elementLabelToIndex;
+        std::size_t idx = mapRef.find(label);
+        if (idx != SIZE_MAX) return idx;
+    }
+    for (const auto& info : m_instanceInfos) {
+        const auto& mapRef = isNode ? info.nodeLabelToIndex : info.elementLabelToIndex;
+        std::size_t idx = mapRef.find(label);
+        if (idx != SIZE_MAX) return idx;
+    }
+    return SIZE_MAX;
+}
+
+const InstanceInfo* readOdb::findInstance(const std::string& instanceName) const
+{
+    if (instanceName.empty()) return nullptr;
+    auto it = m_instanceIndexByName.find(instanceName);
+    return it != m_instanceIndexByName.end() ? &m_instanceInfos[it->second] : nullptr;
+}
+
+const odb_Frame* readOdb::findFrame(const std::string& stepName, int frameIndex) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const StepCatalogEntry* entry = findStep(stepName);
+    if (!entry) {
+        ODB_LOG_ERROR("Step '" << stepName << "' not found.");
+        return nullptr;
     }
+    const int position = framePosition(*entry, frameIndex);
+    if (position < 0) {
+        ODB_LOG_ERROR("Frame " << frameIndex << " not found in step '" << stepName << "'.");
+        return nullptr;
+    }
+    return &(*entry->frames)[position];
+}
 
+void readOdb::setCurrentFrame(const std::string& stepName, int frameIndex, const odb_Frame& frame)
+{
     m_currentStepFrame.stepName = stepName;
     m_currentStepFrame.frameIndex = frameIndex;
-    m_currentStepFrame.frameValue = targetFrame->frameValue();
-    m_currentStepFrame.description = targetFrame->description().cStr();
+    m_currentStepFrame.frameValue = frame.frameValue();
+    m_currentStepFrame.description = frame.description().cStr();
     m_fieldDataMap.clear();
+}
+
+bool readOdb::readAllFields(const std::string& stepName, int frameIndex)
+{
+    tracing::Span span("readFieldOutput", "reader");
+    FramePrefetcher::Claim claim(m_prefetcher, {FieldCacheKey{stepName, frameIndex, "U"},
+                                                FieldCacheKey{stepName, frameIndex, "UR"},
+                                                FieldCacheKey{stepName, frameIndex, "S"}});
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const odb_Frame* targetFrame = findFrame(stepName, frameIndex);
+    if (!targetFrame) {
+        return false;
+    }
+    setCurrentFrame(stepName, frameIndex, *targetFrame);
 
     // 读取场输出数据
     const odb_FieldOutputRepository& fieldOutputs = targetFrame->fieldOutputs();
-    if (fieldOutputs.isMember("U")) {
-        readDisplacementField(fieldOutputs["U"]);
+    for (const char* name : {"U", "UR", "S"}) {
+        if (fieldOutputs.isMember(name) && !useCachedField(name)) {
+            storeFieldData(readFieldByName(fieldOutputs[name], name));
+        }
     }
 
-    if (fieldOutputs.isMember("UR")) {
-        readRotationField(fieldOutputs["UR"]);
+    m_hasFieldData = !m_fieldDataMap.empty();
+    ODB_LOG_INFO("Successfully read field output for step '" << stepName
+                 << "', frame " << frameIndex << ". Found " << m_fieldDataMap.size()
+                 << " field variables.");
+
+    return true;
+}
+
+bool readOdb::readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName)
+{
+    tracing::Span span("readSingleField", "reader");
+    // 后台正在读取同一场时等待并复用其结果；正在读取其他帧时让其放弃，读取结束前后台不再开始新的请求
+    FramePrefetcher::Claim claim(m_prefetcher, {FieldCacheKey{stepName, frameIndex, fieldName}});
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const odb_Frame* targetFrame = findFrame(stepName, frameIndex);
+    if (!targetFrame) {
+        return false;
+    }
+    setCurrentFrame(stepName, frameIndex, *targetFrame);
+
+    // 缓存命中（包括后台预取的结果）时无需再访问 ODB
+    if (useCachedField(fieldName)) {
+        span.arg("cacheHit", 1);
+        m_hasFieldData = true;
+        logFieldCacheStats();
+        return true;
     }
 
-    if (fieldOutputs.isMember("S")) {
-        readStressField(fieldOutputs["S"]);
+    const odb_FieldOutputRepository& fieldOutputs = targetFrame->fieldOutputs();
+    if (!fieldOutputs.isMember(fieldName.c_str())) {
+        ODB_LOG_ERROR("Field '" << fieldName << "' not found in frame.");
+        return false;
     }
+    storeFieldData(readFieldByName(fieldOutputs[fieldName.c_str()], fieldName));
 
     m_hasFieldData = !m_fieldDataMap.empty();
-    std::cout << "[Info] Successfully read field output for step '" << stepName
-              << "', frame " << frameIndex << ". Found " << m_fieldDataMap.size()
-              << " field variables." << std::endl;
+    logFieldCacheStats();
 
     return true;
 }
 
-bool readOdb::readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName)
+std::shared_ptr<const FieldData> readOdb::loadField(const std::string& stepName, int frameIndex,
+                                                    const std::string& fieldName)
 {
-    const odb_String& stepNameOdbStr = odb_String(stepName.c_str());
-    const odb_StepRepository& steps = m_odb->steps();
-    if (!steps.isMember(stepNameOdbStr)) {
-        std::cerr << "[Error] Step '" << stepName << "' not found." << std::endl;
-        return false;
+    tracing::Span span("loadField", "reader");
+    const FieldCacheKey key{stepName, frameIndex, fieldName};
+    FramePrefetcher::Claim claim(m_prefetcher, {key});
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    if (std::shared_ptr<const FieldData> cached = findCachedField(key)) {
+        span.arg("cacheHit", 1);
+        return cached;
+    }
+    const odb_Frame* targetFrame = findFrame(stepName, frameIndex);
+    if (!targetFrame) {
+        return nullptr;
+    }
+    const odb_FieldOutputRepository& fieldOutputs = targetFrame->fieldOutputs();
+    if (!fieldOutputs.isMember(fieldName.c_str())) {
+        ODB_LOG_ERROR("Field '" << fieldName << "' not found in frame.");
+        return nullptr;
     }
+    FieldData fieldData = readFieldByName(fieldOutputs[fieldName.c_str()], fieldName);
+    packFieldData(fieldData, m_fieldStorage);
+    auto shared = std::make_shared<const FieldData>(std::move(fieldData));
+    m_fieldCache.insert(key, shared);
+    return shared;
+}
 
-    const odb_Step& step = steps.constGet(stepNameOdbStr);
-    const odb_SequenceFrame& allFramesInStep = step.frames();
+void readOdb::prefetchNeighbours(const std::string& stepName, int frameIndex, const std::string& fieldName)
+{
+    if (m_prefetchDepth <= 0) {
+        m_prefetcher.cancel();
+        return;
+    }
 
-    odb_Frame* targetFrame = nullptr;
-    int numFrames = allFramesInStep.size();
-    for (int i = 0; i < numFrames; ++i) {
-        const odb_Frame& frame = allFramesInStep[i];
-        if (frame.frameId() == frameIndex) {
-            targetFrame = const_cast<odb_Frame*>(&frame);
-            break;
+    // 同一步内按 N+1, N-1, N+2, N-2 ... 的顺序预取
+    std::vector<FieldCacheKey> keys;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+        const StepCatalogEntry* entry = findStep(stepName);
+        const int current = entry ? framePosition(*entry, frameIndex) : -1;
+        if (current >= 0) {
+            keys.push_back(FieldCacheKey{stepName, frameIndex, fieldName});
+            for (int d = 1; d <= m_prefetchDepth; ++d) {
+                if (current + d < entry->frameCount) {
+                    keys.push_back(FieldCacheKey{stepName, frameInfoAt(*entry, current + d).frameIndex, fieldName});
+                }
+                if (current - d >= 0) {
+                    keys.push_back(FieldCacheKey{stepName, frameInfoAt(*entry, current - d).frameIndex, fieldName});
+                }
+            }
         }
     }
+    m_prefetcher.schedule(std::move(keys));
+}
 
-    if (!targetFrame) {
-        std::cerr << "[Error] Frame " << frameIndex << " not found in step '" << stepName << "'." << std::endl;
+bool readOdb::exportPartitioned(const std::string& pvtuFileName, const PartitionedExportOptions& options,
+                                PartitionedExportSummary* summary)
+{
+    // 导出期间独占 ODB，后台预取让路
+    cancelPrefetch();
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    PartitionedVtuWriter writer(*m_odb);
+    return writer.write(pvtuFileName, options, summary);
+}
+
+bool readOdb::readTimeHistory(const std::string& fieldName, const std::string& componentLabel,
+                              const std::vector<EntityRef>& entities, TimeHistory& history,
+                              const std::string& stepName)
+{
+    history = TimeHistory();
+    history.fieldName = fieldName;
+    history.componentLabel = componentLabel;
+    history.entities = entities;
+    // 时间轴需要每帧的时间，这里逐帧读取元数据；同时记下帧在 ODB 中的位置，读取时直接寻址
+    std::vector<const odb_Frame*> odbFrames;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+        for (const StepCatalogEntry& entry : m_steps) {
+            if (!stepName.empty() && entry.name != stepName) continue;
+            for (int pos = 0; pos < entry.frameCount; ++pos) {
+                history.frames.push_back(frameInfoAt(entry, pos));
+                odbFrames.push_back(&(*entry.frames)[pos]);
+            }
+        }
+    }
+    if (history.frames.empty()) {
+        ODB_LOG_ERROR("No frames found for time history of '" << fieldName << "'.");
         return false;
     }
+    const std::size_t numFrames = history.frames.size();
+    history.values.assign(entities.size() * numFrames, 0.0f);
+    history.validFlags.assign(entities.size() * numFrames, 0);
+
+    // 重复请求的实体只读取一次，结束时复制序列
+    std::vector<std::size_t> primary(entities.size());
+    // 按实例分组：标签到实体序号的查找表只建一次，节点 / 单元集合在首次需要时由这些标签创建
+    std::vector<HistoryTarget> targets;
+    {
+        std::unordered_map<std::string, std::size_t> targetIndex;
+        for (std::size_t j = 0; j < entities.size(); ++j) {
+            const EntityRef& entity = entities[j];
+            auto inserted = targetIndex.emplace(entity.instanceName, targets.size());
+            if (inserted.second) {
+                targets.emplace_back();
+                targets.back().instanceName = entity.instanceName;
+            }
+            HistoryTarget& target = targets[inserted.first->second];
+            primary[j] = target.slots.emplace(entity.label, j).first->second;
+        }
+    }
 
-    m_currentStepFrame.stepName = stepName;
-    m_currentStepFrame.frameIndex = frameIndex;
-    m_currentStepFrame.frameValue = targetFrame->frameValue();
-    m_currentStepFrame.description = targetFrame->description().cStr();
-    m_fieldDataMap.clear();
+    std::size_t framesWithField = 0;
+    std::size_t lookups = 0;
+    for (std::size_t f = 0; f < numFrames; ++f) {
+        // ODB API 不保证线程安全，逐帧加锁，允许界面和预取线程在帧之间插入
+        std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+        const odb_FieldOutputRepository& fieldOutputs = odbFrames[f]->fieldOutputs();
+        if (!fieldOutputs.isMember(fieldName.c_str())) {
+            continue;
+        }
+        const odb_FieldOutput& fieldOutput = fieldOutputs[fieldName.c_str()];
+        const odb_SequenceString& labels = fieldOutput.componentLabels();
+        int component = -1;
+        for (int c = 0; c < labels.size(); ++c) {
+            if (componentLabel == labels[c].cStr()) {
+                component = c;
+                break;
+            }
+        }
+        if (component < 0) {
+            continue;
+        }
+        history.isNodal = fieldOutput.locations()[0].position() == odb_Enum::NODAL;
+        ++framesWithField;
+
+        for (HistoryTarget& target : targets) {
+            const odb_Set* set = historySet(target, history.isNodal);
+            if (!target.instance) continue;
+            // 只取请求的实体，数据块大小与模型规模无关；集合数已达上限时退化为本实例的子集
+            const odb_FieldOutput subset = set ? fieldOutput.getSubset(*set) : fieldOutput.getSubset(*target.instance);
+            const odb_SequenceFieldBulkData& bulkDataBlocks = subset.bulkDataBlocks();
+            const int numBlocks = bulkDataBlocks.size();
+            if (target.layouts.size() < static_cast<std::size_t>(numBlocks)) {
+                target.layouts.resize(static_cast<std::size_t>(numBlocks));
+            }
+            for (int b = 0; b < numBlocks; ++b) {
+                const odb_FieldBulkData& block = bulkDataBlocks[b];
+                const std::size_t width = static_cast<std::size_t>(block.width());
+                if (static_cast<std::size_t>(component) >= width) continue;
+                const int count = history.isNodal ? block.length() : block.numberOfElements();
+                const int* blockLabel = history.isNodal ? block.nodeLabels() : block.elementLabels();
+
+                // 各帧数据块的布局通常相同：位置到实体的对应只在布局变化时重新解析
+                HistoryBlockLayout& layout = target.layouts[b];
+                if (layout.labels.size() != static_cast<std::size_t>(count) ||
+                    !std::equal(blockLabel, blockLabel + count, layout.labels.begin())) {
+                    ++lookups;
+                    layout.labels.assign(blockLabel, blockLabel + count);
+                    layout.entities.assign(static_cast<std::size_t>(count), SIZE_MAX);
+                    for (int i = 0; i < count; ++i) {
+                        auto it = target.slots.find(blockLabel[i]);
+                        if (it != target.slots.end()) layout.entities[i] = it->second;
+                    }
+                }
 
-    const odb_FieldOutputRepository& fieldOutputs = targetFrame->fieldOutputs();
-    if (!fieldOutputs.isMember(fieldName.c_str())) {
-        std::cerr << "[Error] Field '" << fieldName << "' not found in frame." << std::endl;
-        return false;
+                const std::size_t numIP = history.isNodal ? 1
+                    : static_cast<std::size_t>(block.length() / std::max(1, block.numberOfElements()));
+                const float* data = block.data();
+                for (int i = 0; i < count; ++i) {
+                    const std::size_t j = layout.entities[i];
+                    if (j == SIZE_MAX) continue;
+                    const float* rows = data + static_cast<std::size_t>(i) * numIP * width + component;
+                    const std::size_t slot = j * numFrames + f;
+                    history.values[slot] = reducePointValues(rows, numIP, width, m_ipReduction, m_selectedPoint);
+                    history.validFlags[slot] = 1;
+                }
+            }
+        }
     }
-    const odb_FieldOutput& F = fieldOutputs[fieldName.c_str()];
 
-    if (fieldName == "U") {
-        readDisplacementField(F);
-    } else if (fieldName == "UR") {
-        readRotationField(F);
-    } else if (fieldName == "S") {
-        readStressField(F);
-    } else {
-        readGenericField(F, fieldName);
+    for (std::size_t j = 0; j < entities.size(); ++j) {
+        if (primary[j] == j) continue;
+        std::copy_n(history.values.begin() + primary[j] * numFrames, numFrames, history.values.begin() + j * numFrames);
+        std::copy_n(history.validFlags.begin() + primary[j] * numFrames, numFrames,
+                    history.validFlags.begin() + j * numFrames);
     }
 
-    m_hasFieldData = !m_fieldDataMap.empty();
+    ODB_LOG_INFO("Read time history of " << fieldName << "." << componentLabel << " for "
+                 << entities.size() << " entities over " << framesWithField << " / " << numFrames
+                 << " frames (" << lookups << " block layouts resolved).");
+    return framesWithField > 0;
+}
 
-    return true;
+const odb_Set* readOdb::historySet(HistoryTarget& target, bool isNodal)
+{
+    odb_InstanceRepository& instances = m_odb->rootAssembly().instances();
+    const odb_String instanceKey(target.instanceName.c_str());
+    if (!target.resolved) {
+        target.resolved = true;
+        if (instances.isMember(instanceKey)) {
+            target.instance = &instances[instanceKey];
+        } else {
+            ODB_LOG_WARNING("Instance '" << target.instanceName << "' not found for time history.");
+        }
+    }
+    const odb_Set*& set = isNodal ? target.nodeSet : target.elementSet;
+    if (set || !target.instance) {
+        return set;
+    }
+
+    std::vector<int> sortedLabels;
+    sortedLabels.reserve(target.slots.size());
+    for (const auto& slot : target.slots) {
+        sortedLabels.push_back(slot.first);
+    }
+    std::sort(sortedLabels.begin(), sortedLabels.end());
+    auto key = std::make_tuple(target.instanceName, isNodal, std::move(sortedLabels));
+    auto it = m_historySets.find(key);
+    if (it != m_historySets.end()) {
+        set = it->second;
+        return set;
+    }
+    if (m_historySets.size() >= kMaxHistorySets) {
+        ODB_LOG_DEBUG("Time history set limit reached, reading instance subsets.");
+        return nullptr;
+    }
+    odb_SequenceInt labels;
+    for (int label : std::get<2>(key)) {
+        labels.append(label);
+    }
+    const std::string name = "ODBVIEWER_HISTORY_" + std::to_string(m_historySets.size());
+    odb_Instance& instance = instances[instanceKey];
+    set = isNodal ? &instance.NodeSetFromNodeLabels(odb_String(name.c_str()), labels)
+                  : &instance.ElementSetFromElementLabels(odb_String(name.c_str()), labels);
+    m_historySets.emplace(std::move(key), set);
+    return set;
+}
+
+void readOdb::cancelPrefetch()
+{
+    m_prefetcher.cancel();
+}
+
+void readOdb::prefetchField(const FieldCacheKey& key)
+{
+    if (m_prefetcher.cancelRequested() || m_fieldCache.contains(key)) {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    if (m_prefetcher.cancelRequested() || m_fieldCache.contains(key)) {
+        return;
+    }
+    const odb_Frame* frame = findFrame(key.stepName, key.frameIndex);
+    if (!frame) {
+        return;
+    }
+    const odb_FieldOutputRepository& fieldOutputs = frame->fieldOutputs();
+    if (!fieldOutputs.isMember(key.fieldName.c_str())) {
+        return;
+    }
+
+    tracing::Span span("prefetchField", "reader");
+    FieldData fieldData;
+    {
+        ExtractCancelScope cancelScope(m_extractCancel, m_prefetcher.cancelFlag());
+        fieldData = readFieldByName(fieldOutputs[key.fieldName.c_str()], key.fieldName);
+    }
+    // 提取中途被取消时结果不完整，直接丢弃
+    if (m_prefetcher.cancelRequested()) {
+        return;
+    }
+    packFieldData(fieldData, m_fieldStorage);
+    m_fieldCache.insert(key, std::make_shared<const FieldData>(std::move(fieldData)));
+    ODB_LOG_DEBUG("Prefetched field '" << key.fieldName << "' for step '" << key.stepName
+                  << "', frame " << key.frameIndex << ".");
 }
 
-void readOdb::readGenericField(const odb_FieldOutput& fieldOutput, const std::string& name)
+FieldData readOdb::readGenericField(const odb_FieldOutput& fieldOutput, const std::string& name)
 {
     FieldData fieldData;
     fieldData.type = FieldType::GENERIC;
@@ -399,18 +1197,124 @@ void readOdb::readGenericField(const odb_FieldOutput& fieldOutput, const std::st
     fieldData.components = static_cast<int>(fieldOutput.componentLabels().size());
 
     extractFieldData(fieldOutput, fieldData);
-    m_fieldDataMap[name] = std::move(fieldData);
+    return fieldData;
+}
+
+FieldData readOdb::readFieldByName(const odb_FieldOutput& fieldOutput, const std::string& fieldName)
+{
+    if (fieldName == "U") {
+        return readDisplacementField(fieldOutput);
+    } else if (fieldName == "UR") {
+        return readRotationField(fieldOutput);
+    } else if (fieldName == "S") {
+        return readStressField(fieldOutput);
+    }
+    return readGenericField(fieldOutput, fieldName);
+}
+
+void readOdb::storeFieldData(FieldData&& fieldData)
+{
+    packFieldData(fieldData, m_fieldStorage);
+    auto shared = std::make_shared<const FieldData>(std::move(fieldData));
+    FieldCacheKey key{m_currentStepFrame.stepName, m_currentStepFrame.frameIndex, shared->name};
+    m_fieldCache.insert(key, shared);
+    m_fieldDataMap[shared->name] = std::move(shared);
+}
+
+bool readOdb::useCachedField(const std::string& fieldName)
+{
+    std::shared_ptr<const FieldData> cached =
+        findCachedField(FieldCacheKey{m_currentStepFrame.stepName, m_currentStepFrame.frameIndex, fieldName});
+    if (!cached) {
+        return false;
+    }
+    m_fieldDataMap[fieldName] = std::move(cached);
+    return true;
+}
+
+std::shared_ptr<const FieldData> readOdb::findCachedField(const FieldCacheKey& key)
+{
+    std::shared_ptr<const FieldData> cached = m_fieldCache.find(key);
+    if (!cached) {
+        return nullptr;
+    }
+    // 缓存的场按旧的汇总方式计算：保留了积分点时重新汇总即可，否则需要重新读取
+    if (!cached->isNodal && (cached->reduction != m_ipReduction || cached->selectedPoint != m_selectedPoint)) {
+        if (!cached->integrationPoints) {
+            return nullptr;
+        }
+        cached = withReduction(*cached, m_ipReduction, m_selectedPoint);
+        m_fieldCache.insert(key, cached);
+    }
+    return cached;
+}
+
+void readOdb::logFieldCacheStats() const
+{
+    if (!tracing::logEnabled(LogLevel::Debug)) {
+        return;
+    }
+    const FieldCacheStats stats = m_fieldCache.stats();
+    ODB_LOG_DEBUG("Field cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.evictions << " evictions, " << stats.entries << " entries, "
+                  << (stats.bytes >> 20) << " / " << (stats.byteBudget >> 20) << " MiB.");
+}
+
+void readOdb::setExtractionThreads(int threads)
+{
+    m_extractionThreads = std::max(0, threads);
+    m_extractPool.reset();
 }
 
 std::vector<StepFrameInfo> readOdb::getAvailableStepsFrames() const
 {
-    return m_availableStepsFrames;
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    std::vector<StepFrameInfo> frames;
+    for (const StepCatalogEntry& entry : m_steps) {
+        for (int pos = 0; pos < entry.frameCount; ++pos) {
+            frames.push_back(frameInfoAt(entry, pos));
+        }
+    }
+    return frames;
+}
+
+std::vector<std::string> readOdb::getStepNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(m_steps.size());
+    for (const StepCatalogEntry& entry : m_steps) {
+        names.push_back(entry.name);
+    }
+    return names;
+}
+
+int readOdb::getFrameCount(const std::string& stepName) const
+{
+    const StepCatalogEntry* entry = findStep(stepName);
+    return entry ? entry->frameCount : 0;
+}
+
+bool readOdb::getFrameInfo(const std::string& stepName, int position, StepFrameInfo& info) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const StepCatalogEntry* entry = findStep(stepName);
+    if (!entry || position < 0 || position >= entry->frameCount) {
+        return false;
+    }
+    info = frameInfoAt(*entry, position);
+    return true;
 }
 
 const FieldData* readOdb::getFieldData(const std::string& fieldName) const
 {
     auto it = m_fieldDataMap.find(fieldName);
-    return (it != m_fieldDataMap.end()) ? &it->second : nullptr;
+    return (it != m_fieldDataMap.end()) ? it->second.get() : nullptr;
+}
+
+std::shared_ptr<const FieldData> readOdb::shareFieldData(const std::string& fieldName) const
+{
+    auto it = m_fieldDataMap.find(fieldName);
+    return (it != m_fieldDataMap.end()) ? it->second : nullptr;
 }
 
 bool readOdb::hasFieldData(const std::string& fieldName) const
@@ -423,80 +1327,70 @@ StepFrameInfo readOdb::getCurrentStepFrame() const
     return m_currentStepFrame;
 }
 
-const std::string& readOdb::getOdbPath() const { return m_odbPath; }
-const std::string& readOdb::getOdbBaseName() const { return m_odbBaseName; }
-const std::string& readOdb::getOdbFullName() const { return m_odbFullName; }
-
-void readOdb::releaseGeometryCache()
-{
-    std::vector<nodeCoord>().swap(m_nodesCoord);
-    std::vector<std::vector<std::size_t>>().swap(m_elementsConn);
-    std::vector<std::string>().swap(m_elementTypes);
-    std::cout << "[Info] Released geometry caches: nodesCoord, elementsConn, elementTypes." << std::endl;
-}
-
-//字段名与该字段的组件标签列表（例如 {"U", {"U1","U2","U3"}} ）
+//字段名与该字段的组件标签列表（例如 {"U", {"U1","U2","U3"}} ），取自场目录
 std::vector<std::pair<std::string, std::vector<std::string>>>
 readOdb::listFieldNames(const std::string& stepName, int frameIndex) const
 {
     std::vector<std::pair<std::string, std::vector<std::string>>> result;
-
-    const odb_String& stepNameOdbStr = odb_String(stepName.c_str());
-    const odb_StepRepository& steps = m_odb->steps();
-    if (!steps.isMember(stepNameOdbStr)) {
-        std::cerr << "[Error] Step '" << stepName << "' not found." << std::endl;
-        return result;
+    for (const FieldCatalogEntry* field : listFields(stepName, frameIndex)) {
+        result.emplace_back(field->name, field->componentLabels);
     }
+    return result;
+}
 
-    const odb_Step& step = steps.constGet(stepNameOdbStr);
-    const odb_SequenceFrame& allFramesInStep = step.frames();
-
-    const odb_Frame* targetFrame = nullptr;
-    for (int i = 0; i < allFramesInStep.size(); ++i) {
-        const odb_Frame& frame = allFramesInStep[i];
-        if (frame.frameId() == frameIndex) {
-            targetFrame = &frame;
-            break;
-        }
-    }
-    if (!targetFrame) {
-        std::cerr << "[Error] Frame " << frameIndex << " not found in step '" << stepName << "'." << std::endl;
+std::vector<const FieldCatalogEntry*> readOdb::listFields(const std::string& stepName, int frameIndex) const
+{
+    std::vector<const FieldCatalogEntry*> result;
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const StepCatalogEntry* entry = findStep(stepName);
+    const int position = entry ? framePosition(*entry, frameIndex) : -1;
+    if (position < 0) {
+        ODB_LOG_ERROR("Frame " << frameIndex << " not found in step '" << stepName << "'.");
         return result;
     }
+    // 按场首次出现在目录中的顺序排列
+    for (std::uint16_t id : frameFieldsAt(*entry, position)) {
+        result.push_back(&m_fieldCatalog[id]);
+    }
+    return result;
+}
 
-    const odb_FieldOutputRepository& fieldOutputs = targetFrame->fieldOutputs();
-    try {
-        odb_FieldOutputRepositoryIT foIter(fieldOutputs);
-        for (foIter.first(); !foIter.isDone(); foIter.next()) {
-            std::string fname = foIter.currentKey().CStr();
-            const odb_FieldOutput& fo = foIter.currentValue();
-            std::vector<std::string> comps;
-            const odb_SequenceString& componentLabels = fo.componentLabels();
-            for (int c = 0; c < componentLabels.size(); ++c) {
-                comps.emplace_back(componentLabels[c].cStr());
-            }
-            result.emplace_back(std::move(fname), std::move(comps));
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "[Error] Failed to list field names: " << e.what() << std::endl;
+bool readOdb::isFieldInFrame(const std::string& stepName, int frameIndex, const std::string& fieldName) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const StepCatalogEntry* entry = findStep(stepName);
+    const int position = entry ? framePosition(*entry, frameIndex) : -1;
+    if (position < 0) {
+        return false;
     }
+    const std::vector<std::uint16_t>& ids = frameFieldsAt(*entry, position);
+    auto it = m_fieldIndexByName.find(fieldName);
+    return it != m_fieldIndexByName.end() && std::binary_search(ids.begin(), ids.end(), it->second);
+}
 
-    // 若迭代方式不可用或无结果，回退到常用字段探测
-    if (result.empty()) {
-        const char* commonFields[] = {"U", "UR", "S"};
-        for (const char* name : commonFields) {
-            if (fieldOutputs.isMember(name)) {
-                const odb_FieldOutput& fo = fieldOutputs[name];
-                std::vector<std::string> comps;
-                const odb_SequenceString& componentLabels = fo.componentLabels();
-                for (int c = 0; c < componentLabels.size(); ++c) {
-                    comps.emplace_back(componentLabels[c].cStr());
-                }
-                result.emplace_back(std::string(name), std::move(comps));
-            }
+const FieldCatalogEntry* readOdb::getFieldInfo(const std::string& fieldName) const
+{
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    auto it = m_fieldIndexByName.find(fieldName);
+    return it != m_fieldIndexByName.end() ? &m_fieldCatalog[it->second] : nullptr;
+}
+
+std::vector<int> readOdb::getFieldFrames(const std::string& stepName, const std::string& fieldName) const
+{
+    std::vector<int> frames;
+    std::lock_guard<std::recursive_mutex> lock(m_odbMutex);
+    const StepCatalogEntry* entry = findStep(stepName);
+    if (!entry) {
+        return frames;
+    }
+    for (int pos = 0; pos < entry->frameCount; ++pos) {
+        const std::vector<std::uint16_t>& ids = frameFieldsAt(*entry, pos);
+        auto it = m_fieldIndexByName.find(fieldName);
+        if (it != m_fieldIndexByName.end() && std::binary_search(ids.begin(), ids.end(), it->second)) {
+            frames.push_back(frameInfoAt(*entry, pos).frameIndex);
         }
     }
-    return result;
+    return frames;
 }
 
 std::vector<std::string> readOdb::getLoadedFieldNames() const
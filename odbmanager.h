@@ -1,123 +1,234 @@
 #ifndef ODBMANAGER_H
 #define ODBMANAGER_H
 
+#include <map>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <deque>
 #include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
 #include <odb_API.h>
 
 #include "global.h"
-
-struct nodeCoord {
-    double x{0}, y{0}, z{0};
-    nodeCoord() = default;
-    nodeCoord(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
-};
-
-enum class FieldType {
-    DISPLACEMENT,
-    ROTATION,
-    STRESS,
-    GENERIC
-};
-
-struct StepFrameInfo {
-    std::string stepName;
-    int frameIndex;
-    double frameValue;
-    std::string description;
-};
-
-struct FieldData {
-    FieldType type;
-    std::string name;
-    std::string description;
-    std::vector<std::string> componentLabels;
-    int components{0};
-
-    std::vector<float> values;       // 统一存储场数据 [globalIdx * components + comp]
-    std::vector<uint8_t> validFlags; // 统一有效性标志 (0/1)
-    bool isNodal{true};              // 标记是节点数据还是单元数据
-    std::string unit;
-};
-
-struct InstanceInfo {
-    std::string name;
-    std::size_t nodeStartIndex{0};
-    std::size_t nodeCount{0};
-    std::size_t elementStartIndex{0};
-    std::size_t elementCount{0};
-
-    std::unordered_map<int, std::size_t> nodeLabelToIndex;
-    std::unordered_map<int, std::size_t> elementLabelToIndex;
-};
-
-class readOdb {
+#include "resultsource.h"
+#include "fielddata.h"
+#include "fieldcache.h"
+#include "fieldstats.h"
+#include "frameprefetcher.h"
+#include "partitionedwriter.h"
+#include "threadpool.h"
+
+// Abaqus ODB 结果源
+class readOdb : public ResultSource {
 public:
-    readOdb(const char* odbFullname);
-    ~readOdb();
-
-	// 模型实例信息接口
-    const std::vector<InstanceInfo>& getInstanceInfos() const { return m_instanceInfos; }
+    // useGeometryCache 为 true 时优先从 .odb 旁的几何缓存加载，缓存失效则重建并写回
+    // progress 在构造期间（可能在工作线程中）被调用，构造完成后不再使用
+    readOdb(const char* odbFullname, bool useGeometryCache = false,
+            LoadProgressCallback progress = LoadProgressCallback());
+    ~readOdb() override;
 
     //场数据接口
-    bool readFieldOutput(const std::string& stepName, int frameIndex);
-    bool readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName);
-    const FieldData* getFieldData(const std::string& fieldName) const;
-    bool hasFieldData(const std::string& fieldName) const;
+    bool readFieldOutput(const std::string& stepName, int frameIndex) override;
+    bool readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName) override;
+    const FieldData* getFieldData(const std::string& fieldName) const override;
+    std::shared_ptr<const FieldData> shareFieldData(const std::string& fieldName) const override;
+    // 经场缓存读取，命中时不访问 ODB；结果写入缓存但不进入当前帧的场集合
+    std::shared_ptr<const FieldData> loadField(const std::string& stepName, int frameIndex,
+                                               const std::string& fieldName) override;
+    bool hasFieldData(const std::string& fieldName) const override;
     std::vector<std::pair<std::string, std::vector<std::string>>>
         listFieldNames(const std::string& stepName, int frameIndex) const;
-    std::vector<std::string> getLoadedFieldNames() const;
+    std::vector<std::string> getLoadedFieldNames() const override;
+
+    // 场输出目录：每帧的场列表只扫描一次，场元数据跨帧共享，之后的查询不再访问 ODB
+    std::vector<const FieldCatalogEntry*> listFields(const std::string& stepName, int frameIndex) const override;
+    bool isFieldInFrame(const std::string& stepName, int frameIndex, const std::string& fieldName) const override;
+    const FieldCatalogEntry* getFieldInfo(const std::string& fieldName) const override; // 尚未见过的场返回 nullptr
+    // 步内定义该场的全部帧（frameId），首次调用会扫描该步尚未扫描的帧
+    std::vector<int> getFieldFrames(const std::string& stepName, const std::string& fieldName) const;
+
+    // 时间历程：逐帧流式读取，只取指定实体的指定分量，不构建整场数据
+    // 每帧按请求的标签建立的集合取子集，读取量与模型规模无关
+    // stepName 为空时遍历全部分析步；单元场的积分点按当前汇总方式处理
+    bool readTimeHistory(const std::string& fieldName, const std::string& componentLabel,
+                         const std::vector<EntityRef>& entities, TimeHistory& history,
+                         const std::string& stepName = std::string());
+
+    // 流式分块导出：直接从 ODB 逐实例读取写出 .pvtu，不使用已加载的几何与场
+    bool exportPartitioned(const std::string& pvtuFileName, const PartitionedExportOptions& options,
+                           PartitionedExportSummary* summary = nullptr) override;
 
 	// 步与帧信息接口
-    StepFrameInfo getCurrentStepFrame() const;
+    // 打开时只记录步名与帧数；帧的时间与描述在首次访问时读取，按 (步, frameId) 查找为 O(1)
+    StepFrameInfo getCurrentStepFrame() const override;
+    std::vector<std::string> getStepNames() const override;
+    int getFrameCount(const std::string& stepName) const override;
+    // 按帧在步中的位置（0 起）取元数据；位置越界返回 false
+    bool getFrameInfo(const std::string& stepName, int position, StepFrameInfo& info) const override;
+    // 枚举全部帧的元数据，帧数很多时代价较高，仅供确实需要整条时间轴的场合
     std::vector<StepFrameInfo> getAvailableStepsFrames() const;
 
-    // odb文件路径
-    const std::string& getOdbPath() const;
-    const std::string& getOdbBaseName() const;
-    const std::string& getOdbFullName() const;
-    
-    void releaseGeometryCache();
-
-public:
-    std::size_t m_nodesNum{0};
-    std::size_t m_elementsNum{0};
-    std::vector<nodeCoord> m_nodesCoord;
-    std::vector<std::vector<std::size_t>> m_elementsConn;
-    std::vector<std::string> m_elementTypes;
+    // 多帧多场结果缓存：按 (步, 帧, 场) 保留已读取的场，超出字节预算时按 LRU 淘汰
+    void setFieldCacheBudget(std::size_t bytes) { m_fieldCache.setByteBudget(bytes); }
+    FieldCacheStats getFieldCacheStats() const { return m_fieldCache.stats(); }
+    void clearFieldCache() { m_fieldCache.clear(); }
+
+    // 后台预取：加载某帧的场后，在后台线程中读取同一步内相邻 depth 帧的同一场
+    void setPrefetchDepth(int depth) { m_prefetchDepth = depth; }
+    int prefetchDepth() const { return m_prefetchDepth; }
+    void prefetchNeighbours(const std::string& stepName, int frameIndex, const std::string& fieldName) override;
+    void cancelPrefetch();
+
+    // 场数据提取线程数：1 为串行，0 为按硬件并发数自动选择
+    void setExtractionThreads(int threads);
+    int extractionThreads() const { return m_extractionThreads; }
+
+    // 单元场保留全部积分点（默认关闭，内存约为积分点数 + 1 倍）：切换汇总方式只在内存中重新计算；
+    // 关闭时提取过程中直接按当前汇总方式计算，切换汇总方式需要重新读取
+    void setKeepIntegrationPoints(bool keep) override;
+    bool keepIntegrationPoints() const override { return m_keepIntegrationPoints; }
+    // 对已加载的场重新汇总并作为后续读取的默认方式；该场未保留积分点（或 fieldName 为空）时返回 nullptr
+    const FieldData* setIntegrationPointReduction(const std::string& fieldName, IPReduction mode, int selectedPoint = 0) override;
+    IPReduction integrationPointReduction() const override { return m_ipReduction; }
+    int selectedIntegrationPoint() const override { return m_selectedPoint; }
+
+    // 新读取的场的存储方式；FLOAT16 / QUANTIZED16 约减半内存，适合同时保留多帧对比
+    void setFieldStorage(FieldStorage storage) { m_fieldStorage = storage; }
+    FieldStorage fieldStorage() const { return m_fieldStorage; }
+
+    // 数据块覆盖的实体数低于总数的该比例时使用稀疏布局（index 列表 + 紧密排列的值）
+    void setSparseCoverageThreshold(double coverage) { m_sparseCoverage = coverage; }
+    double sparseCoverageThreshold() const { return m_sparseCoverage; }
 
 private:
-    readOdb(const readOdb&) = delete;
-    readOdb& operator=(const readOdb&) = delete;
-
     void initializeGeometry();
+    void reportLoadProgress(const std::string& phase, std::size_t done, std::size_t total) const;
+    std::uint16_t internElementType(const char* typeName);
+    bool loadGeometryCache();       // 实现见 geometrycache.cpp
+    bool saveGeometryCache() const;
     void readStepFrameInfo();
-    std::size_t findGlobalIndex(const std::string& instanceName, int label, bool isNode);
+    std::size_t findGlobalIndex(const std::string& instanceName, int label, bool isNode) const;
+    const InstanceInfo* findInstance(const std::string& instanceName) const;
 
 	//场数据读取辅助函数
     bool readAllFields(const std::string& stepName, int frameIndex);
-    void readDisplacementField(const odb_FieldOutput& fieldOutput);
-    void readRotationField(const odb_FieldOutput& fieldOutput);
-    void readStressField(const odb_FieldOutput& fieldOutput);
-    void readGenericField(const odb_FieldOutput& fieldOutput, const std::string& name);
+    FieldData readDisplacementField(const odb_FieldOutput& fieldOutput);
+    FieldData readRotationField(const odb_FieldOutput& fieldOutput);
+    FieldData readStressField(const odb_FieldOutput& fieldOutput);
+    FieldData readGenericField(const odb_FieldOutput& fieldOutput, const std::string& name);
+    FieldData readFieldByName(const odb_FieldOutput& fieldOutput, const std::string& fieldName);
+    const odb_Frame* findFrame(const std::string& stepName, int frameIndex) const;
+    struct StepCatalogEntry;
+    const StepCatalogEntry* findStep(const std::string& stepName) const;
+    int framePosition(const StepCatalogEntry& entry, int frameId) const;
+    const StepFrameInfo& frameInfoAt(const StepCatalogEntry& entry, int position) const;
+    const std::vector<std::uint16_t>& frameFieldsAt(const StepCatalogEntry& entry, int position) const;
+    std::uint16_t catalogField(const odb_FieldOutput& fieldOutput, const std::string& name) const;
+    void setCurrentFrame(const std::string& stepName, int frameIndex, const odb_Frame& frame);
+    void prefetchField(const FieldCacheKey& key);
+
+    // 时间历程按实例读取的目标：请求的标签、由标签创建的节点 / 单元集合，以及各数据块已解析的布局
+    struct HistoryBlockLayout {
+        std::vector<int> labels;
+        std::vector<std::size_t> entities; // 数据块第 i 个位置对应的实体序号，不在请求中为 SIZE_MAX
+    };
+    struct HistoryTarget {
+        std::string instanceName;
+        std::unordered_map<int, std::size_t> slots; // 标签 -> 实体序号（重复的标签取第一个）
+        const odb_Instance* instance{nullptr};      // 首次使用时解析，实例不存在时保持为空
+        bool resolved{false};
+        const odb_Set* nodeSet{nullptr};
+        const odb_Set* elementSet{nullptr};
+        std::vector<HistoryBlockLayout> layouts;
+    };
+    // 由目标的标签建立（或复用）节点 / 单元集合；集合数达到上限或实例不存在时返回空，调用方改按实例取子集
+    const odb_Set* historySet(HistoryTarget& target, bool isNodal);
+
     void extractFieldData(const odb_FieldOutput& fieldOutput, FieldData& fieldData);
+    void storeFieldData(FieldData&& fieldData);
+    bool useCachedField(const std::string& fieldName);
+    std::shared_ptr<const FieldData> findCachedField(const FieldCacheKey& key); // 按当前汇总方式取缓存，需重新读取时返回空
+    void logFieldCacheStats() const;
+
+    // 从 ODB 数据块取出的原始指针视图；ODB API 只在调用线程访问，工作线程只读这些数组
+    struct BulkBlockView {
+        const float* data{nullptr};
+        const int* labels{nullptr};
+        const InstanceInfo* instance{nullptr};
+        int count{0};           // 节点数或单元数
+        int width{0};           // 组件数
+        int valuesPerEntity{1}; // 每个单元的积分点数，节点数据为 1
+    };
+    std::size_t resolveBlockIndex(const BulkBlockView& block, int i, bool isNodal) const;
+    static std::size_t findSlot(const FieldData& fieldData, std::size_t globalIdx);
+    void extractBlockRange(const BulkBlockView& block, int begin, int end, FieldData& fieldData,
+                           IntegrationPointData* points, FieldStatsAccumulator* stats) const;
+    // 同一实体出现在多个数据块中（多截面点、多区域输出）时返回 true
+    bool blocksOverlap(const std::vector<BulkBlockView>& blocks, bool isNodal, std::size_t entityCount) const;
+    // 按数据块切分任务；总量较小、单线程或数据块有重叠（disjoint 为 false）时在调用线程按块顺序串行执行
+    void forEachBlockRange(const std::vector<BulkBlockView>& blocks, std::size_t totalEntities, bool disjoint,
+                           const std::function<void(const BulkBlockView&, int, int)>& fn);
+    void reduceFieldValues(FieldData& fieldData);
+    std::shared_ptr<const FieldData> withReduction(const FieldData& source, IPReduction mode, int selectedPoint);
+    ThreadPool* acquireExtractPool(std::size_t workItems);
 
 private:
-    std::string m_odbFullName;
-    std::string m_odbPath;
-    std::string m_odbBaseName;
     odb_Odb* m_odb;
-
-    std::vector<InstanceInfo> m_instanceInfos;
-
-    std::vector<StepFrameInfo> m_availableStepsFrames;
+    LoadProgressCallback m_loadProgress;
+
+    std::unordered_map<std::string, std::size_t> m_instanceIndexByName;
+    std::unordered_map<std::string, std::uint16_t> m_elementTypeIndex;
+
+    // 分析步目录：frames 指向 ODB 持有的帧序列；帧元数据与 frameId 索引懒加载，
+    // 访问时需持有 m_odbMutex
+    struct StepCatalogEntry {
+        std::string name;
+        const odb_SequenceFrame* frames{nullptr};
+        int frameCount{0};
+        mutable std::vector<StepFrameInfo> frameInfos; // 按位置，frameLoaded 为 1 时有效
+        mutable std::vector<std::uint8_t> frameLoaded;
+        mutable bool indexed{false};                   // frameId 与位置不一致时才建立 positionById
+        mutable std::unordered_map<int, int> positionById;
+        mutable std::vector<std::vector<std::uint16_t>> frameFields; // 按位置，各帧含有的场编号（升序）
+        mutable std::vector<std::uint8_t> fieldsScanned;
+    };
+    std::vector<StepCatalogEntry> m_steps;
+    std::unordered_map<std::string, std::size_t> m_stepIndexByName;
+    // 场目录：deque 保证追加时已返回的指针仍然有效
+    mutable std::deque<FieldCatalogEntry> m_fieldCatalog;
+    mutable std::unordered_map<std::string, std::uint16_t> m_fieldIndexByName;
     StepFrameInfo m_currentStepFrame;
 
-    std::unordered_map<std::string, FieldData> m_fieldDataMap;
+    std::unordered_map<std::string, std::shared_ptr<const FieldData>> m_fieldDataMap; // 当前帧已加载的场
+    FieldCache m_fieldCache;
     bool m_hasFieldData{false};
+
+    int m_extractionThreads{0};
+    std::unique_ptr<ThreadPool> m_extractPool;
+    const std::atomic<bool>* m_extractCancel{nullptr}; // 非空时提取过程轮询该标志以提前结束
+
+    bool m_keepIntegrationPoints{false};
+    IPReduction m_ipReduction{IPReduction::FIRST_POINT};
+    int m_selectedPoint{0};
+    FieldStorage m_fieldStorage{FieldStorage::FLOAT32};
+    double m_sparseCoverage{0.25};
+
+    // ODB API 不保证线程安全，所有访问 ODB 的入口都需持有该锁
+    mutable std::recursive_mutex m_odbMutex;
+    int m_prefetchDepth{1};
+    // 时间历程建立的集合只存在于本次打开的 ODB 内存中且无法删除：按 (实例, 节点/单元, 标签列表) 复用，
+    // 总数不超过 kMaxHistorySets，之后的新标签列表按实例取子集
+    static constexpr std::size_t kMaxHistorySets = 64;
+    std::map<std::tuple<std::string, bool, std::vector<int>>, const odb_Set*> m_historySets;
+    FramePrefetcher m_prefetcher; // 最后声明，保证析构时最先停止
 };
 
 #endif // ODBMANAGER_H
@@ -0,0 +1,464 @@
+#include "partitionedwriter.h"
+#include "odbmanager.h"
+#include "creategrid.h"
+#include "fieldkernels.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+#include <vtkIntArray.h>
+
+namespace {
+
+constexpr std::uint32_t kNoPiece = UINT32_MAX;
+
+std::string xmlEscape(const std::string& text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default: out += c; break;
+        }
+    }
+    return out;
+}
+
+// 切块导出建立的集合只存在于打开的 ODB 内存中且无法删除：名称由块的单元范围决定，内容只取决于该范围，
+// 同一 ODB 上重复导出（块大小相同）时直接复用，每个实例的集合数不超过其块数的两倍
+odb_String pieceSetName(bool isNodal, std::size_t begin, std::size_t end)
+{
+    const std::string name = std::string(isNodal ? "ODBVIEWER_PIECE_N_" : "ODBVIEWER_PIECE_E_")
+        + std::to_string(begin) + "_" + std::to_string(end);
+    return odb_String(name.c_str());
+}
+
+vtkSmartPointer<vtkFloatArray> makeZeroArray(const std::string& name, int components, std::size_t tuples)
+{
+    vtkSmartPointer<vtkFloatArray> arr = vtkSmartPointer<vtkFloatArray>::New();
+    arr->SetName(name.c_str());
+    arr->SetNumberOfComponents(components);
+    arr->SetNumberOfTuples(static_cast<vtkIdType>(tuples));
+    std::fill_n(arr->GetPointer(0), tuples * static_cast<std::size_t>(components), 0.0f);
+    return arr;
+}
+
+} // namespace
+
+PartitionedVtuWriter::PartitionedVtuWriter(odb_Odb& odb)
+    : m_odb(odb)
+{
+}
+
+const odb_Frame* PartitionedVtuWriter::resolveFrame(const PartitionedExportOptions& options,
+                                                    std::string& stepName, int& frameId) const
+{
+    const odb_StepRepository& steps = m_odb.steps();
+    stepName = options.stepName;
+    if (stepName.empty()) {
+        odb_StepRepositoryIT stepIter(steps);
+        for (stepIter.first(); !stepIter.isDone(); stepIter.next()) {
+            stepName = stepIter.currentKey().CStr();
+        }
+    }
+    const odb_String stepNameOdbStr(stepName.c_str());
+    if (stepName.empty() || !steps.isMember(stepNameOdbStr)) {
+        ODB_LOG_ERROR("Step '" << stepName << "' not found.");
+        return nullptr;
+    }
+
+    const odb_SequenceFrame& frames = steps.constGet(stepNameOdbStr).frames();
+    if (frames.size() == 0) {
+        ODB_LOG_ERROR("Step '" << stepName << "' has no frames.");
+        return nullptr;
+    }
+    if (options.frameIndex < 0) {
+        const odb_Frame& frame = frames[frames.size() - 1];
+        frameId = frame.frameId();
+        return &frame;
+    }
+    for (int i = 0; i < frames.size(); ++i) {
+        const odb_Frame& frame = frames[i];
+        if (frame.frameId() == options.frameIndex) {
+            frameId = options.frameIndex;
+            return &frame;
+        }
+    }
+    ODB_LOG_ERROR("Frame " << options.frameIndex << " not found in step '" << stepName << "'.");
+    return nullptr;
+}
+
+bool PartitionedVtuWriter::write(const std::string& pvtuFileName, const PartitionedExportOptions& options,
+                                 PartitionedExportSummary* summary)
+{
+    namespace fs = std::filesystem;
+    tracing::Span span("writePartitioned", "writer");
+
+    std::string stepName;
+    int frameId = 0;
+    const odb_Frame* frame = resolveFrame(options, stepName, frameId);
+    if (!frame) {
+        return false;
+    }
+
+    // 确定导出的场及其数组布局；各分块数组一致，缺数据的实体填 0
+    const odb_FieldOutputRepository& fieldOutputs = frame->fieldOutputs();
+    std::vector<std::string> fieldNames = options.fieldNames;
+    if (fieldNames.empty()) {
+        odb_FieldOutputRepositoryIT fieldIter(fieldOutputs);
+        for (fieldIter.first(); !fieldIter.isDone(); fieldIter.next()) {
+            fieldNames.push_back(fieldIter.currentKey().CStr());
+        }
+    }
+    std::vector<const odb_FieldOutput*> fields;
+    std::vector<ArrayInfo> arrays;
+    for (const std::string& name : fieldNames) {
+        if (!fieldOutputs.isMember(name.c_str())) {
+            ODB_LOG_WARNING("Field '" << name << "' not found in frame, skipped.");
+            continue;
+        }
+        const odb_FieldOutput& fieldOutput = fieldOutputs[name.c_str()];
+        if (fieldOutput.locations().size() == 0) {
+            continue;
+        }
+        ArrayInfo info;
+        info.name = name;
+        info.components = std::max(1, static_cast<int>(fieldOutput.componentLabels().size()));
+        info.isNodal = fieldOutput.locations()[0].position() == odb_Enum::NODAL;
+        fields.push_back(&fieldOutput);
+        arrays.push_back(info);
+    }
+
+    const fs::path pvtuPath = fs::u8path(pvtuFileName);
+    const std::string baseName = pvtuPath.stem().u8string();
+    const fs::path pieceDir = pvtuPath.parent_path() / fs::u8path(baseName);
+    std::error_code ec;
+    fs::create_directories(pieceDir, ec);
+    if (ec) {
+        ODB_LOG_ERROR("Failed to create directory " << pieceDir.u8string() << ": " << ec.message());
+        return false;
+    }
+
+    const std::size_t chunkSize = std::max<std::size_t>(options.maxElementsPerPiece, 1);
+    PartitionedExportSummary result;
+    std::unordered_map<std::string, unsigned char> vtkTypeByName;
+    std::map<std::string, std::size_t> unsupportedPerType;
+    std::size_t danglingElements = 0;
+
+    // 当前实例的常驻数据，逐实例复用
+    std::vector<float> instanceCoords;
+    std::vector<int> nodeLabels;
+    std::vector<int> elementLabels;
+    LabelIndexMap nodeMap;
+    LabelIndexMap elementMap;
+    std::vector<std::uint32_t> pieceOfNode;
+    std::vector<std::uint32_t> pieceNodes;
+    std::vector<std::size_t> elementNodes;
+
+    odb_InstanceRepositoryIT instIter(m_odb.rootAssembly().instances());
+    for (instIter.first(); !instIter.isDone(); instIter.next()) {
+        const std::string instanceName = instIter.currentKey().CStr();
+        const odb_Instance& inst = instIter.currentValue();
+        const odb_SequenceNode& nodeList = inst.nodes();
+        const odb_SequenceElement& elementList = inst.elements();
+        const std::size_t nodeCount = static_cast<std::size_t>(nodeList.size());
+        const std::size_t elementCount = static_cast<std::size_t>(elementList.size());
+
+        instanceCoords.resize(nodeCount * 3);
+        nodeLabels.resize(nodeCount);
+        for (std::size_t i = 0; i < nodeCount; ++i) {
+            const odb_Node& node = nodeList[static_cast<int>(i)];
+            nodeLabels[i] = node.label();
+            const float* const coord = node.coordinates();
+            instanceCoords[3 * i + 0] = coord[0];
+            instanceCoords[3 * i + 1] = coord[1];
+            instanceCoords[3 * i + 2] = coord[2];
+        }
+        nodeMap.build(nodeLabels, 0);
+        elementLabels.resize(elementCount);
+        for (std::size_t e = 0; e < elementCount; ++e) {
+            elementLabels[e] = elementList[static_cast<int>(e)].label();
+        }
+        elementMap.build(elementLabels, 0);
+        pieceOfNode.assign(nodeCount, kNoPiece);
+
+        const std::size_t chunkCount = std::max<std::size_t>(1, (elementCount + chunkSize - 1) / chunkSize);
+        for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            const std::size_t begin = chunk * chunkSize;
+            const std::size_t end = std::min(elementCount, begin + chunkSize);
+            const std::size_t cellCount = end - begin;
+
+            // 单元：本块引用的节点按出现顺序重新编号
+            pieceNodes.clear();
+            vtkSmartPointer<vtkUnsignedCharArray> types = vtkSmartPointer<vtkUnsignedCharArray>::New();
+            types->SetNumberOfTuples(static_cast<vtkIdType>(cellCount));
+            vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+            offsets->SetNumberOfTuples(static_cast<vtkIdType>(cellCount + 1));
+            vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+            connectivity->Allocate(static_cast<vtkIdType>(cellCount * 8));
+            vtkSmartPointer<vtkIntArray> cellLabels = vtkSmartPointer<vtkIntArray>::New();
+            cellLabels->SetName("ElementLabel");
+            cellLabels->SetNumberOfTuples(static_cast<vtkIdType>(cellCount));
+
+            for (std::size_t e = begin; e < end; ++e) {
+                const vtkIdType cell = static_cast<vtkIdType>(e - begin);
+                offsets->SetValue(cell, connectivity->GetNumberOfTuples());
+                cellLabels->SetValue(cell, elementLabels[e]);
+                types->SetValue(cell, VTK_EMPTY_CELL);
+
+                const odb_Element& element = elementList[static_cast<int>(e)];
+                const std::string typeName = element.type().CStr();
+                auto typeIt = vtkTypeByName.find(typeName);
+                if (typeIt == vtkTypeByName.end()) {
+                    const int vtkCellType = CreateVTKUnstucturedGrid::abaqusToVTKCellType(typeName);
+                    typeIt = vtkTypeByName.emplace(typeName, vtkCellType >= 0
+                        ? static_cast<unsigned char>(vtkCellType) : static_cast<unsigned char>(VTK_EMPTY_CELL)).first;
+                }
+                if (typeIt->second == VTK_EMPTY_CELL) {
+                    ++unsupportedPerType[typeName];
+                    continue;
+                }
+
+                int nNodes = 0;
+                const int* const conn = element.connectivity(nNodes);
+                elementNodes.resize(static_cast<std::size_t>(nNodes));
+                bool complete = true;
+                for (int j = 0; j < nNodes && complete; ++j) {
+                    elementNodes[j] = nodeMap.find(conn[j]);
+                    complete = elementNodes[j] != SIZE_MAX;
+                }
+                if (!complete) {
+                    ++danglingElements;
+                    continue;
+                }
+                for (int j = 0; j < nNodes; ++j) {
+                    std::uint32_t& pieceIndex = pieceOfNode[elementNodes[j]];
+                    if (pieceIndex == kNoPiece) {
+                        pieceIndex = static_cast<std::uint32_t>(pieceNodes.size());
+                        pieceNodes.push_back(static_cast<std::uint32_t>(elementNodes[j]));
+                    }
+                    connectivity->InsertNextValue(pieceIndex);
+                }
+                types->SetValue(cell, typeIt->second);
+            }
+            offsets->SetValue(static_cast<vtkIdType>(cellCount), connectivity->GetNumberOfTuples());
+
+            // 没有单元的实例（如参考点）整体作为一块输出其节点
+            if (elementCount == 0) {
+                for (std::size_t i = 0; i < nodeCount; ++i) {
+                    pieceOfNode[i] = static_cast<std::uint32_t>(i);
+                    pieceNodes.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+            const std::size_t pointCount = pieceNodes.size();
+
+            vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+            vtkSmartPointer<vtkFloatArray> coordsArray = vtkSmartPointer<vtkFloatArray>::New();
+            coordsArray->SetNumberOfComponents(3);
+            coordsArray->SetNumberOfTuples(static_cast<vtkIdType>(pointCount));
+            float* coords = coordsArray->GetPointer(0);
+            vtkSmartPointer<vtkIntArray> pointLabels = vtkSmartPointer<vtkIntArray>::New();
+            pointLabels->SetName("NodeLabel");
+            pointLabels->SetNumberOfTuples(static_cast<vtkIdType>(pointCount));
+            for (std::size_t p = 0; p < pointCount; ++p) {
+                const std::size_t local = pieceNodes[p];
+                std::copy_n(&instanceCoords[3 * local], 3, coords + 3 * p);
+                pointLabels->SetValue(static_cast<vtkIdType>(p), nodeLabels[local]);
+            }
+            vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+            points->SetData(coordsArray);
+            grid->SetPoints(points);
+            vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+            cells->SetData(offsets, connectivity);
+            grid->SetCells(types, cells);
+            grid->GetPointData()->AddArray(pointLabels);
+            grid->GetCellData()->AddArray(cellLabels);
+
+            // 场逐个取子集，写入本块数组后即释放：不切块时按实例取子集；切块时按本块的单元与节点建立集合，
+            // 数据块只含本块的实体，读取量与常驻内存都不随实例规模增长
+            const bool chunked = chunkCount > 1;
+            const odb_Set* elementSet = nullptr;
+            const odb_Set* nodeSet = nullptr;
+            if (chunked) {
+                odb_Instance& instance = m_odb.rootAssembly().instances()[instIter.currentKey()];
+                const bool anyNodal = std::any_of(arrays.begin(), arrays.end(), [](const ArrayInfo& a) { return a.isNodal; });
+                const bool anyElement = std::any_of(arrays.begin(), arrays.end(), [](const ArrayInfo& a) { return !a.isNodal; });
+                if (anyElement && cellCount > 0) {
+                    const odb_String name = pieceSetName(false, begin, end);
+                    odb_SetRepository& sets = instance.elementSets();
+                    if (sets.isMember(name)) {
+                        elementSet = &sets[name];
+                    } else {
+                        odb_SequenceInt labels;
+                        for (std::size_t e = begin; e < end; ++e) labels.append(elementLabels[e]);
+                        elementSet = &instance.ElementSetFromElementLabels(name, labels);
+                    }
+                }
+                if (anyNodal && pointCount > 0) {
+                    const odb_String name = pieceSetName(true, begin, end);
+                    odb_SetRepository& sets = instance.nodeSets();
+                    if (sets.isMember(name)) {
+                        nodeSet = &sets[name];
+                    } else {
+                        odb_SequenceInt labels;
+                        for (std::uint32_t local : pieceNodes) labels.append(nodeLabels[local]);
+                        nodeSet = &instance.NodeSetFromNodeLabels(name, labels);
+                    }
+                }
+            }
+
+            // 场：只散布落在本块内的实体
+            for (std::size_t f = 0; f < arrays.size(); ++f) {
+                const ArrayInfo& info = arrays[f];
+                const std::size_t comps = static_cast<std::size_t>(info.components);
+                auto arr = makeZeroArray(info.name, info.components, info.isNodal ? pointCount : cellCount);
+                float* out = arr->GetPointer(0);
+
+                const odb_Set* set = info.isNodal ? nodeSet : elementSet;
+                if (chunked && !set) {
+                    // 本块没有该类实体，数组保持为 0
+                    if (info.isNodal) grid->GetPointData()->AddArray(arr);
+                    else grid->GetCellData()->AddArray(arr);
+                    continue;
+                }
+                const odb_FieldOutput subset = chunked ? fields[f]->getSubset(*set) : fields[f]->getSubset(inst);
+                const odb_SequenceFieldBulkData& blocks = subset.bulkDataBlocks();
+                for (int b = 0; b < blocks.size(); ++b) {
+                    const odb_FieldBulkData& bulk = blocks[b];
+                    const float* data = bulk.data();
+                    const std::size_t width = static_cast<std::size_t>(bulk.width());
+                    const std::size_t numComp = std::min(width, comps);
+                    if (info.isNodal) {
+                        const int* labels = bulk.nodeLabels();
+                        for (int i = 0; i < bulk.length(); ++i) {
+                            const std::size_t local = nodeMap.find(labels[i]);
+                            if (local == SIZE_MAX || pieceOfNode[local] == kNoPiece) continue;
+                            std::copy_n(data + static_cast<std::size_t>(i) * width, numComp,
+                                        out + pieceOfNode[local] * comps);
+                        }
+                    } else {
+                        const int count = bulk.numberOfElements();
+                        const std::size_t valuesPerEntity = count > 0 ? static_cast<std::size_t>(bulk.length() / count) : 1;
+                        const std::size_t stride = valuesPerEntity * width;
+                        const int* labels = bulk.elementLabels();
+                        for (int i = 0; i < count; ++i) {
+                            const std::size_t local = elementMap.find(labels[i]);
+                            if (local == SIZE_MAX || local < begin || local >= end) continue;
+                            const float* src = data + static_cast<std::size_t>(i) * stride;
+                            float* dst = out + (local - begin) * comps;
+                            for (std::size_t c = 0; c < numComp; ++c) {
+                                dst[c] = reducePointValues(src + c, valuesPerEntity, width,
+                                                           options.reduction, options.selectedPoint);
+                            }
+                        }
+                    }
+                }
+                if (info.isNodal) {
+                    grid->GetPointData()->AddArray(arr);
+                } else {
+                    grid->GetCellData()->AddArray(arr);
+                }
+            }
+
+            const std::string pieceName = baseName + "_" + std::to_string(result.pieceCount) + ".vtu";
+            const fs::path piecePath = pieceDir / fs::u8path(pieceName);
+            vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+            writer->SetFileName(piecePath.u8string().c_str());
+            writer->SetInputData(grid);
+            writer->SetDataModeToAppended();
+            writer->EncodeAppendedDataOff();
+            if (writer->Write() == 0) {
+                ODB_LOG_ERROR("Failed to write VTK piece: " << piecePath.u8string());
+                return false;
+            }
+
+            ODB_LOG_DEBUG("Wrote piece " << result.pieceCount << " (" << instanceName << ", elements "
+                          << begin << "-" << end << "): " << pointCount << " nodes, " << cellCount << " cells");
+            result.pieceFiles.push_back(baseName + "/" + pieceName);
+            ++result.pieceCount;
+            result.nodeCount += pointCount;
+            result.elementCount += cellCount;
+            result.largestPieceNodes = std::max(result.largestPieceNodes, pointCount);
+            result.largestPieceElements = std::max(result.largestPieceElements, cellCount);
+
+            // 只复位本块用到的节点，避免每块重写整张表
+            for (std::uint32_t local : pieceNodes) {
+                pieceOfNode[local] = kNoPiece;
+            }
+        }
+    }
+
+    for (const auto& [typeName, count] : unsupportedPerType) {
+        ODB_LOG_WARNING("Unsupported element type \"" << typeName << "\" (" << count
+                        << " elements). Written as empty cells.");
+    }
+    if (danglingElements > 0) {
+        ODB_LOG_WARNING(danglingElements << " elements reference unknown nodes. Written as empty cells.");
+    }
+
+    if (!writeCollection(pvtuFileName, arrays, result.pieceFiles)) {
+        return false;
+    }
+    ODB_LOG_INFO("Partitioned export of " << stepName << " frame " << frameId << ": " << result.pieceCount
+                 << " pieces, largest " << result.largestPieceNodes << " nodes / " << result.largestPieceElements
+                 << " cells");
+    if (summary) {
+        *summary = std::move(result);
+    }
+    return true;
+}
+
+bool PartitionedVtuWriter::writeCollection(const std::string& pvtuFileName, const std::vector<ArrayInfo>& arrays,
+                                           const std::vector<std::string>& pieceFiles) const
+{
+    std::ofstream out(std::filesystem::u8path(pvtuFileName), std::ios::out | std::ios::trunc);
+    if (!out) {
+        ODB_LOG_ERROR("Failed to open " << pvtuFileName << " for writing.");
+        return false;
+    }
+
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+        << "  <PUnstructuredGrid GhostLevel=\"0\">\n"
+        << "    <PPointData>\n"
+        << "      <PDataArray type=\"Int32\" Name=\"NodeLabel\"/>\n";
+    for (const ArrayInfo& info : arrays) {
+        if (info.isNodal) {
+            out << "      <PDataArray type=\"Float32\" Name=\"" << xmlEscape(info.name)
+                << "\" NumberOfComponents=\"" << info.components << "\"/>\n";
+        }
+    }
+    out << "    </PPointData>\n"
+        << "    <PCellData>\n"
+        << "      <PDataArray type=\"Int32\" Name=\"ElementLabel\"/>\n";
+    for (const ArrayInfo& info : arrays) {
+        if (!info.isNodal) {
+            out << "      <PDataArray type=\"Float32\" Name=\"" << xmlEscape(info.name)
+                << "\" NumberOfComponents=\"" << info.components << "\"/>\n";
+        }
+    }
+    out << "    </PCellData>\n"
+        << "    <PPoints>\n"
+        << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+        << "    </PPoints>\n";
+    for (const std::string& piece : pieceFiles) {
+        out << "    <Piece Source=\"" << xmlEscape(piece) << "\"/>\n";
+    }
+    out << "  </PUnstructuredGrid>\n"
+        << "</VTKFile>\n";
+
+    out.flush();
+    if (!out) {
+        ODB_LOG_ERROR("Failed to write " << pvtuFileName);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef PARTITIONEDWRITER_H
+#define PARTITIONEDWRITER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <odb_API.h>
+
+#include "resultsource.h"
+
+// 流式分块转换：逐实例（超大实例再按单元切块）读取几何与场，每块写成独立的 .vtu 后立即释放，
+// 最后写出引用全部分块的 .pvtu。常驻内存只有当前实例的节点坐标与标签查找表，
+// 场每次只取一个场在当前分块内的子集（切块时按本块的单元 / 节点集合），
+// 网格与场数组的峰值由最大的分块决定，而不是整个模型
+class PartitionedVtuWriter {
+public:
+    explicit PartitionedVtuWriter(odb_Odb& odb);
+
+    // 分块文件写入 .pvtu 旁与其同名的目录，如 model.pvtu -> model/model_0.vtu
+    bool write(const std::string& pvtuFileName, const PartitionedExportOptions& options,
+               PartitionedExportSummary* summary = nullptr);
+
+private:
+    struct ArrayInfo {
+        std::string name;
+        int components{1};
+        bool isNodal{true};
+    };
+
+    const odb_Frame* resolveFrame(const PartitionedExportOptions& options, std::string& stepName, int& frameId) const;
+    bool writeCollection(const std::string& pvtuFileName, const std::vector<ArrayInfo>& arrays,
+                         const std::vector<std::string>& pieceFiles) const;
+
+    odb_Odb& m_odb;
+};
+
+#endif // PARTITIONEDWRITER_H
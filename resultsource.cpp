@@ -0,0 +1,203 @@
+#include "resultsource.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <numeric>
+
+void ElementConnectivity::reset(bool wide)
+{
+    clear();
+    wideIndex = wide;
+    if (wideIndex) {
+        offsets64 = std::make_shared<std::vector<std::int64_t>>(1, 0);
+        connectivity64 = std::make_shared<std::vector<std::int64_t>>();
+    } else {
+        offsets32 = std::make_shared<std::vector<std::int32_t>>(1, 0);
+        connectivity32 = std::make_shared<std::vector<std::int32_t>>();
+    }
+}
+
+void ElementConnectivity::clear()
+{
+    wideIndex = false;
+    offsets32.reset();
+    connectivity32.reset();
+    offsets64.reset();
+    connectivity64.reset();
+}
+
+void ElementConnectivity::reserveElements(std::size_t count)
+{
+    if (wideIndex) offsets64->reserve(count + 1);
+    else offsets32->reserve(count + 1);
+}
+
+void ElementConnectivity::reserveConnectivity(std::size_t count)
+{
+    if (!wideIndex && count > static_cast<std::size_t>(INT32_MAX)) {
+        promoteToWide();
+    }
+    if (wideIndex) connectivity64->reserve(count);
+    else connectivity32->reserve(count);
+}
+
+void ElementConnectivity::appendElement(const std::size_t* nodes, int count)
+{
+    if (!offsets32 && !offsets64) {
+        reset(false);
+    }
+    if (!wideIndex && connectivity32->size() + static_cast<std::size_t>(count) > static_cast<std::size_t>(INT32_MAX)) {
+        promoteToWide();
+    }
+    if (wideIndex) {
+        for (int j = 0; j < count; ++j) {
+            connectivity64->push_back(static_cast<std::int64_t>(nodes[j]));
+        }
+        offsets64->push_back(static_cast<std::int64_t>(connectivity64->size()));
+    } else {
+        for (int j = 0; j < count; ++j) {
+            connectivity32->push_back(static_cast<std::int32_t>(nodes[j]));
+        }
+        offsets32->push_back(static_cast<std::int32_t>(connectivity32->size()));
+    }
+}
+
+void ElementConnectivity::promoteToWide()
+{
+    // 预估不足（如用户单元节点数很多）时退化为 64 位索引
+    offsets64 = std::make_shared<std::vector<std::int64_t>>(offsets32->begin(), offsets32->end());
+    connectivity64 = std::make_shared<std::vector<std::int64_t>>(connectivity32->begin(), connectivity32->end());
+    offsets32.reset();
+    connectivity32.reset();
+    wideIndex = true;
+}
+
+std::size_t ElementConnectivity::elementCount() const
+{
+    if (wideIndex) return offsets64 ? offsets64->size() - 1 : 0;
+    return offsets32 ? offsets32->size() - 1 : 0;
+}
+
+std::size_t ElementConnectivity::connectivitySize() const
+{
+    if (wideIndex) return connectivity64 ? connectivity64->size() : 0;
+    return connectivity32 ? connectivity32->size() : 0;
+}
+
+std::size_t ElementConnectivity::offset(std::size_t element) const
+{
+    return wideIndex ? static_cast<std::size_t>((*offsets64)[element])
+                     : static_cast<std::size_t>((*offsets32)[element]);
+}
+
+std::size_t ElementConnectivity::nodeAt(std::size_t element, int local) const
+{
+    const std::size_t pos = offset(element) + static_cast<std::size_t>(local);
+    return wideIndex ? static_cast<std::size_t>((*connectivity64)[pos])
+                     : static_cast<std::size_t>((*connectivity32)[pos]);
+}
+
+void LabelIndexMap::build(const std::vector<int>& labels, std::size_t startIndex)
+{
+    clear();
+    m_startIndex = startIndex;
+    m_count = labels.size();
+    if (labels.empty()) {
+        return;
+    }
+
+    const auto [minIt, maxIt] = std::minmax_element(labels.begin(), labels.end());
+    const long long span = static_cast<long long>(*maxIt) - static_cast<long long>(*minIt) + 1;
+    // 跨度不超过标签数两倍（另留少量余量）时使用稠密表，内存与稀疏表同量级
+    m_dense = span <= 2LL * static_cast<long long>(labels.size()) + 1024;
+
+    if (m_dense) {
+        m_minLabel = *minIt;
+        m_localIndex.assign(static_cast<std::size_t>(span), kInvalid);
+        for (std::size_t i = 0; i < labels.size(); ++i) {
+            m_localIndex[static_cast<std::size_t>(labels[i] - m_minLabel)] = static_cast<std::uint32_t>(i);
+        }
+        return;
+    }
+
+    // 稀疏：按标签排序（ODB 中通常已有序，此时跳过排序）
+    std::vector<std::uint32_t> order(labels.size());
+    std::iota(order.begin(), order.end(), 0u);
+    if (!std::is_sorted(labels.begin(), labels.end())) {
+        std::stable_sort(order.begin(), order.end(),
+                         [&labels](std::uint32_t a, std::uint32_t b) { return labels[a] < labels[b]; });
+    }
+    m_sortedLabels.resize(labels.size());
+    m_localIndex.resize(labels.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        m_sortedLabels[i] = labels[order[i]];
+        m_localIndex[i] = order[i];
+    }
+}
+
+void LabelIndexMap::clear()
+{
+    m_dense = true;
+    m_minLabel = 0;
+    m_startIndex = 0;
+    m_count = 0;
+    std::vector<std::uint32_t>().swap(m_localIndex);
+    std::vector<int>().swap(m_sortedLabels);
+}
+
+void LabelIndexMap::exportLabels(std::vector<int>& labels) const
+{
+    labels.assign(m_count, 0);
+    if (m_dense) {
+        for (std::size_t slot = 0; slot < m_localIndex.size(); ++slot) {
+            if (m_localIndex[slot] != kInvalid) {
+                labels[m_localIndex[slot]] = m_minLabel + static_cast<int>(slot);
+            }
+        }
+        return;
+    }
+    for (std::size_t i = 0; i < m_sortedLabels.size(); ++i) {
+        labels[m_localIndex[i]] = m_sortedLabels[i];
+    }
+}
+
+std::size_t LabelIndexMap::findSparse(int label) const
+{
+    // 重复标签时取最后出现的一个，与原 unordered_map 覆盖写入的行为一致
+    auto it = std::upper_bound(m_sortedLabels.begin(), m_sortedLabels.end(), label);
+    if (it == m_sortedLabels.begin() || *(it - 1) != label) {
+        return SIZE_MAX;
+    }
+    return m_startIndex + m_localIndex[static_cast<std::size_t>(it - m_sortedLabels.begin()) - 1];
+}
+
+void ResultSource::setSourceFile(const std::string& fullName)
+{
+    m_odbFullName = fullName;
+    const std::size_t slash = m_odbFullName.find_last_of("/\\");
+    m_odbPath = slash == std::string::npos ? std::string(".") : m_odbFullName.substr(0, slash);
+    m_odbBaseName = slash == std::string::npos ? m_odbFullName : m_odbFullName.substr(slash + 1);
+}
+
+const FieldData* ResultSource::setIntegrationPointReduction(const std::string&, IPReduction, int)
+{
+    return nullptr;
+}
+
+void ResultSource::prefetchNeighbours(const std::string&, int, const std::string&)
+{
+}
+
+bool ResultSource::exportPartitioned(const std::string&, const PartitionedExportOptions&, PartitionedExportSummary*)
+{
+    ODB_LOG_WARNING("Partitioned export is not supported by this result source.");
+    return false;
+}
+
+void ResultSource::releaseGeometryCache()
+{
+    std::vector<nodeCoord>().swap(m_nodesCoord);
+    m_elementsConn.clear();
+    std::vector<std::uint16_t>().swap(m_elementTypeIds);
+    ODB_LOG_INFO("Released geometry caches: nodesCoord, elementsConn, elementTypeIds.");
+}
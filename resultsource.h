@@ -0,0 +1,241 @@
+#ifndef RESULTSOURCE_H
+#define RESULTSOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "fielddata.h"
+
+// 与结果文件格式无关的模型数据类型及结果源接口
+// 网格构建与显示只依赖这里的定义，不需要 odb_API.h，可以在没有 Abaqus 的环境中编译运行
+
+struct nodeCoord {
+    double x{0}, y{0}, z{0};
+    nodeCoord() = default;
+    nodeCoord(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
+};
+
+struct StepFrameInfo {
+    std::string stepName;
+    int frameIndex;
+    double frameValue;
+    std::string description;
+};
+
+// 时间历程查询的实体：实例名 + 节点或单元标签
+struct EntityRef {
+    std::string instanceName;
+    int label{0};
+};
+
+// 若干实体在一组帧上的单一分量时间历程，按实体连续存放
+struct TimeHistory {
+    std::string fieldName;
+    std::string componentLabel;
+    bool isNodal{true};
+    std::vector<EntityRef> entities;
+    std::vector<StepFrameInfo> frames;    // 时间轴
+    std::vector<float> values;            // values[entity * frames.size() + frame]
+    std::vector<std::uint8_t> validFlags; // 与 values 一一对应，实体或场在该帧缺失时为 0
+
+    const float* series(std::size_t entity) const { return values.data() + entity * frames.size(); }
+};
+
+// 场输出目录项：每个场的元数据只从结果文件读取一次
+enum class FieldPrecision : std::uint8_t { UNKNOWN, SINGLE, DOUBLE };
+
+struct FieldCatalogEntry {
+    std::string name;
+    std::string description;
+    std::vector<std::string> componentLabels;
+    bool isNodal{true};
+    // 精度需访问数据块才能得知，在该场第一次被提取时补全
+    FieldPrecision precision{FieldPrecision::UNKNOWN};
+};
+
+// 单元连通性（CSR 布局）：单元 e 的节点为 connectivity[offsets[e] .. offsets[e+1])
+// 索引宽度在加载时按模型规模选择，32 位足够时只占一半内存；
+// 缓冲区以 shared_ptr 持有，便于 VTK 数组零拷贝共享
+struct ElementConnectivity {
+    bool wideIndex{false};
+    std::shared_ptr<std::vector<std::int32_t>> offsets32;
+    std::shared_ptr<std::vector<std::int32_t>> connectivity32;
+    std::shared_ptr<std::vector<std::int64_t>> offsets64;
+    std::shared_ptr<std::vector<std::int64_t>> connectivity64;
+
+    void reset(bool wide);
+    void clear();
+    void reserveElements(std::size_t count);
+    void reserveConnectivity(std::size_t count);
+    void appendElement(const std::size_t* nodes, int count);
+
+    std::size_t elementCount() const;
+    std::size_t connectivitySize() const;
+    std::size_t offset(std::size_t element) const;
+    std::size_t nodeCount(std::size_t element) const { return offset(element + 1) - offset(element); }
+    std::size_t nodeAt(std::size_t element, int local) const;
+
+private:
+    void promoteToWide();
+};
+
+// 实例内标签到全局索引的查找表，在加载几何时一次性构建
+// 标签紧凑时使用稠密数组直接寻址（O(1)），稀疏时退化为有序标签数组二分查找
+class LabelIndexMap {
+public:
+    static constexpr std::uint32_t kInvalid = UINT32_MAX;
+
+    // labels[i] 对应全局索引 startIndex + i
+    void build(const std::vector<int>& labels, std::size_t startIndex);
+    void clear();
+    void exportLabels(std::vector<int>& labels) const; // 按局部索引顺序还原标签
+
+    std::size_t find(int label) const
+    {
+        if (m_dense) {
+            const long long slot = static_cast<long long>(label) - m_minLabel;
+            if (slot < 0 || slot >= static_cast<long long>(m_localIndex.size())) return SIZE_MAX;
+            const std::uint32_t local = m_localIndex[static_cast<std::size_t>(slot)];
+            return local == kInvalid ? SIZE_MAX : m_startIndex + local;
+        }
+        return findSparse(label);
+    }
+    bool isDense() const { return m_dense; }
+    std::size_t size() const { return m_count; }
+
+private:
+    std::size_t findSparse(int label) const;
+
+    bool m_dense{true};
+    int m_minLabel{0};
+    std::size_t m_startIndex{0};
+    std::size_t m_count{0};
+    std::vector<std::uint32_t> m_localIndex; // 稠密：按 label - minLabel 寻址；稀疏：与 m_sortedLabels 对应
+    std::vector<int> m_sortedLabels;
+};
+
+struct InstanceInfo {
+    std::string name;
+    std::size_t nodeStartIndex{0};
+    std::size_t nodeCount{0};
+    std::size_t elementStartIndex{0};
+    std::size_t elementCount{0};
+
+    LabelIndexMap nodeLabelToIndex;
+    LabelIndexMap elementLabelToIndex;
+};
+
+// 分块导出的参数
+struct PartitionedExportOptions {
+    std::string stepName;                        // 空则取最后一个分析步
+    int frameIndex{-1};                          // 小于 0 取该步最后一帧
+    std::vector<std::string> fieldNames;         // 空则导出该帧全部场
+    std::size_t maxElementsPerPiece{1u << 20};   // 实例单元数超过该值时按固定长度切块
+    IPReduction reduction{IPReduction::CENTROID}; // 单元场积分点的汇总方式
+    int selectedPoint{0};
+};
+
+struct PartitionedExportSummary {
+    std::size_t pieceCount{0};
+    std::size_t nodeCount{0};    // 各分块节点数之和，切块边界上的节点会在相邻分块中各出现一次
+    std::size_t elementCount{0};
+    std::size_t largestPieceNodes{0};
+    std::size_t largestPieceElements{0};
+    std::vector<std::string> pieceFiles; // 相对 .pvtu 所在目录的路径
+};
+
+// 打开过程的阶段进度：phase 为阶段说明，done / total 为该阶段完成量；返回 false 请求取消
+using LoadProgressCallback = std::function<bool(const std::string& phase, std::size_t done, std::size_t total)>;
+
+// 进度回调请求取消时由结果源的构造函数抛出，此时文件已关闭、已读取的部分数据已丢弃
+class OdbLoadCancelled : public std::runtime_error {
+public:
+    OdbLoadCancelled() : std::runtime_error("ODB loading cancelled") {}
+};
+
+// 结果源接口：几何、分析步/帧与场数据。readOdb 读取 Abaqus ODB，SyntheticSource 按参数生成模型
+// 几何以公开成员提供，CreateVTKUnstucturedGrid 直接共享其中的缓冲区
+class ResultSource {
+public:
+    virtual ~ResultSource() = default;
+
+    // 模型实例信息接口
+    const std::vector<InstanceInfo>& getInstanceInfos() const { return m_instanceInfos; }
+
+    // 步与帧信息接口
+    virtual std::vector<std::string> getStepNames() const = 0;
+    virtual int getFrameCount(const std::string& stepName) const = 0;
+    // 按帧在步中的位置（0 起）取元数据；位置越界返回 false
+    virtual bool getFrameInfo(const std::string& stepName, int position, StepFrameInfo& info) const = 0;
+    virtual StepFrameInfo getCurrentStepFrame() const = 0;
+
+    // 场数据接口：frameIndex 为 frameId
+    // 已加载的场集合在每次读取时整体替换：readFieldOutput 之后为该帧的全部场，readSingleField 之后只有
+    // fieldName 一个（即使帧未改变，之前读取的场也不再保留）；需要多个场时在每次读取后立即 shareFieldData
+    virtual bool readFieldOutput(const std::string& stepName, int frameIndex) = 0;
+    virtual bool readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName) = 0;
+    virtual const FieldData* getFieldData(const std::string& fieldName) const = 0;
+    // 共享所有权：网格构建可直接引用场数据的缓冲区，切换帧后仍保持有效；未加载时返回空
+    virtual std::shared_ptr<const FieldData> shareFieldData(const std::string& fieldName) const = 0;
+    virtual bool hasFieldData(const std::string& fieldName) const { return getFieldData(fieldName) != nullptr; }
+    // 读取指定帧的场并共享返回，不切换当前帧，也不改变已加载的场集合；帧或场不存在时返回空
+    virtual std::shared_ptr<const FieldData> loadField(const std::string& stepName, int frameIndex,
+                                                       const std::string& fieldName) = 0;
+    virtual std::vector<std::string> getLoadedFieldNames() const = 0;
+
+    // 场输出目录
+    virtual std::vector<const FieldCatalogEntry*> listFields(const std::string& stepName, int frameIndex) const = 0;
+    virtual bool isFieldInFrame(const std::string& stepName, int frameIndex, const std::string& fieldName) const = 0;
+    virtual const FieldCatalogEntry* getFieldInfo(const std::string& fieldName) const = 0;
+
+    // 以下为可选能力，结果源不支持时保持默认实现
+    // 单元场是否保留全部积分点，保留时切换汇总方式无需重新读取
+    virtual void setKeepIntegrationPoints(bool) {}
+    virtual bool keepIntegrationPoints() const { return false; }
+    // 设置后续读取的积分点汇总方式，并对已加载的场重新计算；不支持、fieldName 为空或该场未保留积分点时返回 nullptr
+    virtual const FieldData* setIntegrationPointReduction(const std::string& fieldName, IPReduction mode,
+                                                          int selectedPoint = 0);
+    // 与 FieldData::reduction 的默认值一致
+    virtual IPReduction integrationPointReduction() const { return IPReduction::FIRST_POINT; }
+    virtual int selectedIntegrationPoint() const { return 0; }
+    virtual void prefetchNeighbours(const std::string& stepName, int frameIndex, const std::string& fieldName);
+    virtual bool exportPartitioned(const std::string& pvtuFileName, const PartitionedExportOptions& options,
+                                   PartitionedExportSummary* summary = nullptr);
+
+    // 结果文件路径
+    const std::string& getOdbPath() const { return m_odbPath; }
+    const std::string& getOdbBaseName() const { return m_odbBaseName; }
+    const std::string& getOdbFullName() const { return m_odbFullName; }
+
+    // 网格构建完成后释放坐标与连通性，场数据映射所需的实例查找表保留
+    virtual void releaseGeometryCache();
+
+public:
+    std::size_t m_nodesNum{0};
+    std::size_t m_elementsNum{0};
+    std::vector<nodeCoord> m_nodesCoord;
+    ElementConnectivity m_elementsConn;
+    // 单元类型按名称驻留：每个单元只存 16 位类型编号，名称表每种类型一份
+    std::vector<std::uint16_t> m_elementTypeIds;
+    std::vector<std::string> m_elementTypeNames;
+
+protected:
+    ResultSource() = default;
+    ResultSource(const ResultSource&) = delete;
+    ResultSource& operator=(const ResultSource&) = delete;
+
+    void setSourceFile(const std::string& fullName);
+
+    std::string m_odbFullName;
+    std::string m_odbPath;
+    std::string m_odbBaseName;
+    std::vector<InstanceInfo> m_instanceInfos;
+};
+
+#endif // RESULTSOURCE_H
@@ -0,0 +1,586 @@
+#include "syntheticsource.h"
+#include "fieldstats.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr std::size_t kChunkSize = 1 << 16; // 并行生成时每个任务处理的实体数
+constexpr double kInstanceGap = 0.1;        // 实例之间留出 length 的 10% 间隙
+constexpr double kShellAmplitude = 0.05;    // 壳面起伏幅度，相对 length
+
+// 格的 8 个角点按位编号：bit0 为 x，bit1 为 y，bit2 为 z
+constexpr int kHexCorners[8] = {0, 1, 3, 2, 4, 5, 7, 6};
+constexpr int kQuadCorners[4] = {0, 1, 3, 2};
+// Kuhn 剖分：沿坐标轴的 6 种排列各得一个四面体 (0, a, a|b, 7)；奇排列交换中间两点保证体积为正
+constexpr int kTetCorners[6][4] = {
+    {0, 1, 3, 7}, {0, 2, 6, 7}, {0, 4, 5, 7}, // 偶排列 xyz, yzx, zxy
+    {0, 5, 1, 7}, {0, 3, 2, 7}, {0, 6, 4, 7}, // 奇排列 xzy, yxz, zyx
+};
+
+std::string trim(const std::string& text)
+{
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return std::string();
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string toLower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+} // namespace
+
+std::size_t SyntheticModelSpec::nodeCount() const
+{
+    const std::size_t layers = meshType == SyntheticMeshType::SHELL ? 1 : static_cast<std::size_t>(nz) + 1;
+    return static_cast<std::size_t>(instances) * (static_cast<std::size_t>(nx) + 1)
+        * (static_cast<std::size_t>(ny) + 1) * layers;
+}
+
+std::size_t SyntheticModelSpec::elementCount() const
+{
+    const std::size_t cells = static_cast<std::size_t>(nx) * static_cast<std::size_t>(ny)
+        * (meshType == SyntheticMeshType::SHELL ? 1 : static_cast<std::size_t>(nz));
+    return static_cast<std::size_t>(instances) * cells * (meshType == SyntheticMeshType::TET ? 6 : 1);
+}
+
+SyntheticModelSpec SyntheticModelSpec::forElementCount(SyntheticMeshType type, std::size_t elements, int instances)
+{
+    SyntheticModelSpec spec;
+    spec.meshType = type;
+    spec.instances = std::max(instances, 1);
+    const double perInstance = static_cast<double>(elements) / spec.instances;
+    if (type == SyntheticMeshType::SHELL) {
+        const int n = std::max(1, static_cast<int>(std::lround(std::sqrt(perInstance))));
+        spec.nx = spec.ny = n;
+        spec.nz = 1;
+    } else {
+        const double cells = type == SyntheticMeshType::TET ? perInstance / 6.0 : perInstance;
+        const int n = std::max(1, static_cast<int>(std::lround(std::cbrt(cells))));
+        spec.nx = spec.ny = spec.nz = n;
+    }
+    return spec;
+}
+
+bool SyntheticModelSpec::parse(const std::string& text, SyntheticModelSpec& spec, std::string* error)
+{
+    auto fail = [error](const std::string& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    SyntheticModelSpec result;
+    long long targetElements = 0;
+    std::istringstream in(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            return fail("line " + std::to_string(lineNumber) + ": expected key = value");
+        }
+        const std::string key = toLower(trim(line.substr(0, eq)));
+        const std::string value = trim(line.substr(eq + 1));
+        try {
+            if (key == "type") {
+                const std::string type = toLower(value);
+                if (type == "hex") result.meshType = SyntheticMeshType::HEX;
+                else if (type == "tet") result.meshType = SyntheticMeshType::TET;
+                else if (type == "shell") result.meshType = SyntheticMeshType::SHELL;
+                else return fail("line " + std::to_string(lineNumber) + ": unknown mesh type '" + value + "'");
+            }
+            else if (key == "elements") targetElements = std::stoll(value);
+            else if (key == "nx") result.nx = std::stoi(value);
+            else if (key == "ny") result.ny = std::stoi(value);
+            else if (key == "nz") result.nz = std::stoi(value);
+            else if (key == "instances") result.instances = std::stoi(value);
+            else if (key == "length") result.length = std::stod(value);
+            else if (key == "steps") result.steps = std::stoi(value);
+            else if (key == "frames") result.framesPerStep = std::stoi(value);
+            else return fail("line " + std::to_string(lineNumber) + ": unknown key '" + key + "'");
+        }
+        catch (const std::exception&) {
+            return fail("line " + std::to_string(lineNumber) + ": invalid value '" + value + "'");
+        }
+    }
+
+    if (targetElements > 0) {
+        const SyntheticModelSpec sized = forElementCount(result.meshType, static_cast<std::size_t>(targetElements),
+                                                         result.instances);
+        result.nx = sized.nx;
+        result.ny = sized.ny;
+        result.nz = sized.nz;
+    }
+    if (result.nx < 1 || result.ny < 1 || result.nz < 1 || result.instances < 1
+        || result.steps < 1 || result.framesPerStep < 1 || !(result.length > 0.0)) {
+        return fail("mesh dimensions, instances, steps and frames must be positive");
+    }
+    spec = result;
+    return true;
+}
+
+bool SyntheticModelSpec::loadFile(const std::string& fileName, SyntheticModelSpec& spec, std::string* error)
+{
+    std::ifstream in(fileName);
+    if (!in) {
+        if (error) *error = "cannot open " + fileName;
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return parse(text.str(), spec, error);
+}
+
+SyntheticSource::SyntheticSource(const SyntheticModelSpec& spec, const std::string& name,
+                                 LoadProgressCallback progress, int threads)
+    : m_spec(spec)
+    , m_loadProgress(std::move(progress))
+    , m_pool(ThreadPool::resolveThreadCount(threads))
+{
+    setSourceFile(name);
+
+    m_block.nx = m_spec.nx;
+    m_block.ny = m_spec.ny;
+    m_block.nz = m_spec.meshType == SyntheticMeshType::SHELL ? 0 : m_spec.nz;
+    m_block.h = m_spec.length / m_spec.nx;
+    m_block.pitch = m_spec.length * (1.0 + kInstanceGap);
+    m_nodesPerInstance = m_spec.nodeCount() / static_cast<std::size_t>(m_spec.instances);
+    m_elementsPerInstance = m_spec.elementCount() / static_cast<std::size_t>(m_spec.instances);
+
+    for (int s = 0; s < m_spec.steps; ++s) {
+        m_stepNames.push_back("Step-" + std::to_string(s + 1));
+    }
+
+    FieldCatalogEntry u;
+    u.name = "U";
+    u.description = "Spatial displacement";
+    u.componentLabels = {"U1", "U2", "U3"};
+    u.isNodal = true;
+    u.precision = FieldPrecision::SINGLE;
+    m_fieldCatalog.push_back(u);
+
+    FieldCatalogEntry s;
+    s.name = "S";
+    s.description = "Stress components";
+    if (m_spec.meshType == SyntheticMeshType::SHELL) {
+        s.componentLabels = {"S11", "S22", "S12"}; // 平面应力壳只有面内分量
+    } else {
+        s.componentLabels = {"S11", "S22", "S33", "S12", "S13", "S23"};
+    }
+    s.isNodal = false;
+    s.precision = FieldPrecision::SINGLE;
+    m_fieldCatalog.push_back(s);
+
+    generateGeometry();
+    m_loadProgress = nullptr;
+}
+
+void SyntheticSource::reportLoadProgress(const std::string& phase, std::size_t done, std::size_t total) const
+{
+    if (m_loadProgress && !m_loadProgress(phase, done, total)) {
+        throw OdbLoadCancelled();
+    }
+}
+
+int SyntheticSource::nodesPerElement() const
+{
+    switch (m_spec.meshType) {
+    case SyntheticMeshType::TET: return 4;
+    case SyntheticMeshType::SHELL: return 4;
+    default: return 8;
+    }
+}
+
+const char* SyntheticSource::elementTypeName() const
+{
+    switch (m_spec.meshType) {
+    case SyntheticMeshType::TET: return "C3D4";
+    case SyntheticMeshType::SHELL: return "S4R";
+    default: return "C3D8";
+    }
+}
+
+void SyntheticSource::normalizedNode(std::size_t local, double& xi, double& eta, double& zeta) const
+{
+    const std::size_t nxp = static_cast<std::size_t>(m_block.nx) + 1;
+    const std::size_t nyp = static_cast<std::size_t>(m_block.ny) + 1;
+    xi = static_cast<double>(local % nxp) / m_block.nx;
+    eta = static_cast<double>((local / nxp) % nyp) / m_block.ny;
+    zeta = m_block.nz > 0 ? static_cast<double>(local / (nxp * nyp)) / m_block.nz : 0.0;
+}
+
+void SyntheticSource::nodePosition(std::size_t instance, std::size_t local, double& x, double& y, double& z) const
+{
+    double xi, eta, zeta;
+    normalizedNode(local, xi, eta, zeta);
+    x = instance * m_block.pitch + xi * m_block.nx * m_block.h;
+    y = eta * m_block.ny * m_block.h;
+    if (m_block.nz > 0) {
+        z = zeta * m_block.nz * m_block.h;
+    } else {
+        z = kShellAmplitude * m_spec.length * std::sin(kPi * xi) * std::sin(kPi * eta);
+    }
+}
+
+void SyntheticSource::normalizedCentroid(std::size_t localElement, double& xi, double& eta, double& zeta) const
+{
+    // 四面体取所在格的中心，解析场只需随位置平滑变化
+    const std::size_t cell = m_spec.meshType == SyntheticMeshType::TET ? localElement / 6 : localElement;
+    const std::size_t nx = static_cast<std::size_t>(m_block.nx);
+    const std::size_t ny = static_cast<std::size_t>(m_block.ny);
+    xi = (static_cast<double>(cell % nx) + 0.5) / m_block.nx;
+    eta = (static_cast<double>((cell / nx) % ny) + 0.5) / m_block.ny;
+    zeta = m_block.nz > 0 ? (static_cast<double>(cell / (nx * ny)) + 0.5) / m_block.nz : 0.0;
+}
+
+void SyntheticSource::generateGeometry()
+{
+    tracing::Span span("generateGeometry", "reader");
+    const std::size_t instances = static_cast<std::size_t>(m_spec.instances);
+    const std::size_t totalNodes = m_nodesPerInstance * instances;
+    const std::size_t totalElements = m_elementsPerInstance * instances;
+    const int perElement = nodesPerElement();
+    const std::size_t totalConn = totalElements * static_cast<std::size_t>(perElement);
+
+    m_nodesCoord.clear();
+    m_elementsConn.reset(totalNodes > static_cast<std::size_t>(INT32_MAX)
+                         || totalConn > static_cast<std::size_t>(INT32_MAX));
+    m_elementTypeNames.assign(1, elementTypeName());
+    m_elementTypeIds.assign(totalElements, 0);
+    m_instanceInfos.clear();
+
+    const std::string phase = "Generating geometry";
+    reportLoadProgress(phase, 0, totalNodes + totalElements);
+
+    // 节点坐标：格点编号直接决定坐标，各块互不依赖
+    m_nodesCoord.resize(totalNodes);
+    const std::size_t nodeChunks = (totalNodes + kChunkSize - 1) / kChunkSize;
+    m_pool.parallelFor(nodeChunks, [&](std::size_t chunk) {
+        const std::size_t end = std::min(totalNodes, (chunk + 1) * kChunkSize);
+        for (std::size_t n = chunk * kChunkSize; n < end; ++n) {
+            nodeCoord& c = m_nodesCoord[n];
+            nodePosition(n / m_nodesPerInstance, n % m_nodesPerInstance, c.x, c.y, c.z);
+        }
+    });
+    reportLoadProgress(phase, totalNodes, totalNodes + totalElements);
+
+    // 连通性：单一单元类型，偏移为等差数列，按单元编号并行写入
+    const std::size_t nx = static_cast<std::size_t>(m_block.nx);
+    const std::size_t ny = static_cast<std::size_t>(m_block.ny);
+    const std::size_t nxp = nx + 1;
+    const std::size_t nyp = ny + 1;
+    auto corner = [&](std::size_t cell, int bits) {
+        const std::size_t i = cell % nx + (bits & 1);
+        const std::size_t j = (cell / nx) % ny + ((bits >> 1) & 1);
+        const std::size_t k = cell / (nx * ny) + ((bits >> 2) & 1);
+        return i + nxp * (j + nyp * k);
+    };
+    auto fillConnectivity = [&](auto& offsets, auto& connectivity) {
+        using Index = typename std::decay_t<decltype(offsets)>::value_type;
+        offsets.resize(totalElements + 1);
+        connectivity.resize(totalConn);
+        offsets[0] = 0;
+        const std::size_t chunks = (totalElements + kChunkSize - 1) / kChunkSize;
+        m_pool.parallelFor(chunks, [&](std::size_t chunk) {
+            const std::size_t end = std::min(totalElements, (chunk + 1) * kChunkSize);
+            for (std::size_t e = chunk * kChunkSize; e < end; ++e) {
+                const std::size_t base = (e / m_elementsPerInstance) * m_nodesPerInstance;
+                const std::size_t local = e % m_elementsPerInstance;
+                Index* out = connectivity.data() + e * static_cast<std::size_t>(perElement);
+                switch (m_spec.meshType) {
+                case SyntheticMeshType::HEX:
+                    for (int c = 0; c < 8; ++c) out[c] = static_cast<Index>(base + corner(local, kHexCorners[c]));
+                    break;
+                case SyntheticMeshType::TET:
+                    for (int c = 0; c < 4; ++c) {
+                        out[c] = static_cast<Index>(base + corner(local / 6, kTetCorners[local % 6][c]));
+                    }
+                    break;
+                case SyntheticMeshType::SHELL:
+                    for (int c = 0; c < 4; ++c) out[c] = static_cast<Index>(base + corner(local, kQuadCorners[c]));
+                    break;
+                }
+                offsets[e + 1] = static_cast<Index>((e + 1) * static_cast<std::size_t>(perElement));
+            }
+        });
+    };
+    if (m_elementsConn.wideIndex) {
+        fillConnectivity(*m_elementsConn.offsets64, *m_elementsConn.connectivity64);
+    } else {
+        fillConnectivity(*m_elementsConn.offsets32, *m_elementsConn.connectivity32);
+    }
+
+    // 实例与标签：标签在实例内从 1 连续编号，查找表为稠密表
+    std::vector<int> labels;
+    for (std::size_t inst = 0; inst < instances; ++inst) {
+        InstanceInfo info;
+        info.name = "PART-" + std::to_string(inst + 1) + "-1";
+        info.nodeStartIndex = inst * m_nodesPerInstance;
+        info.nodeCount = m_nodesPerInstance;
+        info.elementStartIndex = inst * m_elementsPerInstance;
+        info.elementCount = m_elementsPerInstance;
+
+        labels.resize(m_nodesPerInstance);
+        std::iota(labels.begin(), labels.end(), 1);
+        info.nodeLabelToIndex.build(labels, info.nodeStartIndex);
+        labels.resize(m_elementsPerInstance);
+        info.elementLabelToIndex.build(labels, info.elementStartIndex);
+        m_instanceInfos.emplace_back(std::move(info));
+    }
+    m_nodesNum = totalNodes;
+    m_elementsNum = totalElements;
+    reportLoadProgress(phase, totalNodes + totalElements, totalNodes + totalElements);
+    span.arg("nodes", totalNodes);
+    span.arg("elements", totalElements);
+
+    ODB_LOG_INFO("Synthetic geometry generated: " << m_nodesNum << " nodes, " << m_elementsNum << " "
+                 << elementTypeName() << " elements in " << instances << " instances.");
+}
+
+std::vector<std::string> SyntheticSource::getStepNames() const
+{
+    return m_stepNames;
+}
+
+int SyntheticSource::getFrameCount(const std::string& stepName) const
+{
+    const bool known = std::find(m_stepNames.begin(), m_stepNames.end(), stepName) != m_stepNames.end();
+    return known ? m_spec.framesPerStep : 0;
+}
+
+bool SyntheticSource::getFrameInfo(const std::string& stepName, int position, StepFrameInfo& info) const
+{
+    if (position < 0 || position >= getFrameCount(stepName)) {
+        return false;
+    }
+    // frameId 与位置一致，步时间在 [0, 1] 上均匀分布
+    info.stepName = stepName;
+    info.frameIndex = position;
+    info.frameValue = m_spec.framesPerStep > 1 ? static_cast<double>(position) / (m_spec.framesPerStep - 1) : 1.0;
+    std::ostringstream description;
+    description << "Increment " << position << ": Step Time = " << info.frameValue;
+    info.description = description.str();
+    return true;
+}
+
+double SyntheticSource::loadFactor(const std::string& stepName, int frameIndex) const
+{
+    const auto it = std::find(m_stepNames.begin(), m_stepNames.end(), stepName);
+    StepFrameInfo info;
+    if (it == m_stepNames.end() || !getFrameInfo(stepName, frameIndex, info)) {
+        return -1.0;
+    }
+    // 载荷随步与步时间线性增加，最后一步末尾为 1
+    return (static_cast<double>(it - m_stepNames.begin()) + info.frameValue) / m_spec.steps;
+}
+
+void SyntheticSource::fillField(FieldData& fieldData, std::size_t entityCount,
+                                const std::function<void(std::size_t, float*)>& fn)
+{
+    const std::size_t width = static_cast<std::size_t>(fieldData.components);
+    fieldData.values.resize(entityCount * width);
+    fieldData.validFlags.assign(entityCount, 1);
+
+    FieldStatsAccumulator stats(fieldData.components, entityCount);
+    const std::size_t chunks = (entityCount + kChunkSize - 1) / kChunkSize;
+    m_pool.parallelFor(chunks, [&](std::size_t chunk) {
+        FieldStatsAccumulator::Partial partial = stats.makePartial();
+        const std::size_t end = std::min(entityCount, (chunk + 1) * kChunkSize);
+        for (std::size_t e = chunk * kChunkSize; e < end; ++e) {
+            float* values = fieldData.values.data() + e * width;
+            fn(e, values);
+            stats.add(partial, e, values);
+        }
+        stats.merge(partial);
+    });
+    fieldData.stats = stats.finish();
+}
+
+void SyntheticSource::generateDisplacement(double lambda, FieldData& fieldData)
+{
+    const FieldCatalogEntry& entry = m_fieldCatalog[0];
+    fieldData.type = FieldType::DISPLACEMENT;
+    fieldData.name = entry.name;
+    fieldData.description = entry.description;
+    fieldData.componentLabels = entry.componentLabels;
+    fieldData.components = static_cast<int>(entry.componentLabels.size());
+    fieldData.isNodal = true;
+
+    // 悬臂弯曲形态：x 越远挠度越大，附带横向波动与沿厚度的剪切
+    const double scale = lambda * m_spec.length;
+    fillField(fieldData, m_nodesNum, [&](std::size_t n, float* u) {
+        double xi, eta, zeta;
+        normalizedNode(n % m_nodesPerInstance, xi, eta, zeta);
+        if (m_block.nz == 0) zeta = 0.5;
+        u[0] = static_cast<float>(scale * 0.01 * (zeta - 0.5) * xi);
+        u[1] = static_cast<float>(scale * 0.005 * std::sin(kPi * xi) * eta);
+        u[2] = static_cast<float>(-scale * 0.05 * xi * xi);
+    });
+}
+
+void SyntheticSource::generateStress(double lambda, FieldData& fieldData)
+{
+    const FieldCatalogEntry& entry = m_fieldCatalog[1];
+    fieldData.type = FieldType::STRESS;
+    fieldData.name = entry.name;
+    fieldData.description = entry.description;
+    fieldData.componentLabels = entry.componentLabels;
+    fieldData.components = static_cast<int>(entry.componentLabels.size());
+    fieldData.isNodal = false;
+
+    const bool shell = m_spec.meshType == SyntheticMeshType::SHELL;
+    fillField(fieldData, m_elementsNum, [&](std::size_t e, float* s) {
+        double xi, eta, zeta;
+        normalizedCentroid(e % m_elementsPerInstance, xi, eta, zeta);
+        const double s11 = lambda * 200.0 * (1.0 - xi) * (1.0 - 2.0 * zeta);
+        const double s22 = lambda * (60.0 * std::sin(kPi * eta) * (1.0 - xi) + 20.0);
+        const double s12 = lambda * 40.0 * std::cos(kPi * xi) * (eta - 0.5);
+        if (shell) {
+            s[0] = static_cast<float>(s11);
+            s[1] = static_cast<float>(s22);
+            s[2] = static_cast<float>(s12);
+            return;
+        }
+        s[0] = static_cast<float>(s11);
+        s[1] = static_cast<float>(s22);
+        s[2] = static_cast<float>(lambda * 30.0 * xi * (1.0 - zeta));
+        s[3] = static_cast<float>(s12);
+        s[4] = static_cast<float>(lambda * 25.0 * zeta * (1.0 - zeta));
+        s[5] = static_cast<float>(lambda * 10.0 * std::sin(2.0 * kPi * xi) * eta);
+    });
+}
+
+bool SyntheticSource::readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName)
+{
+    tracing::Span span("readSingleField", "reader");
+    const double lambda = loadFactor(stepName, frameIndex);
+    if (lambda < 0.0) {
+        ODB_LOG_ERROR("Frame " << frameIndex << " not found in step " << stepName);
+        return false;
+    }
+    std::shared_ptr<const FieldData> fieldData = generateField(lambda, fieldName);
+    if (!fieldData) {
+        return false;
+    }
+    span.arg("entities", fieldData->slotCount());
+    span.arg("bytes", fieldData->values.size() * sizeof(float));
+
+    // 与 readOdb 一致：已加载的场只保留本次读取的一个，之前取得的共享指针不受影响
+    m_fieldDataMap.clear();
+    getFrameInfo(stepName, frameIndex, m_currentStepFrame);
+    m_fieldDataMap[fieldName] = std::move(fieldData);
+    return true;
+}
+
+std::shared_ptr<const FieldData> SyntheticSource::loadField(const std::string& stepName, int frameIndex,
+                                                            const std::string& fieldName)
+{
+    if (m_currentStepFrame.stepName == stepName && m_currentStepFrame.frameIndex == frameIndex) {
+        auto it = m_fieldDataMap.find(fieldName);
+        if (it != m_fieldDataMap.end()) {
+            return it->second;
+        }
+    }
+    tracing::Span span("loadField", "reader");
+    const double lambda = loadFactor(stepName, frameIndex);
+    if (lambda < 0.0) {
+        ODB_LOG_ERROR("Frame " << frameIndex << " not found in step " << stepName);
+        return nullptr;
+    }
+    return generateField(lambda, fieldName);
+}
+
+std::shared_ptr<const FieldData> SyntheticSource::generateField(double lambda, const std::string& fieldName)
+{
+    auto fieldData = std::make_shared<FieldData>();
+    if (fieldName == "U") {
+        generateDisplacement(lambda, *fieldData);
+    } else if (fieldName == "S") {
+        generateStress(lambda, *fieldData);
+    } else {
+        ODB_LOG_WARNING("Field " << fieldName << " not available in synthetic model.");
+        return nullptr;
+    }
+    return fieldData;
+}
+
+bool SyntheticSource::readFieldOutput(const std::string& stepName, int frameIndex)
+{
+    const double lambda = loadFactor(stepName, frameIndex);
+    if (lambda < 0.0) {
+        ODB_LOG_ERROR("Frame " << frameIndex << " not found in step " << stepName);
+        return false;
+    }
+    m_fieldDataMap.clear();
+    getFrameInfo(stepName, frameIndex, m_currentStepFrame);
+    bool ok = true;
+    for (const FieldCatalogEntry& entry : m_fieldCatalog) {
+        if (std::shared_ptr<const FieldData> fieldData = generateField(lambda, entry.name)) {
+            m_fieldDataMap[entry.name] = std::move(fieldData);
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+const FieldData* SyntheticSource::getFieldData(const std::string& fieldName) const
+{
+    auto it = m_fieldDataMap.find(fieldName);
+    return it != m_fieldDataMap.end() ? it->second.get() : nullptr;
+}
+
+std::shared_ptr<const FieldData> SyntheticSource::shareFieldData(const std::string& fieldName) const
+{
+    auto it = m_fieldDataMap.find(fieldName);
+    return it != m_fieldDataMap.end() ? it->second : nullptr;
+}
+
+std::vector<std::string> SyntheticSource::getLoadedFieldNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(m_fieldDataMap.size());
+    for (const auto& kv : m_fieldDataMap) {
+        names.emplace_back(kv.first);
+    }
+    return names;
+}
+
+std::vector<const FieldCatalogEntry*> SyntheticSource::listFields(const std::string& stepName, int frameIndex) const
+{
+    std::vector<const FieldCatalogEntry*> fields;
+    if (loadFactor(stepName, frameIndex) >= 0.0) {
+        for (const FieldCatalogEntry& entry : m_fieldCatalog) {
+            fields.push_back(&entry);
+        }
+    }
+    return fields;
+}
+
+bool SyntheticSource::isFieldInFrame(const std::string& stepName, int frameIndex, const std::string& fieldName) const
+{
+    return loadFactor(stepName, frameIndex) >= 0.0 && getFieldInfo(fieldName) != nullptr;
+}
+
+const FieldCatalogEntry* SyntheticSource::getFieldInfo(const std::string& fieldName) const
+{
+    for (const FieldCatalogEntry& entry : m_fieldCatalog) {
+        if (entry.name == fieldName) return &entry;
+    }
+    return nullptr;
+}
@@ -0,0 +1,109 @@
+#ifndef SYNTHETICSOURCE_H
+#define SYNTHETICSOURCE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "resultsource.h"
+#include "threadpool.h"
+
+enum class SyntheticMeshType {
+    HEX,  // C3D8，每格一个六面体
+    TET,  // C3D4，每格按 Kuhn 剖分为 6 个四面体，相邻格的剖分协调
+    SHELL // S4R，xy 平面上略带起伏的四边形壳，nz 不使用
+};
+
+// 参数化模型：instances 个相同的块沿 x 方向排列，每块 nx × ny × nz 个立方格，边长 length / nx
+struct SyntheticModelSpec {
+    SyntheticMeshType meshType{SyntheticMeshType::HEX};
+    int nx{20};
+    int ny{20};
+    int nz{20};
+    int instances{1};
+    double length{1.0};   // 每个实例在 x 方向的尺寸
+    int steps{1};
+    int framesPerStep{11}; // 每步帧数，含 0 时刻帧
+
+    std::size_t nodeCount() const;
+    std::size_t elementCount() const;
+
+    // 按目标单元总数选取近似立方（壳为正方形）的格数
+    static SyntheticModelSpec forElementCount(SyntheticMeshType type, std::size_t elements, int instances = 1);
+
+    // 文本格式为每行一个 key = value，# 之后为注释；elements 给出时按目标单元数推算 nx/ny/nz
+    // 键：type(hex|tet|shell), elements, nx, ny, nz, instances, length, steps, frames
+    static bool parse(const std::string& text, SyntheticModelSpec& spec, std::string* error = nullptr);
+    static bool loadFile(const std::string& fileName, SyntheticModelSpec& spec, std::string* error = nullptr);
+};
+
+// 合成结果源：按参数生成网格，位移 U（节点）与应力 S（单元）由坐标与载荷因子解析计算
+// 不依赖 Abaqus，用于在任意平台上对网格构建、场数据转换与显示做性能测试
+// 场数据在读取时按需生成，几何释放后仍可生成（只依赖格点编号）
+class SyntheticSource : public ResultSource {
+public:
+    // name 作为结果文件名显示，可为 .synth 描述文件的路径
+    explicit SyntheticSource(const SyntheticModelSpec& spec, const std::string& name = "synthetic.synth",
+                             LoadProgressCallback progress = LoadProgressCallback(), int threads = 0);
+    ~SyntheticSource() override = default;
+
+    const SyntheticModelSpec& spec() const { return m_spec; }
+
+    std::vector<std::string> getStepNames() const override;
+    int getFrameCount(const std::string& stepName) const override;
+    bool getFrameInfo(const std::string& stepName, int position, StepFrameInfo& info) const override;
+    StepFrameInfo getCurrentStepFrame() const override { return m_currentStepFrame; }
+
+    bool readFieldOutput(const std::string& stepName, int frameIndex) override;
+    bool readSingleField(const std::string& stepName, int frameIndex, const std::string& fieldName) override;
+    const FieldData* getFieldData(const std::string& fieldName) const override;
+    std::shared_ptr<const FieldData> shareFieldData(const std::string& fieldName) const override;
+    std::shared_ptr<const FieldData> loadField(const std::string& stepName, int frameIndex,
+                                               const std::string& fieldName) override;
+    std::vector<std::string> getLoadedFieldNames() const override;
+
+    std::vector<const FieldCatalogEntry*> listFields(const std::string& stepName, int frameIndex) const override;
+    bool isFieldInFrame(const std::string& stepName, int frameIndex, const std::string& fieldName) const override;
+    const FieldCatalogEntry* getFieldInfo(const std::string& fieldName) const override;
+
+private:
+    struct Block {
+        int nx{0}, ny{0}, nz{0}; // 格数，壳的 nz 为 0
+        double h{0.0};           // 格边长
+        double pitch{0.0};       // 相邻实例在 x 方向的间距
+    };
+
+    void generateGeometry();
+    // 实例内局部编号到格点坐标与归一化坐标 (xi, eta, zeta) ∈ [0, 1]³
+    void nodePosition(std::size_t instance, std::size_t local, double& x, double& y, double& z) const;
+    void normalizedNode(std::size_t local, double& xi, double& eta, double& zeta) const;
+    void normalizedCentroid(std::size_t localElement, double& xi, double& eta, double& zeta) const;
+    int nodesPerElement() const;
+    const char* elementTypeName() const;
+    double loadFactor(const std::string& stepName, int frameIndex) const; // 不存在的步或帧返回负值
+
+    std::shared_ptr<const FieldData> generateField(double lambda, const std::string& fieldName); // 不支持的场返回空
+    void generateDisplacement(double lambda, FieldData& fieldData);
+    void generateStress(double lambda, FieldData& fieldData);
+    // 按实体分块并行填充 values，同时累积统计量
+    void fillField(FieldData& fieldData, std::size_t entityCount,
+                   const std::function<void(std::size_t entity, float* values)>& fn);
+    void reportLoadProgress(const std::string& phase, std::size_t done, std::size_t total) const;
+
+    SyntheticModelSpec m_spec;
+    Block m_block;
+    std::size_t m_nodesPerInstance{0};
+    std::size_t m_elementsPerInstance{0};
+    LoadProgressCallback m_loadProgress;
+    ThreadPool m_pool;
+
+    std::vector<std::string> m_stepNames;
+    std::vector<FieldCatalogEntry> m_fieldCatalog; // 固定为 U、S，构造后不再改变
+    StepFrameInfo m_currentStepFrame{};
+    std::unordered_map<std::string, std::shared_ptr<const FieldData>> m_fieldDataMap;
+};
+
+#endif // SYNTHETICSOURCE_H
@@ -0,0 +1,95 @@
+#include "threadpool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    const unsigned total = threadCount == 0 ? resolveThreadCount(0) : threadCount;
+    for (unsigned i = 1; i < total; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeCv.notify_all();
+    for (auto& t : m_workers) {
+        t.join();
+    }
+}
+
+unsigned ThreadPool::resolveThreadCount(int requested)
+{
+    if (requested > 0) return static_cast<unsigned>(requested);
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task)
+{
+    if (taskCount == 0) return;
+    if (m_workers.empty() || taskCount == 1) {
+        for (std::size_t i = 0; i < taskCount; ++i) task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(m_callMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask.store(0);
+        m_activeWorkers = m_workers.size();
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_wakeCv.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this] { return m_activeWorkers == 0; });
+    m_task = nullptr;
+    if (m_error) {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    std::size_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCv.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) return;
+            seenGeneration = m_generation;
+        }
+        runTasks();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_activeWorkers == 0) {
+                m_doneCv.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::runTasks()
+{
+    for (;;) {
+        const std::size_t i = m_nextTask.fetch_add(1);
+        if (i >= m_taskCount) return;
+        try {
+            (*m_task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+    }
+}
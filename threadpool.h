@@ -0,0 +1,49 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池，用于把互不相交的任务分摊到多个核心
+// parallelFor 阻塞直到全部任务完成，调用线程本身也参与执行
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = 0); // 0 表示使用硬件并发数
+    ~ThreadPool();
+
+    unsigned threadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+    // 对 [0, taskCount) 中每个下标调用一次 task；任务抛出的首个异常在调用线程重新抛出
+    void parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+    static unsigned resolveThreadCount(int requested);
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCv;
+    std::condition_variable m_doneCv;
+    std::mutex m_callMutex; // 串行化并发的 parallelFor 调用
+
+    const std::function<void(std::size_t)>* m_task{nullptr};
+    std::size_t m_taskCount{0};
+    std::atomic<std::size_t> m_nextTask{0};
+    std::size_t m_activeWorkers{0};
+    std::size_t m_generation{0};
+    std::exception_ptr m_error;
+    bool m_stop{false};
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,251 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace tracing {
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+    std::uint32_t thread;
+    bool hasAllocated;
+    std::uint64_t allocated;
+    int argCount;
+    const char* argKeys[Span::kMaxArgs];
+    std::uint64_t argValues[Span::kMaxArgs];
+};
+
+LogLevel initialLogLevel()
+{
+    LogLevel level = LogLevel::Info;
+    if (const char* env = std::getenv("ODBVIEWER_LOG_LEVEL")) {
+        parseLogLevel(env, level);
+    }
+    return level;
+}
+
+std::atomic<int> g_logLevel{static_cast<int>(initialLogLevel())};
+std::atomic<bool> g_enabled{false};
+std::atomic<AllocationCounter> g_allocationCounter{nullptr};
+std::atomic<std::uint32_t> g_nextThreadId{1};
+
+std::mutex g_eventsMutex;
+std::vector<Event> g_events;
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+std::uint64_t nowNs()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count());
+}
+
+std::uint32_t threadId()
+{
+    thread_local const std::uint32_t id = g_nextThreadId.fetch_add(1);
+    return id;
+}
+
+void writeEscaped(std::ostream& out, const char* text)
+{
+    for (const char* p = text; *p; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *p;
+        } else if (c < 0x20) {
+            out << ' ';
+        } else {
+            out << *p;
+        }
+    }
+}
+
+// ODBVIEWER_TRACE 指定文件时，启动即开启记录，进程退出时写出
+struct EnvironmentTrace {
+    std::string fileName;
+
+    EnvironmentTrace()
+    {
+        if (const char* env = std::getenv("ODBVIEWER_TRACE")) {
+            fileName = env;
+            g_enabled.store(!fileName.empty());
+        }
+    }
+    ~EnvironmentTrace()
+    {
+        if (!fileName.empty()) {
+            writeChromeTrace(fileName);
+        }
+    }
+};
+EnvironmentTrace g_environmentTrace; // 定义在事件容器之后，析构时容器仍有效
+
+} // namespace
+
+void setLogLevel(LogLevel level)
+{
+    g_logLevel.store(static_cast<int>(level));
+}
+
+LogLevel logLevel()
+{
+    return static_cast<LogLevel>(g_logLevel.load(std::memory_order_relaxed));
+}
+
+bool logEnabled(LogLevel level)
+{
+    return static_cast<int>(level) <= g_logLevel.load(std::memory_order_relaxed);
+}
+
+std::ostream& logStream(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Error: return std::cerr << "[Error] ";
+    case LogLevel::Warning: return std::cerr << "[Warning] ";
+    case LogLevel::Debug: return std::cout << "[Debug] ";
+    default: return std::cout << "[Info] ";
+    }
+}
+
+bool parseLogLevel(const std::string& text, LogLevel& level)
+{
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "error") level = LogLevel::Error;
+    else if (lower == "warning") level = LogLevel::Warning;
+    else if (lower == "info") level = LogLevel::Info;
+    else if (lower == "debug") level = LogLevel::Debug;
+    else return false;
+    return true;
+}
+
+void setEnabled(bool enabled)
+{
+    g_enabled.store(enabled);
+}
+
+bool enabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void clear()
+{
+    std::lock_guard<std::mutex> lock(g_eventsMutex);
+    g_events.clear();
+}
+
+std::size_t eventCount()
+{
+    std::lock_guard<std::mutex> lock(g_eventsMutex);
+    return g_events.size();
+}
+
+void setAllocationCounter(AllocationCounter counter)
+{
+    g_allocationCounter.store(counter);
+}
+
+bool writeChromeTrace(const std::string& fileName)
+{
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        events = g_events;
+    }
+    std::ofstream out(fileName, std::ios::out | std::ios::trunc);
+    if (!out) {
+        ODB_LOG_ERROR("Cannot write trace file: " << fileName);
+        return false;
+    }
+    // 完整事件（ph = "X"），时间单位为微秒
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"";
+        writeEscaped(out, e.name);
+        out << "\",\"cat\":\"";
+        writeEscaped(out, e.category);
+        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+            << ",\"ts\":" << e.startNs / 1000 << '.' << (e.startNs % 1000) / 100
+            << ",\"dur\":" << e.durationNs / 1000 << '.' << (e.durationNs % 1000) / 100
+            << ",\"args\":{";
+        bool first = true;
+        if (e.hasAllocated) {
+            out << "\"allocatedBytes\":" << e.allocated;
+            first = false;
+        }
+        for (int a = 0; a < e.argCount; ++a) {
+            out << (first ? "\"" : ",\"");
+            writeEscaped(out, e.argKeys[a]);
+            out << "\":" << e.argValues[a];
+            first = false;
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+    if (!out) {
+        return false;
+    }
+    ODB_LOG_INFO("Wrote " << events.size() << " trace events to " << fileName);
+    return true;
+}
+
+Span::Span(const char* name, const char* category)
+    : m_active(enabled())
+    , m_name(name)
+    , m_category(category)
+{
+    if (!m_active) {
+        return;
+    }
+    if (AllocationCounter counter = g_allocationCounter.load(std::memory_order_relaxed)) {
+        m_startAllocated = counter();
+    }
+    m_startNs = nowNs();
+}
+
+Span::~Span()
+{
+    if (!m_active) {
+        return;
+    }
+    Event e;
+    e.durationNs = nowNs() - m_startNs;
+    e.name = m_name;
+    e.category = m_category;
+    e.startNs = m_startNs;
+    e.thread = threadId();
+    const AllocationCounter counter = g_allocationCounter.load(std::memory_order_relaxed);
+    e.hasAllocated = counter != nullptr;
+    e.allocated = counter ? counter() - m_startAllocated : 0;
+    e.argCount = m_argCount;
+    std::copy(m_argKeys, m_argKeys + m_argCount, e.argKeys);
+    std::copy(m_argValues, m_argValues + m_argCount, e.argValues);
+
+    std::lock_guard<std::mutex> lock(g_eventsMutex);
+    g_events.push_back(e);
+}
+
+void Span::arg(const char* key, std::uint64_t value)
+{
+    if (!m_active || m_argCount >= kMaxArgs) {
+        return;
+    }
+    m_argKeys[m_argCount] = key;
+    m_argValues[m_argCount] = value;
+    ++m_argCount;
+}
+
+} // namespace tracing
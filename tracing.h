@@ -0,0 +1,83 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// 运行时日志级别与作用域计时
+// 日志：级别低于当前设置的输出在求值参数之前就被跳过，输出行以 '\n' 结束而不是 std::endl，不逐行刷新
+// 计时：Span 在构造与析构之间记录墙钟时间、线程、分配字节数与实体数量，可导出为 Chrome trace-event JSON
+//       （chrome://tracing 或 Perfetto 打开）；未启用时 Span 只检查一个原子标志
+// 环境变量 ODBVIEWER_LOG_LEVEL=error|warning|info|debug 设置初始级别，
+// ODBVIEWER_TRACE=<file.json> 在启动时开启记录并在退出时写出
+
+enum class LogLevel : int {
+    Error = 0,
+    Warning = 1,
+    Info = 2,
+    Debug = 3
+};
+
+namespace tracing {
+
+void setLogLevel(LogLevel level);
+LogLevel logLevel();
+bool logEnabled(LogLevel level);
+// 按级别返回 std::cout / std::cerr，并先写出 "[Info] " 等前缀
+std::ostream& logStream(LogLevel level);
+// 解析 "error" / "warning" / "info" / "debug"，无法识别时返回 false
+bool parseLogLevel(const std::string& text, LogLevel& level);
+
+void setEnabled(bool enabled);
+bool enabled();
+void clear();
+std::size_t eventCount();
+// 写出当前已记录的全部事件
+bool writeChromeTrace(const std::string& fileName);
+
+// 可选的分配计数器（如基准程序中统计 operator new 的累计字节数），设置后每个 Span 记录分配增量
+using AllocationCounter = std::uint64_t (*)();
+void setAllocationCounter(AllocationCounter counter);
+
+// name / category 必须是字符串字面量等静态存储的字符串
+class Span {
+public:
+    static constexpr int kMaxArgs = 4;
+
+    Span(const char* name, const char* category);
+    ~Span();
+
+    // 附加一个计数（节点数、单元数、字节数等），超过 kMaxArgs 个时忽略
+    void arg(const char* key, std::uint64_t value);
+
+private:
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    bool m_active{false};
+    const char* m_name;
+    const char* m_category;
+    std::uint64_t m_startNs{0};
+    std::uint64_t m_startAllocated{0};
+    int m_argCount{0};
+    const char* m_argKeys[kMaxArgs];
+    std::uint64_t m_argValues[kMaxArgs];
+};
+
+} // namespace tracing
+
+#define ODB_LOG(level, expr) \
+    do { \
+        if (tracing::logEnabled(level)) { \
+            tracing::logStream(level) << expr << '\n'; \
+        } \
+    } while (0)
+
+#define ODB_LOG_ERROR(expr) ODB_LOG(LogLevel::Error, expr)
+#define ODB_LOG_WARNING(expr) ODB_LOG(LogLevel::Warning, expr)
+#define ODB_LOG_INFO(expr) ODB_LOG(LogLevel::Info, expr)
+#define ODB_LOG_DEBUG(expr) ODB_LOG(LogLevel::Debug, expr)
+
+#endif // TRACING_H
@@ -1,8 +1,17 @@
 #include "vtkdisplay.h"
+#include "tracing.h"
 #include <algorithm>
-#include <vtkArrayCalculator.h>
+#include <cmath>
 #include <vtkDataArray.h>
 #include <vtkDataSet.h>
+#include <vtkFloatArray.h>
+
+namespace {
+
+// 点数据派生量按点分块并行计算的块大小
+constexpr std::size_t kPointChunkSize = 1 << 16;
+
+} // namespace
 
 VTKDisplayManager::VTKDisplayManager()
 {
@@ -18,8 +27,19 @@ VTKDisplayManager::VTKDisplayManager()
     m_lut = nullptr;
 }
 
+ThreadPool& VTKDisplayManager::pool()
+{
+    // 首次需要时创建，线程数改变后重建
+    const unsigned threads = ThreadPool::resolveThreadCount(m_threads);
+    if (!m_pool || m_pool->threadCount() != threads) {
+        m_pool = std::make_unique<ThreadPool>(threads);
+    }
+    return *m_pool;
+}
+
 void VTKDisplayManager::displayWireframe(vtkUnstructuredGrid* grid)
 {
+    tracing::Span span("displayWireframe", "render");
     if (!m_mapper)
         m_mapper = vtkSmartPointer<vtkDataSetMapper>::New();
     if (!m_actor)
@@ -46,6 +66,7 @@ void VTKDisplayManager::displayWireframe(vtkUnstructuredGrid* grid)
 
 void VTKDisplayManager::displaySolid(vtkUnstructuredGrid* grid)
 {
+    tracing::Span span("displaySolid", "render");
     if (!m_mapper)
         m_mapper = vtkSmartPointer<vtkDataSetMapper>::New();
     if (!m_actor)
@@ -73,10 +94,12 @@ void VTKDisplayManager::displaySolid(vtkUnstructuredGrid* grid)
 
 void VTKDisplayManager::displayWithScalarField(vtkUnstructuredGrid* grid,
                                                const std::string& scalarName,
-                                               bool usePointData = true)
+                                               bool usePointData,
+                                               const double* range)
 {
-    if (!setActiveScalar(grid, scalarName, usePointData)) {
-        std::cerr << "[Error] 标量显示失败: " << scalarName << std::endl;
+    tracing::Span span("displayWithScalarField", "render");
+    if (!setActiveScalar(grid, scalarName, usePointData, range)) {
+        ODB_LOG_ERROR("标量显示失败: " << scalarName);
     }
 }
 
@@ -168,10 +191,11 @@ void VTKDisplayManager::setInteractor(vtkRenderWindowInteractor* interactor)
     }
 }
 
-bool VTKDisplayManager::setActiveScalar(vtkUnstructuredGrid* grid, const std::string& name, bool usePointData)
+bool VTKDisplayManager::setActiveScalar(vtkUnstructuredGrid* grid, const std::string& name, bool usePointData,
+                                        const double* range)
 {
     if (!grid) {
-        std::cerr << "[Error] setActiveScalar: grid 为空" << std::endl;
+        ODB_LOG_ERROR("setActiveScalar: grid 为空");
         return false;
     }
 
@@ -189,11 +213,11 @@ bool VTKDisplayManager::setActiveScalar(vtkUnstructuredGrid* grid, const std::st
     if (usePointData) {
         arr = grid->GetPointData()->GetArray(name.c_str());
         if (!arr) {
-            std::cerr << "[Error] 点数据未找到数组: " << name << std::endl;
+            ODB_LOG_ERROR("点数据未找到数组: " << name);
             return false;
         }
         if (arr->GetNumberOfTuples() != grid->GetNumberOfPoints()) {
-            std::cerr << "[Error] 点数组大小与点数不一致: " << name << std::endl;
+            ODB_LOG_ERROR("点数组大小与点数不一致: " << name);
             return false;
         }
         m_mapper->SetScalarModeToUsePointData();
@@ -201,21 +225,26 @@ bool VTKDisplayManager::setActiveScalar(vtkUnstructuredGrid* grid, const std::st
     } else {
         arr = grid->GetCellData()->GetArray(name.c_str());
         if (!arr) {
-            std::cerr << "[Error] 单元数据未找到数组: " << name << std::endl;
+            ODB_LOG_ERROR("单元数据未找到数组: " << name);
             return false;
         }
         if (arr->GetNumberOfTuples() != grid->GetNumberOfCells()) {
-            std::cerr << "[Error] 单元数组大小与单元数不一致: " << name << std::endl;
+            ODB_LOG_ERROR("单元数组大小与单元数不一致: " << name);
             return false;
         }
         m_mapper->SetScalarModeToUseCellData();
         grid->GetCellData()->SetActiveScalars(name.c_str());
     }
 
-    double range[2] = {0.0, 1.0};
-    arr->GetRange(range);
+    double scalarRange[2] = {0.0, 1.0};
+    if (range && range[1] >= range[0]) {
+        scalarRange[0] = range[0];
+        scalarRange[1] = range[1];
+    } else {
+        arr->GetRange(scalarRange);
+    }
     m_lut->SetNumberOfTableValues(256);
-    m_lut->SetRange(range);
+    m_lut->SetRange(scalarRange);
     m_lut->SetHueRange(0.667, 0.0);
     m_lut->Build();
 
@@ -241,42 +270,53 @@ bool VTKDisplayManager::setActiveScalar(vtkUnstructuredGrid* grid, const std::st
 
 bool VTKDisplayManager::addPointVectorMagnitude(vtkUnstructuredGrid* grid, const std::string& vectorName, const std::string& outputName)
 {
+    tracing::Span span("addPointVectorMagnitude", "render");
     if (!grid) {
-        std::cerr << "[Error] addPointVectorMagnitude: grid 为空" << std::endl;
+        ODB_LOG_ERROR("addPointVectorMagnitude: grid 为空");
         return false;
     }
     if (!grid->GetPointData()) {
-        std::cerr << "[Error] addPointVectorMagnitude: grid 无点数据" << std::endl;
+        ODB_LOG_ERROR("addPointVectorMagnitude: grid 无点数据");
         return false;
     }
     vtkDataArray* vec = grid->GetPointData()->GetArray(vectorName.c_str());
     if (!vec) {
-        std::cerr << "[Error] addPointVectorMagnitude: 未找到点矢量数组 " << vectorName << std::endl;
+        ODB_LOG_ERROR("addPointVectorMagnitude: 未找到点矢量数组 " << vectorName);
         return false;
     }
-    vtkNew<vtkArrayCalculator> calc;
-    calc->SetInputData(grid);
-    calc->SetAttributeTypeToPointData();
-    calc->AddVectorArrayName(vectorName.c_str());
-    const std::string expr = std::string("mag(") + vectorName + ")";
-    calc->SetFunction(expr.c_str());
-    calc->SetResultArrayName(outputName.c_str());
-    calc->Update();
-
-    vtkDataSet* outDs = vtkDataSet::SafeDownCast(calc->GetOutput());
-    if (!outDs) {
-        std::cerr << "[Error] addPointVectorMagnitude: 计算输出不是 vtkDataSet" << std::endl;
-        return false;
+    // 非 float 数组先转换一份（网格中的场数组均为 float，一般不会发生）
+    vtkSmartPointer<vtkFloatArray> input = vtkFloatArray::FastDownCast(vec);
+    if (!input) {
+        input = vtkSmartPointer<vtkFloatArray>::New();
+        input->DeepCopy(vec);
     }
-    vtkDataArray* mag = outDs->GetPointData()->GetArray(outputName.c_str());
-    if (!mag) {
-        std::cerr << "[Error] addPointVectorMagnitude: 计算失败，输出数组不存在 " << outputName << std::endl;
+    const int components = input->GetNumberOfComponents();
+    const std::size_t tuples = static_cast<std::size_t>(input->GetNumberOfTuples());
+    if (components <= 0) {
+        ODB_LOG_ERROR("addPointVectorMagnitude: 数组分量数无效 " << vectorName);
         return false;
     }
-    vtkSmartPointer<vtkDataArray> magCopy;
-    magCopy.TakeReference(mag->NewInstance());
-    magCopy->DeepCopy(mag);
-    magCopy->SetName(outputName.c_str());
-    grid->GetPointData()->AddArray(magCopy);
+
+    // |v| = sqrt(c1^2 + c2^2 + ...)：按点分块直接读取数组内存，结果写入新数组，不经过中间副本
+    const std::size_t numComp = static_cast<std::size_t>(components);
+    const float* in = input->GetPointer(0);
+    vtkSmartPointer<vtkFloatArray> mag = vtkSmartPointer<vtkFloatArray>::New();
+    mag->SetNumberOfComponents(1);
+    mag->SetNumberOfTuples(static_cast<vtkIdType>(tuples));
+    float* out = mag->GetPointer(0);
+    const std::size_t chunks = (tuples + kPointChunkSize - 1) / kPointChunkSize;
+    pool().parallelFor(chunks, [&](std::size_t t) {
+        const std::size_t end = std::min(tuples, (t + 1) * kPointChunkSize);
+        for (std::size_t i = t * kPointChunkSize; i < end; ++i) {
+            const float* v = in + i * numComp;
+            double squares = 0.0;
+            for (std::size_t c = 0; c < numComp; ++c) {
+                squares += static_cast<double>(v[c]) * v[c];
+            }
+            out[i] = static_cast<float>(std::sqrt(squares));
+        }
+    });
+    mag->SetName(outputName.c_str());
+    grid->GetPointData()->AddArray(mag);
     return true;
 }
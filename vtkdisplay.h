@@ -1,6 +1,7 @@
 #ifndef VTKDISPLAY_H
 #define VTKDISPLAY_H
 
+#include <memory>
 #include <string>
 #include <vtkGenericOpenGLRenderWindow.h>
 #include <vtkRenderer.h>
@@ -18,8 +19,9 @@
 #include <vtkCellData.h>
 #include <vtkTextProperty.h>
 
-#include "odbmanager.h"
+#include "resultsource.h"
 #include "creategrid.h"
+#include "threadpool.h"
 
 
 class VTKDisplayManager
@@ -30,12 +32,18 @@ public:
     void displayWireframe(vtkUnstructuredGrid* grid);
     void displaySolid(vtkUnstructuredGrid* grid);
 
-    void displayWithScalarField(vtkUnstructuredGrid* grid, const std::string& scalarName, bool usePointData);
+    // range 非空时直接作为色标范围（通常来自 FieldData::stats），否则扫描数组求范围
+    void displayWithScalarField(vtkUnstructuredGrid* grid, const std::string& scalarName, bool usePointData,
+                                const double* range = nullptr);
     bool addPointVectorMagnitude(vtkUnstructuredGrid* grid, const std::string& vectorName, const std::string& outputName);
     void addAxes();
     void setCameraView();
     void start();
 
+    // 点数据派生量（模长）的并行线程数：1 为串行，0 为按硬件并发数；线程池在首次并行计算时创建
+    void setThreads(int threads) { m_threads = threads; }
+    int threads() const { return m_threads; }
+
 public:
     void setInteractor(vtkRenderWindowInteractor* interactor);
     vtkGenericOpenGLRenderWindow* getRenderWindow() const { return m_renderWindow.Get(); }
@@ -53,8 +61,12 @@ private:
     vtkSmartPointer<vtkOrientationMarkerWidget> m_axesWidget;
     bool m_actorAdded = false;
     bool m_scalarBarAdded = false;
+    int m_threads{0};
+    std::unique_ptr<ThreadPool> m_pool;
+
+    ThreadPool& pool();
 
     void addScalarBar(vtkSmartPointer<vtkDataSetMapper> mapper, const std::string& title);
-    bool setActiveScalar(vtkUnstructuredGrid* grid, const std::string& name, bool usePointData);
+    bool setActiveScalar(vtkUnstructuredGrid* grid, const std::string& name, bool usePointData, const double* range);
 };
 #endif // VTKDISPLAY_H